@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <pybind11/pybind11.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <Annotations.h>
+#include <Functions.h>
+#include <HeadlessView.h>
+#include <TypeManager.h>
+#include <Types.h>
+
+namespace gal {
+namespace bench {
+
+static std::vector<Input>                 sInputs;   // NOLINT
+static std::vector<const func::Function*> sOutputs;  // NOLINT
+
+spdlog::logger& logger()
+{
+  // The standard output is reserved for the report.
+  static auto const sLogger = spdlog::stderr_color_mt("galbench");
+  return *sLogger;
+}
+
+const std::vector<Input>& inputs()
+{
+  return sInputs;
+}
+
+const Input& inputByLabel(const std::string& label)
+{
+  auto match = std::find_if(sInputs.begin(), sInputs.end(), [&](const Input& input) {
+    return input.mLabel == label;
+  });
+  if (match == sInputs.end()) {
+    throw std::invalid_argument("The demo has no input with the label '" + label + "'");
+  }
+  if (!match->mSetFraction) {
+    throw std::invalid_argument("The input '" + label + "' cannot be perturbed");
+  }
+  return *match;
+}
+
+const std::vector<const func::Function*>& outputs()
+{
+  return sOutputs;
+}
+
+template<typename T>
+struct SliderTraits
+{
+  using ScalarT = T;
+
+  static T make(ScalarT value) { return value; }
+};
+
+template<int N, typename T, glm::qualifier Q>
+struct SliderTraits<glm::vec<N, T, Q>>
+{
+  using ScalarT = T;
+
+  static glm::vec<N, T, Q> make(ScalarT value) { return glm::vec<N, T, Q>(value); }
+};
+
+/**
+ * @brief Creates a variable in place of a slider. Like the sliders of vectors in galview,
+ * all the components of a vector are set to the same value.
+ */
+template<typename T>
+typename func::TVariable<T>::PyOutputType py_slider(py::object pylabel,
+                                                    py::object pymin,
+                                                    py::object pymax,
+                                                    py::object pyvalue)
+{
+  using ScalarT = typename SliderTraits<T>::ScalarT;
+  std::string label;
+  ScalarT     min, max, value;
+  func::Converter<py::object, std::string>::assign(pylabel, label);
+  func::Converter<py::object, ScalarT>::assign(pymin, min);
+  func::Converter<py::object, ScalarT>::assign(pymax, max);
+  func::Converter<py::object, ScalarT>::assign(pyvalue, value);
+
+  static const std::string      sName = "slider_" + TypeInfo<T>::name();
+  static const std::string      sDesc = "Slider for type " + TypeInfo<T>::name() + ".";
+  static const std::string_view sOutputName = "value";
+  static const std::string_view sOutputDesc = "Value output from the slider";
+
+  static const func::FuncInfo sInfo = {{sName.data(), sName.size()},
+                                       {sDesc.data(), sDesc.size()},
+                                       0,
+                                       nullptr,
+                                       nullptr,
+                                       1,
+                                       &sOutputName,
+                                       &sOutputDesc};
+
+  auto fn = func::store::makeFunction<func::TVariable<T>>(
+    sInfo, SliderTraits<T>::make(std::clamp(value, min, max)));
+  sInputs.push_back({label, [fn, min, max](double fraction) {
+                       double v = double(min) + fraction * (double(max) - double(min));
+                       if constexpr (std::is_integral_v<ScalarT>) {
+                         v = std::round(v);
+                       }
+                       fn->set(SliderTraits<T>::make(ScalarT(v)));
+                     }});
+  return fn->pythonOutputRegs();
+}
+
+typename func::TVariable<std::string>::PyOutputType py_textField(const std::string& label)
+{
+  static const std::string_view sOutputName = "text";
+  static const std::string_view sOutputDesc = "The text from the text field input.";
+
+  static const func::FuncInfo sFnInfo = {"text",
+                                         "Text field input widget",
+                                         0,
+                                         nullptr,
+                                         nullptr,
+                                         1,
+                                         &sOutputName,
+                                         &sOutputDesc};
+  auto fn = func::store::makeFunction<func::TVariable<std::string>>(sFnInfo, "");
+  sInputs.push_back({label, nullptr});
+  return fn->pythonOutputRegs();
+}
+
+template<typename T>
+struct SinkCallable
+{
+  void operator()(const func::data::Tree<T>&) const {}
+};
+
+/**
+ * @brief Takes the place of the show and print functions of galview. The function does
+ * nothing with its input, but evaluating it brings the whole graph upstream of it up to
+ * date.
+ */
+template<typename T>
+struct SinkFunc : public func::TFunction<SinkCallable<T>, const func::data::Tree<T>>
+{
+  using BaseT = func::TFunction<SinkCallable<T>, const func::data::Tree<T>>;
+
+  explicit SinkFunc(const func::Register<T>& reg)
+      : BaseT(SinkCallable<T>(), std::make_tuple(reg))
+  {}
+
+  virtual ~SinkFunc() = default;
+
+  SinkFunc(SinkFunc const&)            = delete;
+  SinkFunc(SinkFunc&&)                 = delete;
+  SinkFunc& operator=(SinkFunc const&) = delete;
+  SinkFunc& operator=(SinkFunc&&)      = delete;
+};
+
+template<typename T, bool IsShow>
+void py_sink(const std::string& /*label*/, const func::Register<T>& reg)
+{
+  static const std::string sName =
+    std::string(IsShow ? "show_" : "print_") + TypeInfo<T>::name();
+  static const std::string sDesc =
+    "Evaluates an object of type " + TypeInfo<T>::name() + " without showing it.";
+  static const std::string_view sInputName = "obj";
+  static const std::string_view sInputDesc = "Object to be evaluated.";
+  static const func::FuncInfo   sInfo      = {{sName.data(), sName.size()},
+                                              {sDesc.data(), sDesc.size()},
+                                              1,
+                                              &sInputName,
+                                              &sInputDesc,
+                                              0,
+                                              nullptr,
+                                              nullptr};
+  sOutputs.push_back(func::store::makeFunction<SinkFunc<T>>(sInfo, reg));
+}
+
+// Glyph textures can't be loaded without a window, so the glyphs are only numbered.
+py::list py_loadGlyphs(const py::list& glyphPaths)
+{
+  py::list lst;
+  for (size_t i = 0; i < py::len(glyphPaths); i++) {
+    lst.append(int(i));
+  }
+  return lst;
+}
+
+// Same as in galview.
+// NOLINTNEXTLINE
+GAL_FUNC(
+  glyphs,
+  "Displays glyphs in the viewer",
+  (((func::data::ReadView<int, 1>), indices, "The indices of the glyphs to be displayed"),
+   ((func::data::ReadView<glm::vec3, 1>),
+    positions,
+    "Positions at which to display the glyphs")),
+  ((gal::GlyphAnnotations, result, "The glyph set")))
+{
+  if (indices.size() != positions.size()) {
+    throw std::length_error("Index list and positions list must have the same length");
+  }
+  result.resize(indices.size());
+  for (size_t i = 0; i < indices.size(); i++) {
+    result[i] = {positions[i], {uint32_t(indices[i])}};
+  }
+}
+
+// Same as in galview.
+// NOLINTNEXTLINE
+GAL_FUNC(
+  tags,
+  "Shows string tags in the viewer",
+  (((func::data::ReadView<std::string, 1>), words, "The string tags to show."),
+   ((func::data::ReadView<glm::vec3, 1>), positions, "Positions to show the tags at")),
+  ((gal::TextAnnotations, result, "The tags")))
+{
+  if (words.size() != positions.size()) {
+    throw std::length_error(
+      "The number of tags must be the same as the number of positions.");
+  }
+  result.resize(words.size());
+  for (size_t i = 0; i < words.size(); i++) {
+    result[i] = {positions[i], words[i]};
+  }
+}
+
+void py_runCommands(const std::string& commands)
+{
+  logger().debug("Ignoring viewer commands: {}", commands);
+}
+
+namespace python {
+
+template<typename T>
+struct defOutputFuncs
+{
+  static void invoke(py::module& mod)
+  {
+    mod.def("print", py_sink<T, false>, "Evaluates the given object (second arg).");
+    mod.def("show", py_sink<T, true>, "Evaluates the given object (second arg).");
+  }
+};
+
+}  // namespace python
+
+}  // namespace bench
+}  // namespace gal
+
+#define GAL_DEF_PY_FN(fnName, mod) mod.def(#fnName, py_##fnName);  // NOLINT
+
+PYBIND11_MODULE(pygalview, pgv)  // NOLINT
+{
+  using namespace gal::bench;
+  using namespace gal::bench::python;
+  pgv.def("sliderf32", py_slider<float>, "Variable in place of a float-32 slider.");
+  pgv.def("slideri32", py_slider<int32_t>, "Variable in place of an int-32 slider.");
+  pgv.def("sliderVec3", py_slider<glm::vec3>, "Variable in place of a vec3 slider.");
+  pgv.def("sliderVec2", py_slider<glm::vec2>, "Variable in place of a vec2 slider.");
+
+  gal::func::typemanager::invoke<defOutputFuncs>(pgv);
+
+  GAL_DEF_PY_FN(textField, pgv);
+  GAL_DEF_PY_FN(tags, pgv);
+  GAL_DEF_PY_FN(glyphs, pgv);
+  GAL_DEF_PY_FN(loadGlyphs, pgv);
+  GAL_DEF_PY_FN(runCommands, pgv);
+};
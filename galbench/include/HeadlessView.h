@@ -0,0 +1,52 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Functions.h>
+
+namespace gal {
+namespace bench {
+
+spdlog::logger& logger();
+
+/**
+ * @brief An input created by the demo, such as a slider, whose value can be changed
+ * between iterations of the benchmark.
+ */
+struct Input
+{
+  std::string mLabel;
+  // Sets the value to the given fraction of the range of the input. Inputs without a
+  // range, such as text fields, can't be set.
+  std::function<void(double)> mSetFraction;
+};
+
+/**
+ * @brief The inputs created by the demo, in the order they were created.
+ */
+const std::vector<Input>& inputs();
+
+/**
+ * @brief Gets the input with the given label. Throws if the demo didn't create such an
+ * input, or if it cannot be set.
+ */
+const Input& inputByLabel(const std::string& label);
+
+/**
+ * @brief The functions created by the show and print calls of the demo. These are the
+ * targets that are evaluated in every iteration of the benchmark.
+ */
+const std::vector<const func::Function*>& outputs();
+
+}  // namespace bench
+}  // namespace gal
+
+// Forward declaration of the initializer of the headless pygalview module. It has the
+// same interface as the module in galview, but nothing is drawn.
+#ifdef _MSC_VER
+extern "C" __declspec(dllexport) PyObject* PyInit_pygalview();
+#else
+extern "C" PyObject* PyInit_pygalview();
+#endif
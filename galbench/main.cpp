@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <cxxopts.hpp>
+
+#include <Functions.h>
+#include <HeadlessView.h>
+#include <Profiler.h>
+#include <ResultCache.h>
+
+using namespace gal;
+namespace fs = std::filesystem;
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+using ClockT       = std::chrono::steady_clock;
+
+struct Options
+{
+  fs::path                 mPath;
+  size_t                   mIterations = 100;
+  size_t                   mWarmup     = 5;
+  std::vector<std::string> mSweep;
+  std::vector<std::string> mRandom;
+  uint64_t                 mSeed    = 42;
+  bool                     mSerial  = false;
+  bool                     mProfile = false;
+  fs::path                 mCacheDir;
+  fs::path                 mOutput;
+};
+
+struct Report
+{
+  double              mLoadMs  = 0.;
+  double              mFirstMs = 0.;
+  std::vector<double> mSamples;
+};
+
+void initPythonEnvironment()
+{
+  PyImport_AppendInittab("pygalfunc", &PyInit_pygalfunc);
+  PyImport_AppendInittab("pygalview", &PyInit_pygalview);
+}
+
+static std::string jsonString(std::string_view str)
+{
+  std::string dst = "\"";
+  for (char c : str) {
+    switch (c) {
+    case '"':
+      dst += "\\\"";
+      break;
+    case '\\':
+      dst += "\\\\";
+      break;
+    case '\n':
+      dst += "\\n";
+      break;
+    case '\t':
+      dst += "\\t";
+      break;
+    default:
+      if (uint8_t(c) < 0x20) {
+        static constexpr std::string_view sDigits = "0123456789abcdef";
+        dst += "\\u00";
+        dst.push_back(sDigits[uint8_t(c) >> 4]);
+        dst.push_back(sDigits[uint8_t(c) & 0xf]);
+      }
+      else {
+        dst.push_back(c);
+      }
+    }
+  }
+  dst.push_back('"');
+  return dst;
+}
+
+static std::string jsonList(const std::vector<std::string>& strs)
+{
+  std::string dst = "[";
+  for (size_t i = 0; i < strs.size(); i++) {
+    dst += (i == 0 ? "" : ", ") + jsonString(strs[i]);
+  }
+  return dst + "]";
+}
+
+/**
+ * @brief Nearest rank percentile of the sorted samples.
+ */
+static double percentile(const std::vector<double>& sorted, double p)
+{
+  size_t rank = size_t(std::ceil(p / 100. * double(sorted.size())));
+  return sorted[std::clamp(rank, size_t(1), sorted.size()) - 1];
+}
+
+static void writeReport(const Options& opts, const Report& report, std::ostream& out)
+{
+  std::vector<double> sorted = report.mSamples;
+  std::sort(sorted.begin(), sorted.end());
+  out << "{\n";
+  out << "  \"demo\": " << jsonString(fs::absolute(opts.mPath).string()) << ",\n";
+  out << "  \"parallel\": " << (func::parallelEvaluation() ? "true" : "false") << ",\n";
+  out << "  \"iterations\": " << sorted.size() << ",\n";
+  out << "  \"warmup\": " << opts.mWarmup << ",\n";
+  out << "  \"sweep\": " << jsonList(opts.mSweep) << ",\n";
+  out << "  \"random\": " << jsonList(opts.mRandom) << ",\n";
+  out << "  \"seed\": " << opts.mSeed << ",\n";
+  out << "  \"loadMs\": " << report.mLoadMs << ",\n";
+  out << "  \"firstEvaluationMs\": " << report.mFirstMs << ",\n";
+  out << "  \"latencyMs\": {";
+  if (!sorted.empty()) {
+    double mean = 0.;
+    for (double s : sorted) {
+      mean += s;
+    }
+    mean /= double(sorted.size());
+    out << "\"min\": " << sorted.front() << ", \"mean\": " << mean
+        << ", \"p50\": " << percentile(sorted, 50.)
+        << ", \"p90\": " << percentile(sorted, 90.)
+        << ", \"p95\": " << percentile(sorted, 95.)
+        << ", \"p99\": " << percentile(sorted, 99.) << ", \"max\": " << sorted.back();
+  }
+  out << "}";
+  if (opts.mProfile) {
+    out << ",\n  \"profile\": [";
+    auto records = func::profile::records();
+    for (size_t i = 0; i < records.size(); i++) {
+      const auto& [fn, stats] = records[i];
+      out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(fn->info().mName)
+          << ", \"context\": " << jsonString(fn->contextpath().string())
+          << ", \"runs\": " << stats.mNumRuns
+          << ", \"combinations\": " << stats.mNumCombinations
+          << ", \"totalMs\": " << Milliseconds(stats.mTotalTime).count()
+          << ", \"lastMs\": " << Milliseconds(stats.mLastTime).count()
+          << ", \"elements\": " << stats.mNumElements
+          << ", \"bytes\": " << stats.mNumBytes << "}";
+    }
+    out << (records.empty() ? "]" : "\n  ]");
+  }
+  out << "\n}\n";
+}
+
+static double evaluateOutputs()
+{
+  auto start = ClockT::now();
+  func::evaluate(bench::outputs());
+  return Milliseconds(ClockT::now() - start).count();
+}
+
+static Report runBenchmark(const Options& opts)
+{
+  Report report;
+  {
+    auto     start = ClockT::now();
+    py::dict global;
+    global["__file__"] = opts.mPath.string();
+    global["__name__"] = "__main__";
+    py::eval_file(opts.mPath.string(), global);
+    report.mLoadMs = Milliseconds(ClockT::now() - start).count();
+  }
+  if (bench::outputs().empty()) {
+    bench::logger().warn("The demo doesn't show or print anything, nothing to evaluate.");
+  }
+  std::vector<const bench::Input*> sweep;
+  std::vector<const bench::Input*> random;
+  for (const auto& label : opts.mSweep) {
+    sweep.push_back(&bench::inputByLabel(label));
+  }
+  for (const auto& label : opts.mRandom) {
+    random.push_back(&bench::inputByLabel(label));
+  }
+  if (sweep.empty() && random.empty()) {
+    bench::logger().warn(
+      "No inputs are perturbed, so only the first evaluation does any work.");
+  }
+  report.mFirstMs = evaluateOutputs();
+  std::mt19937_64                        rng(opts.mSeed);
+  std::uniform_real_distribution<double> dist(0., 1.);
+  size_t total = opts.mWarmup + opts.mIterations;
+  for (size_t i = 0; i < total; i++) {
+    if (i == opts.mWarmup) {
+      // The profile only covers the measured iterations.
+      func::profile::reset();
+    }
+    // The swept inputs go from the minimum to the maximum of their range, over all the
+    // iterations including the warmup.
+    double fraction = total > 1 ? double(i) / double(total - 1) : 0.;
+    for (const auto* input : sweep) {
+      input->mSetFraction(fraction);
+    }
+    for (const auto* input : random) {
+      input->mSetFraction(dist(rng));
+    }
+    double ms = evaluateOutputs();
+    if (i >= opts.mWarmup) {
+      report.mSamples.push_back(ms);
+    }
+  }
+  return report;
+}
+
+int main(int argc, char** argv)
+{
+  cxxopts::Options opts(
+    "galbench",
+    "Evaluates the function graph of a demo without a window, and reports the latency "
+    "of the evaluation as JSON");
+  Options options;
+  // clang-format off
+  opts.add_options()
+    ("help", "Print help")
+    ("filepath", "Path to the demo file",
+     cxxopts::value<fs::path>(options.mPath), "<filepath>")
+    ("n,iterations", "Number of measured iterations",
+     cxxopts::value<size_t>(options.mIterations)->default_value("100"))
+    ("w,warmup", "Number of iterations run before measuring",
+     cxxopts::value<size_t>(options.mWarmup)->default_value("5"))
+    ("sweep", "Label of an input to sweep from its minimum to its maximum",
+     cxxopts::value<std::vector<std::string>>(options.mSweep), "<label>")
+    ("random", "Label of an input to set to a random value in every iteration",
+     cxxopts::value<std::vector<std::string>>(options.mRandom), "<label>")
+    ("seed", "Seed for the random values",
+     cxxopts::value<uint64_t>(options.mSeed)->default_value("42"))
+    ("serial", "Evaluate the functions one after another on a single thread",
+     cxxopts::value<bool>(options.mSerial))
+    ("profile", "Include the per-function profile in the report",
+     cxxopts::value<bool>(options.mProfile))
+    ("cache", "Directory to cache the outputs of expensive functions in",
+     cxxopts::value<fs::path>(options.mCacheDir), "<directory>")
+    ("o,output", "Write the report to this file instead of the standard output",
+     cxxopts::value<fs::path>(options.mOutput), "<file>");
+  // clang-format on
+  opts.positional_help("<path/to/demo/file>");
+  opts.parse_positional({"filepath"});
+  auto parsed = opts.parse(argc, argv);
+  if (parsed.count("help")) {
+    std::cout << opts.help() << std::endl;
+    return 0;
+  }
+  if (parsed.count("filepath") == 0) {
+    std::cerr << "Please provide the path to the demo file.\n";
+    return 1;
+  }
+  if (!fs::is_regular_file(options.mPath)) {
+    std::cerr << "The given path does not point to an existing file.\n";
+    return 1;
+  }
+  // The standard output is reserved for the report.
+  func::logger().sinks() = {std::make_shared<spdlog::sinks::stderr_color_sink_mt>()};
+  func::setParallelEvaluation(!options.mSerial);
+  func::profile::setEnabled(options.mProfile);
+  if (parsed.count("cache")) {
+    try {
+      func::cache::setDirectory(options.mCacheDir);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "Unable to use the cache directory: " << e.what() << std::endl;
+      return 1;
+    }
+  }
+  initPythonEnvironment();
+  py::scoped_interpreter guard {};
+  Report report;
+  try {
+    report = runBenchmark(options);
+  }
+  catch (const std::exception& e) {
+    PyErr_Print();
+    bench::logger().critical("Benchmark failed: {}", e.what());
+    return 1;
+  }
+  if (options.mOutput.empty()) {
+    writeReport(options, report, std::cout);
+  }
+  else {
+    std::ofstream file(options.mOutput);
+    if (!file) {
+      std::cerr << "Unable to write the report to " << options.mOutput << std::endl;
+      return 1;
+    }
+    writeReport(options, report, file);
+  }
+  return 0;
+}
@@ -34,6 +34,40 @@ bool Circle2d::contains(const glm::vec2& pt, float tolerance) const
   return glm::distance(mCenter, pt) <= mRadius + tolerance;
 };
 
+float Circle2d::signedDistance(const glm::vec2& pt) const
+{
+  return glm::distance(mCenter, pt) - mRadius;
+}
+
+glm::vec2 Circle2d::closestPoint(const glm::vec2& pt) const
+{
+  glm::vec2 d = pt - mCenter;
+  float     l = glm::length(d);
+  if (l == 0.f) {
+    // Every point on the circle is equidistant.
+    return mCenter + glm::vec2 {mRadius, 0.f};
+  }
+  return mCenter + d * (mRadius / l);
+}
+
+void Circle2d::signedDistance(const glm::vec2* pts, size_t n, float* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = glm::distance(mCenter, pts[i]) - mRadius;
+    }
+  });
+}
+
+void Circle2d::closestPoints(const glm::vec2* pts, size_t n, glm::vec2* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = closestPoint(pts[i]);
+    }
+  });
+}
+
 float Circle2d::area() const
 {
   return M_PI * mRadius * mRadius;
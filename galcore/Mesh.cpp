@@ -5,6 +5,7 @@
 #include <Util.h>
 #include <math.h>
 #include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #include <tbb/parallel_reduce.h>
 #include <OpenMesh/Core/IO/MeshIO.hh>
@@ -254,6 +255,14 @@ void TriMesh::transform(const glm::mat4& mat)
   update_normals();
 }
 
+void TriMesh::clear()
+{
+  // Unlike clear(), clean() keeps the properties, such as the normals and the colors.
+  BaseMesh::clean();
+  mFaceTree.expire();
+  mVertexTree.expire();
+}
+
 TriMesh TriMesh::subMesh(std::span<const int> faces) const
 {
   std::vector<VertH> newVerts(n_vertices());
@@ -437,6 +446,19 @@ TriMesh makeRectangularMesh(const gal::Plane& plane, const gal::Box2& box, float
   return mesh;
 }
 
+std::vector<std::array<glm::vec3, 3>> faceTriangles(const TriMesh& mesh)
+{
+  std::vector<std::array<glm::vec3, 3>> tris(mesh.n_faces());
+  tbb::parallel_for(size_t(0), tris.size(), [&](size_t fi) {
+    FaceH fh = mesh.face_handle(int(fi));
+    std::transform(mesh.cfv_begin(fh),
+                   mesh.cfv_end(fh),
+                   tris[fi].begin(),
+                   [&](VertH v) { return mesh.point(v); });
+  });
+  return tris;
+}
+
 PolyMesh::PolyMesh()
 {
   initVertexColors(*this);
@@ -460,6 +482,11 @@ void PolyMesh::transform(const glm::mat4& mat)
     vertices(), [&](VertH v) { point(v) = glm::vec3(mat * glm::vec4(point(v), 1.f)); });
 }
 
+void PolyMesh::clear()
+{
+  BaseMesh::clean();
+}
+
 PolyMesh PolyMesh::subMesh(std::span<const int32_t> faces) const
 {
   std::vector<VertH> newVerts(n_vertices());
@@ -486,4 +513,58 @@ PolyMesh PolyMesh::subMesh(std::span<const int32_t> faces) const
   return smesh;
 }
 
+TriMesh Serial<TriMesh>::deserialize(Bytes& bytes)
+{
+  uint64_t nverts = 0;
+  uint64_t nfaces = 0;
+  bytes >> nverts >> nfaces;
+  std::vector<glm::vec3> points(nverts);
+  std::vector<int32_t>   fvs(nfaces * 3);
+  bytes.readBytes(points.size() * sizeof(glm::vec3), (char*)points.data());
+  bytes.readBytes(fvs.size() * sizeof(int32_t), (char*)fvs.data());
+  TriMesh mesh;
+  mesh.reserve(nverts, nfaces * 3 / 2, nfaces);
+  for (const glm::vec3& pt : points) {
+    mesh.add_vertex(pt);
+  }
+  for (size_t fi = 0; fi < nfaces; fi++) {
+    std::array<VertH, 3> vhs;
+    for (size_t i = 0; i < 3; i++) {
+      int32_t vi = fvs[3 * fi + i];
+      if (vi < 0 || uint64_t(vi) >= nverts) {
+        throw std::out_of_range("Invalid vertex index in the serialized mesh");
+      }
+      vhs[i] = mesh.vertex_handle(vi);
+    }
+    mesh.add_face(vhs.data(), vhs.size());
+  }
+  mesh.update_normals();
+  return mesh;
+}
+
+Bytes Serial<TriMesh>::serialize(const TriMesh& mesh)
+{
+  // Deleted vertices are skipped, so the remaining vertices are renumbered.
+  std::vector<int32_t>   indices(mesh.n_vertices(), -1);
+  std::vector<glm::vec3> points;
+  points.reserve(mesh.n_vertices());
+  for (VertH vh : mesh.vertices()) {
+    indices[vh.idx()] = int32_t(points.size());
+    points.push_back(mesh.point(vh));
+  }
+  std::vector<int32_t> fvs;
+  fvs.reserve(mesh.n_faces() * 3);
+  for (FaceH fh : mesh.faces()) {
+    std::transform(mesh.cfv_begin(fh),
+                   mesh.cfv_end(fh),
+                   std::back_inserter(fvs),
+                   [&](VertH vh) { return indices[vh.idx()]; });
+  }
+  Bytes bytes;
+  bytes << uint64_t(points.size()) << uint64_t(fvs.size() / 3);
+  bytes.writeBytes((const char*)points.data(), points.size() * sizeof(glm::vec3));
+  bytes.writeBytes((const char*)fvs.data(), fvs.size() * sizeof(int32_t));
+  return bytes;
+}
+
 }  // namespace gal
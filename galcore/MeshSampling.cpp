@@ -0,0 +1,203 @@
+#include <MeshSampling.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/gtx/norm.hpp>
+#include <stdexcept>
+#include <utility>
+
+namespace gal {
+
+using Triangle = std::array<glm::vec3, 3>;
+
+// Number of candidates per unit area, relative to 1 / radius^2, drawn for Poisson disk
+// sampling. A maximal Poisson disk set has fewer than 1.2 samples per radius^2.
+static constexpr float  PoissonCandidateDensity = 16.f;
+static constexpr int    NumPhases               = 27;
+static constexpr size_t NoSample                = SIZE_MAX;
+
+size_t MeshSamples::size() const
+{
+  return points.size();
+}
+
+void MeshSamples::resize(size_t n)
+{
+  points.resize(n);
+  faces.resize(n);
+  barycentrics.resize(n);
+}
+
+static std::vector<Triangle> meshTriangles(const TriMesh& mesh)
+{
+  std::vector<Triangle> tris = faceTriangles(mesh);
+  if (tris.empty()) {
+    throw std::invalid_argument("Cannot sample the surface of a mesh without faces");
+  }
+  return tris;
+}
+
+static utils::DiscreteDistribution areaDistribution(const std::vector<Triangle>& tris)
+{
+  std::vector<float> areas(tris.size());
+  tbb::parallel_for(size_t(0), tris.size(), [&](size_t i) {
+    const Triangle& t = tris[i];
+    areas[i]          = 0.5f * glm::length(glm::cross(t[1] - t[0], t[2] - t[0]));
+  });
+  return utils::DiscreteDistribution(areas);
+}
+
+/**
+ * @brief Fills the samples with uniformly distributed points on the triangles. Sample i
+ * uses the random words [3 * (offset + i), 3 * (offset + i) + 3).
+ */
+static void generateSamples(const std::vector<Triangle>&       tris,
+                            const utils::DiscreteDistribution& faceDist,
+                            uint64_t                           seed,
+                            uint64_t                           offset,
+                            MeshSamples&                       samples)
+{
+  utils::CounterRNG rng(seed);
+  utils::parallelFor(samples.size(), [&](size_t begin, size_t end) {
+    std::vector<float> u(3 * (end - begin));
+    rng.fillUniform(3 * (offset + begin), u.size(), u.data());
+    for (size_t i = begin; i < end; i++) {
+      const float* ui = u.data() + 3 * (i - begin);
+      size_t       fi = faceDist.sample(ui[0]);
+      // The square root makes the samples uniform over the area of the triangle.
+      float           s    = std::sqrt(ui[1]);
+      glm::vec3       bary = {1.f - s, s * (1.f - ui[2]), s * ui[2]};
+      const Triangle& t    = tris[fi];
+      samples.points[i]       = t[0] * bary[0] + t[1] * bary[1] + t[2] * bary[2];
+      samples.faces[i]        = int(fi);
+      samples.barycentrics[i] = bary;
+    }
+  });
+}
+
+MeshSamples sampleSurface(const TriMesh& mesh,
+                          size_t         count,
+                          uint64_t       seed,
+                          uint64_t       offset)
+{
+  MeshSamples samples;
+  if (count == 0) {
+    return samples;
+  }
+  std::vector<Triangle> tris = meshTriangles(mesh);
+  samples.resize(count);
+  generateSamples(tris, areaDistribution(tris), seed, offset, samples);
+  return samples;
+}
+
+MeshSamples samplePoissonDisk(const TriMesh& mesh, float radius, uint64_t seed)
+{
+  if (!(radius > 0.f)) {
+    throw std::invalid_argument("The radius for Poisson disk sampling must be positive");
+  }
+  std::vector<Triangle>       tris     = meshTriangles(mesh);
+  utils::DiscreteDistribution faceDist = areaDistribution(tris);
+  MeshSamples                 cands;
+  cands.resize(
+    size_t(std::ceil(PoissonCandidateDensity * faceDist.total() / (radius * radius))));
+  generateSamples(tris, faceDist, seed, 0, cands);
+  // The diagonal of a cell is the radius, so a cell can hold at most one sample.
+  const float      cellSize = radius / std::sqrt(3.f);
+  const Box3       bounds   = mesh.bounds();
+  const glm::ivec3 dims     = glm::ivec3(bounds.diagonal() / cellSize) + 1;
+  auto             cellOf   = [&](const glm::vec3& pt) {
+    return glm::clamp(
+      glm::ivec3((pt - bounds.min) / cellSize), glm::ivec3(0), dims - 1);
+  };
+  auto keyOf = [&](const glm::ivec3& c) {
+    return uint64_t(c.x) +
+           uint64_t(dims.x) * (uint64_t(c.y) + uint64_t(dims.y) * uint64_t(c.z));
+  };
+  // Sort the candidates by cell. Ties are broken by the index of the candidate, which
+  // keeps the order independent of the sorting algorithm.
+  std::vector<std::pair<uint64_t, size_t>> order(cands.size());
+  tbb::parallel_for(size_t(0), order.size(), [&](size_t i) {
+    order[i] = {keyOf(cellOf(cands.points[i])), i};
+  });
+  tbb::parallel_sort(order.begin(), order.end());
+  std::vector<uint64_t>   cellKeys;
+  std::vector<size_t>     cellStarts;
+  std::vector<glm::ivec3> cellCoords;
+  for (size_t i = 0; i < order.size(); i++) {
+    if (i == 0 || order[i].first != order[i - 1].first) {
+      cellKeys.push_back(order[i].first);
+      cellStarts.push_back(i);
+      cellCoords.push_back(cellOf(cands.points[order[i].second]));
+    }
+  }
+  cellStarts.push_back(order.size());
+  // Cells in the same phase are at least 3 cells apart along some axis, i.e. farther
+  // than the radius, and never look at each other's samples.
+  std::array<std::vector<size_t>, NumPhases> phases;
+  size_t                                     nTrials = 0;
+  for (size_t ci = 0; ci < cellKeys.size(); ci++) {
+    const glm::ivec3& c = cellCoords[ci];
+    phases[(c.x % 3) + 3 * (c.y % 3) + 9 * (c.z % 3)].push_back(ci);
+    nTrials = std::max(nTrials, cellStarts[ci + 1] - cellStarts[ci]);
+  }
+  std::vector<size_t> accepted(cellKeys.size(), NoSample);
+  const float         radius2   = radius * radius;
+  auto                conflicts = [&](const glm::ivec3& cell, const glm::vec3& pt) {
+    for (int dz = -2; dz < 3; dz++) {
+      for (int dy = -2; dy < 3; dy++) {
+        for (int dx = -2; dx < 3; dx++) {
+          glm::ivec3 nb = cell + glm::ivec3(dx, dy, dz);
+          if (nb.x < 0 || nb.y < 0 || nb.z < 0 || nb.x >= dims.x || nb.y >= dims.y ||
+              nb.z >= dims.z) {
+            continue;
+          }
+          uint64_t key   = keyOf(nb);
+          auto     match = std::lower_bound(cellKeys.begin(), cellKeys.end(), key);
+          if (match == cellKeys.end() || *match != key) {
+            continue;
+          }
+          size_t other = accepted[std::distance(cellKeys.begin(), match)];
+          if (other != NoSample && glm::distance2(cands.points[other], pt) < radius2) {
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  };
+  // In trial t, every empty cell throws its t-th candidate.
+  for (size_t trial = 0; trial < nTrials; trial++) {
+    for (const auto& phase : phases) {
+      tbb::parallel_for(size_t(0), phase.size(), [&](size_t pi) {
+        size_t ci  = phase[pi];
+        size_t pos = cellStarts[ci] + trial;
+        if (accepted[ci] != NoSample || pos >= cellStarts[ci + 1]) {
+          return;
+        }
+        size_t cand = order[pos].second;
+        if (!conflicts(cellCoords[ci], cands.points[cand])) {
+          accepted[ci] = cand;
+        }
+      });
+    }
+  }
+  MeshSamples samples;
+  samples.resize(std::count_if(
+    accepted.begin(), accepted.end(), [](size_t a) { return a != NoSample; }));
+  size_t si = 0;
+  for (size_t cand : accepted) {
+    if (cand == NoSample) {
+      continue;
+    }
+    samples.points[si]       = cands.points[cand];
+    samples.faces[si]        = cands.faces[cand];
+    samples.barycentrics[si] = cands.barycentrics[cand];
+    ++si;
+  }
+  return samples;
+}
+
+}  // namespace gal
@@ -64,4 +64,33 @@ const glm::vec3& Plane::yaxis() const
   return mYAxis;
 };
 
+float Plane::signedDistance(const glm::vec3& pt) const
+{
+  return glm::dot(pt - mOrigin, mNormal);
+}
+
+glm::vec3 Plane::project(const glm::vec3& pt) const
+{
+  return pt - mNormal * signedDistance(pt);
+}
+
+void Plane::signedDistance(const glm::vec3* pts, size_t n, float* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = glm::dot(pts[i] - mOrigin, mNormal);
+    }
+  });
+}
+
+void Plane::project(const glm::vec3* pts, size_t n, glm::vec3* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const glm::vec3& p = pts[i];
+      dst[i]             = p - mNormal * glm::dot(p - mOrigin, mNormal);
+    }
+  });
+}
+
 }  // namespace gal
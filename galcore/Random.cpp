@@ -0,0 +1,240 @@
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_scan.h>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <Random.h>
+#include <Util.h>
+
+namespace gal {
+namespace utils {
+
+static constexpr uint32_t PHILOX_M0     = 0xD2511F53;
+static constexpr uint32_t PHILOX_M1     = 0xCD9E8D57;
+static constexpr uint32_t PHILOX_W0     = 0x9E3779B9;
+static constexpr uint32_t PHILOX_W1     = 0xBB67AE85;
+static constexpr int      PHILOX_ROUNDS = 10;
+// Number of blocks generated together in a batch. The rounds are applied to all the
+// blocks of a batch in lockstep, which the compiler can vectorize.
+static constexpr size_t BATCH_SIZE = 16;
+
+static inline void philoxRound(uint32_t& c0,
+                               uint32_t& c1,
+                               uint32_t& c2,
+                               uint32_t& c3,
+                               uint32_t  k0,
+                               uint32_t  k1)
+{
+  uint64_t p0 = uint64_t(PHILOX_M0) * uint64_t(c0);
+  uint64_t p1 = uint64_t(PHILOX_M1) * uint64_t(c2);
+  uint32_t h0 = uint32_t(p0 >> 32);
+  uint32_t l0 = uint32_t(p0);
+  uint32_t h1 = uint32_t(p1 >> 32);
+  uint32_t l1 = uint32_t(p1);
+  c0          = h1 ^ c1 ^ k0;
+  c1          = l1;
+  c2          = h0 ^ c3 ^ k1;
+  c3          = l0;
+}
+
+static inline CounterRNG::Block philox(uint64_t blockIndex, uint64_t seed)
+{
+  uint32_t c0 = uint32_t(blockIndex);
+  uint32_t c1 = uint32_t(blockIndex >> 32);
+  uint32_t c2 = 0;
+  uint32_t c3 = 0;
+  uint32_t k0 = uint32_t(seed);
+  uint32_t k1 = uint32_t(seed >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    philoxRound(c0, c1, c2, c3, k0, k1);
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  return {c0, c1, c2, c3};
+}
+
+/**
+ * @brief Generates BATCH_SIZE consecutive blocks starting at the given block index, and
+ * writes them to dst, in the same order as the samples.
+ */
+static void philoxBatch(uint64_t firstBlock, uint64_t seed, uint32_t* dst)
+{
+  alignas(64) uint32_t c0[BATCH_SIZE];
+  alignas(64) uint32_t c1[BATCH_SIZE];
+  alignas(64) uint32_t c2[BATCH_SIZE];
+  alignas(64) uint32_t c3[BATCH_SIZE];
+  for (size_t i = 0; i < BATCH_SIZE; i++) {
+    uint64_t b = firstBlock + i;
+    c0[i]      = uint32_t(b);
+    c1[i]      = uint32_t(b >> 32);
+    c2[i]      = 0;
+    c3[i]      = 0;
+  }
+  uint32_t k0 = uint32_t(seed);
+  uint32_t k1 = uint32_t(seed >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+      philoxRound(c0[i], c1[i], c2[i], c3[i], k0, k1);
+    }
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  for (size_t i = 0; i < BATCH_SIZE; i++) {
+    dst[4 * i]     = c0[i];
+    dst[4 * i + 1] = c1[i];
+    dst[4 * i + 2] = c2[i];
+    dst[4 * i + 3] = c3[i];
+  }
+}
+
+/**
+ * @brief Serially writes the random words with indices [offset, offset + count) to dst.
+ */
+static void generateBits(uint64_t seed, uint64_t offset, size_t count, uint32_t* dst)
+{
+  static constexpr size_t BatchWords = 4 * BATCH_SIZE;
+  alignas(64) uint32_t    words[BatchWords];
+  uint64_t                pos = offset;
+  uint64_t                end = offset + count;
+  // Head, up to the first batch boundary.
+  while (pos < end && pos % BatchWords != 0) {
+    *(dst++) = philox(pos / 4, seed)[pos % 4];
+    ++pos;
+  }
+  // Full batches.
+  while (end - pos >= BatchWords) {
+    philoxBatch(pos / 4, seed, dst);
+    dst += BatchWords;
+    pos += BatchWords;
+  }
+  // Tail.
+  if (pos < end) {
+    philoxBatch(pos / 4, seed, words);
+    std::copy_n(words, size_t(end - pos), dst);
+  }
+}
+
+CounterRNG::CounterRNG(uint64_t seed)
+    : mSeed(seed)
+{}
+
+uint64_t CounterRNG::seed() const
+{
+  return mSeed;
+}
+
+CounterRNG::Block CounterRNG::block(uint64_t blockIndex) const
+{
+  return philox(blockIndex, mSeed);
+}
+
+uint32_t CounterRNG::bits(uint64_t index) const
+{
+  return block(index / 4)[index % 4];
+}
+
+float CounterRNG::uniform(uint64_t index) const
+{
+  return toUniform(bits(index));
+}
+
+void CounterRNG::fillBits(uint64_t offset, size_t count, uint32_t* dst) const
+{
+  parallelFor(count, [&](size_t begin, size_t end) {
+    generateBits(mSeed, offset + begin, end - begin, dst + begin);
+  });
+}
+
+void CounterRNG::fillUniform(uint64_t offset, size_t count, float* dst) const
+{
+  static constexpr float zero = 0.f;
+  static constexpr float one  = 1.f;
+  fillUniform(offset, count, &zero, &one, 1, dst);
+}
+
+void CounterRNG::fillUniform(uint64_t     offset,
+                             size_t       count,
+                             const float* min,
+                             const float* max,
+                             size_t       stride,
+                             float*       dst) const
+{
+  auto generate = [&](size_t begin, size_t end) {
+    static constexpr size_t ChunkSize = 1024;
+    alignas(64) uint32_t    words[ChunkSize];
+    size_t                  j = size_t((offset + begin) % stride);
+    while (begin < end) {
+      size_t n = std::min(ChunkSize, end - begin);
+      generateBits(mSeed, offset + begin, n, words);
+      for (size_t i = 0; i < n; i++) {
+        dst[begin + i] = min[j] + (max[j] - min[j]) * toUniform(words[i]);
+        if (++j == stride) {
+          j = 0;
+        }
+      }
+      begin += n;
+    }
+  };
+  parallelFor(count, generate);
+}
+
+DiscreteDistribution::DiscreteDistribution(std::span<const float> weights)
+    : mCumulative(weights.size())
+    , mGuide(weights.size())
+{
+  if (weights.empty()) {
+    throw std::invalid_argument("Cannot create a distribution without weights");
+  }
+  tbb::parallel_scan(
+    tbb::blocked_range<size_t>(0, weights.size()),
+    0.,
+    [&](const tbb::blocked_range<size_t>& r, double sum, bool isFinal) {
+      for (size_t i = r.begin(); i < r.end(); i++) {
+        sum += double(weights[i]);
+        if (isFinal) {
+          mCumulative[i] = sum;
+        }
+      }
+      return sum;
+    },
+    std::plus<double>());
+  if (!(total() > 0.)) {
+    throw std::invalid_argument("The weights of a distribution must add up to more "
+                                "than zero");
+  }
+  // Guide entry b is the first index whose cumulative weight exceeds the start of the
+  // bucket b. Lookups start from the guide entry and only scan forward a few entries.
+  double bucket = total() / double(mGuide.size());
+  tbb::parallel_for(size_t(0), mGuide.size(), [&](size_t b) {
+    auto match = std::upper_bound(mCumulative.begin(), mCumulative.end(), bucket * b);
+    mGuide[b]  = uint32_t(std::min(size_t(std::distance(mCumulative.begin(), match)),
+                                  mCumulative.size() - 1));
+  });
+}
+
+size_t DiscreteDistribution::size() const
+{
+  return mCumulative.size();
+}
+
+double DiscreteDistribution::total() const
+{
+  return mCumulative.empty() ? 0. : mCumulative.back();
+}
+
+size_t DiscreteDistribution::sample(float u) const
+{
+  size_t nGuide = mGuide.size();
+  size_t b      = std::min(size_t(double(u) * double(nGuide)), nGuide - 1);
+  size_t i      = mGuide[b];
+  double target = double(u) * total();
+  while (i + 1 < mCumulative.size() && mCumulative[i] <= target) {
+    ++i;
+  }
+  return i;
+}
+
+}  // namespace utils
+}  // namespace gal
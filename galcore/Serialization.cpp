@@ -47,11 +47,24 @@ void Bytes::saveToFile(const fs::path& path) const
   file.close();
 }
 
+const char* Bytes::data() const noexcept
+{
+  return mData.data();
+}
+
+size_t Bytes::size() const noexcept
+{
+  return mData.size();
+}
+
 Bytes Bytes::loadFromFile(const fs::path& filepath)
 {
   std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-  auto          pos = file.tellg();
-  Bytes         bytes;
+  if (!file) {
+    throw std::runtime_error("Cannot open file " + filepath.string());
+  }
+  auto  pos = file.tellg();
+  Bytes bytes;
   bytes.mData.resize(size_t(pos));
 
   file.seekg(0, std::ios::beg);
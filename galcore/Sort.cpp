@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <utility>
+
+#include <Sort.h>
+
+namespace gal {
+namespace utils {
+
+static constexpr int    RADIX_BITS    = 8;
+static constexpr size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+
+static inline uint32_t radixKey(int32_t value)
+{
+  return uint32_t(value) ^ 0x80000000u;
+}
+
+static inline uint32_t radixKey(float value)
+{
+  // Both zeros map to the bits of the positive zero.
+  uint32_t bits = std::bit_cast<uint32_t>(value == 0.f ? 0.f : value);
+  // Negative floats are ordered in reverse by their bits.
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/**
+ * @brief Sorts the items by their upper 32 bits. The lower 32 bits are the original
+ * indices, so the items are unique, and the order of equal keys is preserved.
+ */
+static void radixSort(std::vector<uint64_t>& items)
+{
+  size_t n = items.size();
+  if (n < ParallelThreshold) {
+    std::sort(items.begin(), items.end());
+    return;
+  }
+  std::vector<uint64_t> temp(n);
+  std::vector<std::array<size_t, RADIX_BUCKETS>> offsets(numBlocks(n));
+  for (int shift = 32; shift < 64; shift += RADIX_BITS) {
+    auto digit = [shift](uint64_t item) {
+      return size_t(item >> shift) & (RADIX_BUCKETS - 1);
+    };
+    forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+      auto& counts = offsets[block];
+      counts.fill(0);
+      for (size_t i = begin; i < end; i++) {
+        counts[digit(items[i])]++;
+      }
+    });
+    // Skip the digits that are the same for all the items.
+    size_t first = 0;
+    for (const auto& counts : offsets) {
+      first += counts[digit(items.front())];
+    }
+    if (first == n) {
+      continue;
+    }
+    size_t sum = 0;
+    for (size_t d = 0; d < RADIX_BUCKETS; d++) {
+      for (auto& counts : offsets) {
+        sum += std::exchange(counts[d], sum);
+      }
+    }
+    forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+      auto& pos = offsets[block];
+      for (size_t i = begin; i < end; i++) {
+        temp[pos[digit(items[i])]++] = items[i];
+      }
+    });
+    std::swap(items, temp);
+  }
+}
+
+template<typename T>
+static void radixArgsortInternal(std::span<const T> keys, std::span<size_t> dst)
+{
+  size_t n = keys.size();
+  if (n > size_t(std::numeric_limits<uint32_t>::max())) {
+    // The indices don't fit next to the keys.
+    sampleArgsort(keys, dst, std::less<T>());
+    return;
+  }
+  std::vector<uint64_t> items(n);
+  parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      items[i] = (uint64_t(radixKey(keys[i])) << 32) | uint64_t(i);
+    }
+  });
+  radixSort(items);
+  parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = size_t(uint32_t(items[i]));
+    }
+  });
+}
+
+void radixArgsort(std::span<const float> keys, std::span<size_t> dst)
+{
+  radixArgsortInternal(keys, dst);
+}
+
+void radixArgsort(std::span<const int32_t> keys, std::span<size_t> dst)
+{
+  radixArgsortInternal(keys, dst);
+}
+
+}  // namespace utils
+}  // namespace gal
@@ -19,6 +19,40 @@ bool Sphere::contains(const glm::vec3& pt, float tolerance) const
   return glm::distance(center, pt) <= radius + tolerance;
 }
 
+float Sphere::signedDistance(const glm::vec3& pt) const
+{
+  return glm::distance(center, pt) - radius;
+}
+
+glm::vec3 Sphere::closestPoint(const glm::vec3& pt) const
+{
+  glm::vec3 d = pt - center;
+  float     l = glm::length(d);
+  if (l == 0.f) {
+    // Every point on the sphere is equidistant.
+    return center + glm::vec3 {radius, 0.f, 0.f};
+  }
+  return center + d * (radius / l);
+}
+
+void Sphere::signedDistance(const glm::vec3* pts, size_t n, float* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = glm::distance(center, pts[i]) - radius;
+    }
+  });
+}
+
+void Sphere::closestPoints(const glm::vec3* pts, size_t n, glm::vec3* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = closestPoint(pts[i]);
+    }
+  });
+}
+
 Sphere Sphere::createCircumsphere(const glm::vec3& a,
                                   const glm::vec3& b,
                                   const glm::vec3& c,
@@ -1,5 +1,6 @@
 #include <cmath>
 #include <filesystem>
+#include <stdexcept>
 #include <string>
 
 #ifdef _MSC_VER
@@ -128,5 +129,46 @@ size_t numCombinations(size_t n, size_t k)
   return c;
 }
 
+void combinationAt(size_t rank, size_t n, size_t k, size_t* dst)
+{
+  if (rank >= numCombinations(n, k)) {
+    throw std::out_of_range("Combination rank out of range");
+  }
+  size_t c = 0;
+  for (size_t i = 0; i < k; i++) {
+    // Number of combinations that start with c at position i.
+    size_t count = numCombinations(n - c - 1, k - i - 1);
+    while (rank >= count) {
+      rank -= count;
+      c++;
+      count = numCombinations(n - c - 1, k - i - 1);
+    }
+    dst[i] = c++;
+  }
+}
+
+std::vector<size_t> combinationAt(size_t rank, size_t n, size_t k)
+{
+  std::vector<size_t> comb(k);
+  combinationAt(rank, n, k, comb.data());
+  return comb;
+}
+
+bool nextCombination(size_t n, size_t k, size_t* comb)
+{
+  size_t i = k;
+  while (i > 0) {
+    --i;
+    if (comb[i] < n - k + i) {
+      size_t c = ++comb[i];
+      for (size_t j = i + 1; j < k; j++) {
+        comb[j] = ++c;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace utils
 }  // namespace gal
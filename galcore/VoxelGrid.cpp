@@ -0,0 +1,445 @@
+#include <VoxelGrid.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/blocked_range2d.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <glm/gtx/norm.hpp>
+#include <iterator>
+#include <stdexcept>
+
+namespace gal {
+
+using Triangle = VoxelGrid::Triangle;
+
+/**
+ * @brief Squared distance from the point to the triangle (Ericson, Real-Time Collision
+ * Detection, 5.1.5).
+ */
+static float triangleDistance2(const Triangle& t, const glm::vec3& p)
+{
+  const glm::vec3& a  = t[0];
+  const glm::vec3& b  = t[1];
+  const glm::vec3& c  = t[2];
+  glm::vec3        ab = b - a;
+  glm::vec3        ac = c - a;
+  glm::vec3        ap = p - a;
+  float            d1 = glm::dot(ab, ap);
+  float            d2 = glm::dot(ac, ap);
+  if (d1 <= 0.f && d2 <= 0.f) {
+    return glm::length2(ap);
+  }
+  glm::vec3 bp = p - b;
+  float     d3 = glm::dot(ab, bp);
+  float     d4 = glm::dot(ac, bp);
+  if (d3 >= 0.f && d4 <= d3) {
+    return glm::length2(bp);
+  }
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+    float v = d1 / (d1 - d3);
+    return glm::length2(ap - ab * v);
+  }
+  glm::vec3 cp = p - c;
+  float     d5 = glm::dot(ab, cp);
+  float     d6 = glm::dot(ac, cp);
+  if (d6 >= 0.f && d5 <= d6) {
+    return glm::length2(cp);
+  }
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+    float w = d2 / (d2 - d6);
+    return glm::length2(ap - ac * w);
+  }
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+    float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    return glm::length2(bp - (c - b) * w);
+  }
+  float denom = 1.f / (va + vb + vc);
+  float v     = vb * denom;
+  float w     = vc * denom;
+  return glm::length2(ap - ab * v - ac * w);
+}
+
+/**
+ * @brief Intersects the line parallel to the x axis, passing through (y, z), with the
+ * triangle.
+ *
+ * @return true If the line crosses the triangle. The x coordinate of the crossing is
+ * written to x.
+ */
+static bool rowCrossing(const Triangle& t, float y, float z, float& x)
+{
+  auto edge = [y, z](const glm::vec3& a, const glm::vec3& b) {
+    return (b.y - a.y) * (z - a.z) - (b.z - a.z) * (y - a.y);
+  };
+  float w0          = edge(t[1], t[2]);
+  float w1          = edge(t[2], t[0]);
+  float w2          = edge(t[0], t[1]);
+  bool  allPositive = w0 > 0.f && w1 > 0.f && w2 > 0.f;
+  bool  allNegative = w0 < 0.f && w1 < 0.f && w2 < 0.f;
+  if (!(allPositive || allNegative)) {
+    return false;
+  }
+  x = (w0 * t[0].x + w1 * t[1].x + w2 * t[2].x) / (w0 + w1 + w2);
+  return true;
+}
+
+VoxelGrid::VoxelGrid(const Box3& bounds, float cellSize, float bandWidth)
+    : mOrigin(bounds.min)
+    , mCellSize(cellSize)
+    , mBandWidth(bandWidth)
+{
+  if (!(cellSize > 0.f)) {
+    throw std::invalid_argument("The cell size of a voxel grid must be positive");
+  }
+  glm::vec3 diag = bounds.diagonal();
+  for (int i = 0; i < 3; i++) {
+    mDims[i]      = std::max(1, int(std::ceil(diag[i] / cellSize)) + 1);
+    mBlockDims[i] = (mDims[i] + BlockSize - 1) / BlockSize;
+  }
+  mBlockIndices.resize(numBlocks(), NoBlock);
+  mBlockSigns.resize(numBlocks(), SignOutside);
+}
+
+VoxelGrid VoxelGrid::fromMesh(const TriMesh& mesh,
+                              float          cellSize,
+                              float          bandWidth,
+                              bool           sparse)
+{
+  Box3 bounds = mesh.bounds();
+  // Pad the grid so that the band fits inside it.
+  bounds.inflate(bandWidth + cellSize);
+  VoxelGrid             grid(bounds, cellSize, bandWidth);
+  std::vector<Triangle> tris = faceTriangles(mesh);
+  // Build the rtree once, before it is queried from many threads.
+  mesh.updateRTrees();
+  grid.computeBandDistances(mesh, tris, sparse);
+  grid.computeSigns(mesh, tris);
+  if (!sparse && !tris.empty()) {
+    grid.sweep();
+  }
+  return grid;
+}
+
+const glm::vec3& VoxelGrid::origin() const
+{
+  return mOrigin;
+}
+
+float VoxelGrid::cellSize() const
+{
+  return mCellSize;
+}
+
+float VoxelGrid::bandWidth() const
+{
+  return mBandWidth;
+}
+
+const glm::ivec3& VoxelGrid::dims() const
+{
+  return mDims;
+}
+
+Box3 VoxelGrid::bounds() const
+{
+  return Box3(mOrigin, nodePosition(mDims - glm::ivec3(1)));
+}
+
+size_t VoxelGrid::numNodes() const
+{
+  return size_t(mDims.x) * size_t(mDims.y) * size_t(mDims.z);
+}
+
+size_t VoxelGrid::numBlocks() const
+{
+  return size_t(mBlockDims.x) * size_t(mBlockDims.y) * size_t(mBlockDims.z);
+}
+
+size_t VoxelGrid::numAllocatedBlocks() const
+{
+  return mValues.size() / BlockVolume;
+}
+
+bool VoxelGrid::isDense() const
+{
+  return numAllocatedBlocks() == numBlocks();
+}
+
+glm::vec3 VoxelGrid::nodePosition(const glm::ivec3& node) const
+{
+  return mOrigin + glm::vec3(node) * mCellSize;
+}
+
+size_t VoxelGrid::blockOf(const glm::ivec3& node) const
+{
+  glm::ivec3 b = node / BlockSize;
+  return size_t(b.x) +
+         size_t(mBlockDims.x) * (size_t(b.y) + size_t(mBlockDims.y) * size_t(b.z));
+}
+
+size_t VoxelGrid::localIndex(const glm::ivec3& node) const
+{
+  glm::ivec3 l = node % BlockSize;
+  return size_t(l.x + BlockSize * (l.y + BlockSize * l.z));
+}
+
+float* VoxelGrid::blockData(size_t block)
+{
+  uint32_t bi = mBlockIndices[block];
+  return bi == NoBlock ? nullptr : mValues.data() + size_t(bi) * BlockVolume;
+}
+
+glm::ivec3 VoxelGrid::blockFirstNode(size_t block) const
+{
+  glm::ivec3 b;
+  b.x = int(block % size_t(mBlockDims.x));
+  b.y = int((block / size_t(mBlockDims.x)) % size_t(mBlockDims.y));
+  b.z = int(block / (size_t(mBlockDims.x) * size_t(mBlockDims.y)));
+  return b * BlockSize;
+}
+
+Box3 VoxelGrid::blockBounds(size_t block) const
+{
+  glm::ivec3 first = blockFirstNode(block);
+  glm::ivec3 last  = glm::min(first + glm::ivec3(BlockSize - 1), mDims - glm::ivec3(1));
+  return Box3(nodePosition(first), nodePosition(last));
+}
+
+float VoxelGrid::value(const glm::ivec3& node) const
+{
+  size_t   block = blockOf(node);
+  uint32_t bi    = mBlockIndices[block];
+  if (bi == NoBlock) {
+    return float(mBlockSigns[block]) * mBandWidth;
+  }
+  return mValues[size_t(bi) * BlockVolume + localIndex(node)];
+}
+
+float VoxelGrid::sample(const glm::vec3& pt) const
+{
+  glm::vec3  maxu = glm::vec3(mDims - glm::ivec3(1));
+  glm::vec3  u    = glm::clamp((pt - mOrigin) / mCellSize, glm::vec3(0.f), maxu);
+  glm::ivec3 maxi = glm::max(mDims - 2, glm::ivec3(0));
+  glm::ivec3 i0   = glm::min(glm::ivec3(glm::floor(u)), maxi);
+  glm::ivec3 i1   = glm::min(i0 + 1, mDims - 1);
+  glm::vec3  t    = u - glm::vec3(i0);
+  // Interpolate along x, then y, then z.
+  float c00 = glm::mix(value({i0.x, i0.y, i0.z}), value({i1.x, i0.y, i0.z}), t.x);
+  float c10 = glm::mix(value({i0.x, i1.y, i0.z}), value({i1.x, i1.y, i0.z}), t.x);
+  float c01 = glm::mix(value({i0.x, i0.y, i1.z}), value({i1.x, i0.y, i1.z}), t.x);
+  float c11 = glm::mix(value({i0.x, i1.y, i1.z}), value({i1.x, i1.y, i1.z}), t.x);
+  return glm::mix(glm::mix(c00, c10, t.y), glm::mix(c01, c11, t.y), t.z);
+}
+
+void VoxelGrid::sample(const glm::vec3* pts, size_t n, float* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = sample(pts[i]);
+    }
+  });
+}
+
+bool VoxelGrid::contains(const glm::vec3& pt) const
+{
+  return sample(pt) <= 0.f;
+}
+
+void VoxelGrid::computeBandDistances(const TriMesh&               mesh,
+                                     const std::vector<Triangle>& tris,
+                                     bool                         sparse)
+{
+  // Collect the faces near each block using the rtree of the mesh.
+  std::vector<std::vector<int>> candidates(numBlocks());
+  tbb::parallel_for(size_t(0), numBlocks(), [&](size_t block) {
+    Box3 box = blockBounds(block);
+    box.inflate(mBandWidth);
+    mesh.queryBox(box, std::back_inserter(candidates[block]), eMeshElement::face);
+  });
+  // Allocate the blocks.
+  uint32_t nAllocated = 0;
+  for (size_t block = 0; block < numBlocks(); block++) {
+    if (!sparse || !candidates[block].empty()) {
+      mBlockIndices[block] = nAllocated++;
+    }
+  }
+  mValues.resize(size_t(nAllocated) * BlockVolume, mBandWidth);
+  // Rasterize the triangles near each block.
+  tbb::parallel_for(size_t(0), numBlocks(), [&](size_t block) {
+    const auto& faces = candidates[block];
+    float*      data  = blockData(block);
+    if (!data || faces.empty()) {
+      return;
+    }
+    glm::ivec3 first = blockFirstNode(block);
+    float      band2 = mBandWidth * mBandWidth;
+    for (int k = 0; k < BlockSize; k++) {
+      for (int j = 0; j < BlockSize; j++) {
+        for (int i = 0; i < BlockSize; i++) {
+          glm::ivec3 node = first + glm::ivec3(i, j, k);
+          if (node.x >= mDims.x || node.y >= mDims.y || node.z >= mDims.z) {
+            continue;
+          }
+          glm::vec3 pos  = nodePosition(node);
+          float     best = band2;
+          for (int fi : faces) {
+            best = std::min(best, triangleDistance2(tris[fi], pos));
+          }
+          data[localIndex(node)] = std::sqrt(best);
+        }
+      }
+    }
+  });
+}
+
+void VoxelGrid::computeSigns(const TriMesh& mesh, const std::vector<Triangle>& tris)
+{
+  // The rays are nudged off the rows, to avoid passing exactly through the edges and
+  // vertices of the mesh, which would be counted as zero or two crossings.
+  const float nudgeY = mCellSize * 1.2345e-4f;
+  const float nudgeZ = mCellSize * 2.3456e-4f;
+  const float xmin   = mOrigin.x;
+  const float xmax   = nodePosition(mDims - glm::ivec3(1)).x;
+  tbb::parallel_for(
+    tbb::blocked_range2d<int>(0, mDims.z, 0, mDims.y),
+    [&](const tbb::blocked_range2d<int>& range) {
+      std::vector<int>   faces;
+      std::vector<float> crossings;
+      for (int k = range.rows().begin(); k < range.rows().end(); k++) {
+        for (int j = range.cols().begin(); j < range.cols().end(); j++) {
+          glm::vec3 rowpos = nodePosition({0, j, k});
+          float     y      = rowpos.y + nudgeY;
+          float     z      = rowpos.z + nudgeZ;
+          faces.clear();
+          crossings.clear();
+          mesh.queryBox(Box3(glm::vec3(xmin, y, z), glm::vec3(xmax, y, z)),
+                        std::back_inserter(faces),
+                        eMeshElement::face);
+          for (int fi : faces) {
+            float x;
+            if (rowCrossing(tris[fi], y, z, x)) {
+              crossings.push_back(x);
+            }
+          }
+          std::sort(crossings.begin(), crossings.end());
+          size_t nBefore = 0;
+          for (int i = 0; i < mDims.x; i++) {
+            glm::ivec3 node = {i, j, k};
+            float      x    = nodePosition(node).x;
+            while (nBefore < crossings.size() && crossings[nBefore] < x) {
+              nBefore++;
+            }
+            bool   inside = (nBefore % 2) == 1;
+            size_t block  = blockOf(node);
+            float* data   = blockData(block);
+            if (data) {
+              float& v = data[localIndex(node)];
+              v        = inside ? -std::abs(v) : std::abs(v);
+            }
+            else if (node % BlockSize == glm::ivec3(0)) {
+              // Unallocated blocks are entirely on one side of the surface, so the
+              // first node decides the sign of the block.
+              mBlockSigns[block] = inside ? SignInside : SignOutside;
+            }
+          }
+        }
+      }
+    });
+}
+
+void VoxelGrid::sweep()
+{
+  const float h  = mCellSize;
+  const float h2 = h * h;
+  // Nodes inside the band are exact, and stay frozen during the sweep.
+  std::vector<uint8_t> frozen(numNodes());
+  auto                 flatIndex = [this](const glm::ivec3& n) {
+    return size_t(n.x) + size_t(mDims.x) * (size_t(n.y) + size_t(mDims.y) * size_t(n.z));
+  };
+  auto ref = [this](const glm::ivec3& n) -> float& {
+    return blockData(blockOf(n))[localIndex(n)];
+  };
+  tbb::parallel_for(0, mDims.z, [&](int k) {
+    for (int j = 0; j < mDims.y; j++) {
+      for (int i = 0; i < mDims.x; i++) {
+        glm::ivec3 n = {i, j, k};
+        float&     v = ref(n);
+        if (std::abs(v) < mBandWidth) {
+          frozen[flatIndex(n)] = 1;
+        }
+        else {
+          v = std::copysign(FLT_MAX, v);
+        }
+      }
+    }
+  });
+  auto minNeighbor = [&](glm::ivec3 n, int axis) {
+    float best = FLT_MAX;
+    if (n[axis] > 0) {
+      glm::ivec3 m = n;
+      m[axis]--;
+      best = std::min(best, std::abs(ref(m)));
+    }
+    if (n[axis] < mDims[axis] - 1) {
+      glm::ivec3 m = n;
+      m[axis]++;
+      best = std::min(best, std::abs(ref(m)));
+    }
+    return best;
+  };
+  // Solves the discretized eikonal equation |grad u| = 1 at the node.
+  auto update = [&](const glm::ivec3& n) {
+    if (frozen[flatIndex(n)]) {
+      return;
+    }
+    std::array<float, 3> a = {minNeighbor(n, 0), minNeighbor(n, 1), minNeighbor(n, 2)};
+    std::sort(a.begin(), a.end());
+    if (a[0] == FLT_MAX) {
+      return;
+    }
+    float u = a[0] + h;
+    if (u > a[1]) {
+      float d = 2.f * h2 - (a[0] - a[1]) * (a[0] - a[1]);
+      u       = 0.5f * (a[0] + a[1] + std::sqrt(std::max(d, 0.f)));
+      if (u > a[2]) {
+        float s  = a[0] + a[1] + a[2];
+        float s2 = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+        u        = (s + std::sqrt(std::max(s * s - 3.f * (s2 - h2), 0.f))) / 3.f;
+      }
+    }
+    float& v = ref(n);
+    if (u < std::abs(v)) {
+      v = std::copysign(u, v);
+    }
+  };
+  // Fast sweeping in the 8 diagonal directions. The nodes on the plane i + j + k = L
+  // only depend on the nodes of the previous plane, so each plane is updated in
+  // parallel.
+  const int nLevels = mDims.x + mDims.y + mDims.z - 2;
+  for (int dir = 0; dir < 8; dir++) {
+    auto toNode = [&](int i, int j, int k) {
+      return glm::ivec3((dir & 1) ? mDims.x - 1 - i : i,
+                        (dir & 2) ? mDims.y - 1 - j : j,
+                        (dir & 4) ? mDims.z - 1 - k : k);
+    };
+    for (int level = 0; level < nLevels; level++) {
+      int ibegin = std::max(0, level - (mDims.y - 1) - (mDims.z - 1));
+      int iend   = std::min(mDims.x - 1, level) + 1;
+      tbb::parallel_for(ibegin, iend, [&](int i) {
+        int jbegin = std::max(0, level - i - (mDims.z - 1));
+        int jend   = std::min(mDims.y - 1, level - i) + 1;
+        for (int j = jbegin; j < jend; j++) {
+          update(toNode(i, j, level - i - j));
+        }
+      });
+    }
+  }
+}
+
+}  // namespace gal
@@ -2,6 +2,9 @@
 
 #include <span>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
 #include <Serialization.h>
 #include <Util.h>
 namespace gal {
@@ -57,14 +60,84 @@ struct Box
   float measure() const;
   bool  valid() const;
 
+  /**
+   * @brief Generates uniformly distributed random points inside the box. The points are
+   * deterministic for a given seed.
+   *
+   * @tparam DstIter Output iterator.
+   * @param n Number of points.
+   * @param dst Destination.
+   * @param seed Seed for the random number generator.
+   */
   template<typename DstIter>
-  void randomPoints(size_t n, DstIter dst) const
+  void randomPoints(size_t   n,
+                    DstIter  dst,
+                    uint64_t seed = utils::CounterRNG::DefaultSeed) const
   {
-    utils::random(min, max, n, dst);
+    utils::random(min, max, n, dst, seed);
   }
 
   VecT eval(const VecT& v) const;
 
+  /**
+   * @brief Signed distance of the point from the boundary of the box. The distance is
+   * negative for points inside the box.
+   *
+   * @param pt The point.
+   * @return float Signed distance.
+   */
+  float signedDistance(const VecT& pt) const;
+
+  /**
+   * @brief Gets the point inside or on the box that is closest to the given point.
+   *
+   * @param pt The point.
+   * @return VecT Closest point.
+   */
+  VecT closestPoint(const VecT& pt) const;
+
+  /**
+   * @brief Batch version of contains. Tests each of the n points and writes the results
+   * to dst. Large batches are processed in parallel.
+   *
+   * @tparam BoolT Type of the result. Must be constructible from bool.
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the results. Must have space for n results.
+   */
+  template<typename BoolT>
+  void contains(const VecT* pts, size_t n, BoolT* dst) const
+  {
+    utils::parallelFor(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        const VecT& p      = pts[i];
+        bool        inside = true;
+        for (int j = 0; j < Dim; ++j) {
+          inside &= (p[j] >= min[j]) & (p[j] <= max[j]);
+        }
+        dst[i] = BoolT(inside);
+      }
+    });
+  }
+
+  /**
+   * @brief Batch version of signedDistance. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n distances.
+   */
+  void signedDistance(const VecT* pts, size_t n, float* dst) const;
+
+  /**
+   * @brief Batch version of closestPoint. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n closest points.
+   */
+  void closestPoints(const VecT* pts, size_t n, VecT* dst) const;
+
   static Box init(const VecT& min, const VecT& max);
 };
 
@@ -92,9 +165,26 @@ template<int Dim>
 Box<Dim>::Box(std::span<const VecT> pts)
     : Box()
 {
-  for (const VecT& p : pts) {
-    inflate(p);
+  auto inflateRange = [&](size_t begin, size_t end, Box b) {
+    for (size_t i = begin; i < end; i++) {
+      b.inflate(pts[i]);
+    }
+    return b;
+  };
+  if (pts.size() < utils::ParallelThreshold) {
+    *this = inflateRange(0, pts.size(), *this);
+    return;
   }
+  *this = tbb::parallel_reduce(
+    tbb::blocked_range<size_t>(0, pts.size(), utils::ParallelThreshold),
+    Box(),
+    [&](const tbb::blocked_range<size_t>& r, Box b) {
+      return inflateRange(r.begin(), r.end(), b);
+    },
+    [](Box a, const Box& b) {
+      a.inflate(b);
+      return a;
+    });
 }
 
 template<int Dim>
@@ -196,6 +286,44 @@ typename Box<Dim>::VecT Box<Dim>::eval(const VecT& v) const
   return result;
 }
 
+template<int Dim>
+float Box<Dim>::signedDistance(const VecT& pt) const
+{
+  VecT  q       = glm::abs(pt - center()) - diagonal() * 0.5f;
+  float outside = glm::length(glm::max(q, VecT(0.f)));
+  float inside  = q[0];
+  for (int i = 1; i < Dim; ++i) {
+    inside = std::max(inside, q[i]);
+  }
+  return outside + std::min(inside, 0.f);
+}
+
+template<int Dim>
+typename Box<Dim>::VecT Box<Dim>::closestPoint(const VecT& pt) const
+{
+  return glm::clamp(pt, min, max);
+}
+
+template<int Dim>
+void Box<Dim>::signedDistance(const VecT* pts, size_t n, float* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = signedDistance(pts[i]);
+    }
+  });
+}
+
+template<int Dim>
+void Box<Dim>::closestPoints(const VecT* pts, size_t n, VecT* dst) const
+{
+  utils::parallelFor(n, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = closestPoint(pts[i]);
+    }
+  });
+}
+
 template<int Dim>
 Box<Dim> Box<Dim>::init(const VecT& min, const VecT& max)
 {
@@ -25,6 +25,64 @@ public:
   float            area() const;
   float            perimeter() const;
 
+  /**
+   * @brief Signed distance of the point from the circle. The distance is negative for
+   * points inside the circle.
+   *
+   * @param pt The point.
+   * @return float Signed distance.
+   */
+  float signedDistance(const glm::vec2& pt) const;
+
+  /**
+   * @brief Gets the point on the circle closest to the given point.
+   *
+   * @param pt The point.
+   * @return glm::vec2 Closest point.
+   */
+  glm::vec2 closestPoint(const glm::vec2& pt) const;
+
+  /**
+   * @brief Batch version of contains. Tests each of the n points and writes the results
+   * to dst. Large batches are processed in parallel.
+   *
+   * @tparam BoolT Type of the result. Must be constructible from bool.
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the results. Must have space for n results.
+   * @param tolerance Tolerance for points on the circle.
+   */
+  template<typename BoolT>
+  void contains(const glm::vec2* pts, size_t n, BoolT* dst, float tolerance = 0.f) const
+  {
+    // Compare squared distances to avoid the square root per point.
+    const float r  = mRadius + tolerance;
+    const float r2 = r < 0.f ? -1.f : r * r;
+    utils::parallelFor(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        dst[i] = BoolT(glm::distance2(mCenter, pts[i]) <= r2);
+      }
+    });
+  }
+
+  /**
+   * @brief Batch version of signedDistance. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n distances.
+   */
+  void signedDistance(const glm::vec2* pts, size_t n, float* dst) const;
+
+  /**
+   * @brief Batch version of closestPoint. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n closest points.
+   */
+  void closestPoints(const glm::vec2* pts, size_t n, glm::vec2* dst) const;
+
   Box2 bounds() const;
 
   static Circle2d createCircumcircle(const glm::vec2& a,
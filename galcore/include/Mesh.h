@@ -1,9 +1,11 @@
 #pragma once
 
+#include <array>
 #include <filesystem>
 #include <limits>
 #include <span>
 #include <unordered_map>
+#include <vector>
 
 #include <OpenMeshAdaptor.h>
 #include <OpenMesh/Core/Mesh/Attributes.hh>
@@ -80,6 +82,7 @@ struct TriMesh : public OpenMesh::TriMesh_ArrayKernelT<MeshTraits>
   void           transform(const glm::mat4& mat);
   TriMesh        subMesh(std::span<const int> faces) const;
   void           updateRTrees() const;
+  void           clear();
   static TriMesh loadFromFile(const fs::path& path, bool flipYZ = true);
 
 private:
@@ -121,20 +124,28 @@ public:
   static PolyMesh loadFromFile(const fs::path& path, bool flipYZ = true);
   void            transform(const glm::mat4& mat);
   PolyMesh        subMesh(std::span<const int> faces) const;
+  void            clear();
 };
 
 TriMesh makeRectangularMesh(const gal::Plane& plane,
                             const gal::Box2&  box,
                             float             edgelength);
 
+/**
+ * @brief Gets the vertex positions of every face of the mesh, in parallel. The vertices
+ * of each face are in the order of the face-vertex circulator.
+ */
+std::vector<std::array<glm::vec3, 3>> faceTriangles(const TriMesh& mesh);
+
+/**
+ * @brief A mesh is serialized as its vertex positions followed by the vertex indices of
+ * its faces. The normals are recomputed when the mesh is deserialized.
+ */
 template<>
 struct Serial<TriMesh> : public std::true_type
 {
-  static TriMesh deserialize(Bytes& bytes) { throw std::logic_error("Not Implemented"); }
-  static Bytes   serialize(const TriMesh& msh)
-  {
-    throw std::logic_error("Not Implemented");
-  }
+  static TriMesh deserialize(Bytes& bytes);
+  static Bytes   serialize(const TriMesh& mesh);
 };
 
 }  // namespace gal
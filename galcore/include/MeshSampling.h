@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Mesh.h>
+#include <PointCloud.h>
+#include <Random.h>
+
+namespace gal {
+
+/**
+ * @brief Points sampled on the surface of a mesh. Along with each point, the index of the
+ * face it lies on and its barycentric coordinates are stored. The barycentric
+ * coordinates refer to the vertices of the face in the order of the face-vertex
+ * circulator.
+ */
+struct MeshSamples
+{
+  PointCloud<3>          points;
+  std::vector<int>       faces;
+  std::vector<glm::vec3> barycentrics;
+
+  size_t size() const;
+  void   resize(size_t n);
+};
+
+/**
+ * @brief Samples points uniformly on the surface of the mesh, i.e. the probability of
+ * each face is proportional to its area. The samples are generated in parallel, and are
+ * deterministic for a given seed.
+ *
+ * @param mesh The mesh.
+ * @param count The number of samples.
+ * @param seed Seed for the random number generator.
+ * @param offset Index of the first sample. Samples [offset, offset + count) are
+ * generated, so that a large set of samples can be generated in independent chunks.
+ * @return MeshSamples The samples.
+ */
+MeshSamples sampleSurface(const TriMesh& mesh,
+                          size_t         count,
+                          uint64_t       seed   = utils::CounterRNG::DefaultSeed,
+                          uint64_t       offset = 0);
+
+/**
+ * @brief Samples points on the surface of the mesh such that no two samples are closer
+ * than the given radius (Euclidean distance). Candidate samples are drawn uniformly on
+ * the surface and binned into a grid of cells small enough to hold at most one sample.
+ * The cells are split into 27 phase groups such that cells in the same group are too far
+ * apart to conflict, and the candidates are accepted or rejected one group at a time, in
+ * parallel within each group. The result is deterministic for a given seed.
+ *
+ * @param mesh The mesh.
+ * @param radius The minimum distance between samples.
+ * @param seed Seed for the random number generator.
+ * @return MeshSamples The samples.
+ */
+MeshSamples samplePoissonDisk(const TriMesh& mesh,
+                              float          radius,
+                              uint64_t       seed = utils::CounterRNG::DefaultSeed);
+
+}  // namespace gal
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include <Util.h>
+
 namespace gal {
 
 struct Plane
@@ -36,6 +38,41 @@ struct Plane
   const glm::vec3& xaxis() const;
   const glm::vec3& yaxis() const;
 
+  /**
+   * @brief Signed distance of the point from the plane. The distance is positive on the
+   * side the normal points to.
+   *
+   * @param pt The point.
+   * @return float Signed distance.
+   */
+  float signedDistance(const glm::vec3& pt) const;
+
+  /**
+   * @brief Projects the point onto the plane.
+   *
+   * @param pt The point.
+   * @return glm::vec3 The projected point.
+   */
+  glm::vec3 project(const glm::vec3& pt) const;
+
+  /**
+   * @brief Batch version of signedDistance. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n distances.
+   */
+  void signedDistance(const glm::vec3* pts, size_t n, float* dst) const;
+
+  /**
+   * @brief Batch version of project. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n projected points.
+   */
+  void project(const glm::vec3* pts, size_t n, glm::vec3* dst) const;
+
 private:
   glm::vec3 mOrigin;
   glm::vec3 mNormal;
@@ -72,9 +72,14 @@ struct Serial<PointCloud<NDim>> : public std::true_type
  * @param end Iterator past the last point.
  * @param nClusters Number of clusters.
  * @param idxOut Output iterator for the index of the point cloud.
+ * @param seed Seed used to generate the initial cluster centers.
  */
 template<typename TPt, typename TPtIter, typename IdxOutIter>
-void kMeansClusters(TPtIter begin, TPtIter end, size_t nClusters, IdxOutIter idxOut)
+void kMeansClusters(TPtIter    begin,
+                    TPtIter    end,
+                    size_t     nClusters,
+                    IdxOutIter idxOut,
+                    uint64_t   seed = utils::CounterRNG::DefaultSeed)
 {
   static_assert(std::is_same_v<TPt, glm::vec3> || std::is_same_v<TPt, glm::vec2>,
                 "Unsupported point type.");
@@ -85,7 +90,7 @@ void kMeansClusters(TPtIter begin, TPtIter end, size_t nClusters, IdxOutIter idx
   auto                box  = BoxType::template create<TPtIter>(begin, end);
   std::vector<TPt>    centers(nClusters);
   std::vector<size_t> counts(nClusters);
-  box.randomPoints(nClusters, centers.begin());
+  box.randomPoints(nClusters, centers.begin(), seed);
 
   std::vector<std::pair<float, size_t>> mapping(nPts, std::make_pair(FLT_MAX, SIZE_MAX));
 
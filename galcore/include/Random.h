@@ -0,0 +1,206 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Traits.h>
+
+namespace gal {
+namespace utils {
+
+/**
+ * @brief Counter based random number generator (Philox4x32-10). There is no internal
+ * state that advances with each sample. Instead, every sample is a pure function of the
+ * seed and the index of the sample. This means any range of samples can be generated
+ * independently, in any order and on any number of threads, and the results will always
+ * be identical on every platform.
+ */
+class CounterRNG
+{
+public:
+  static constexpr uint64_t DefaultSeed = 0x2545f4914f6cdd1dULL;
+  using Block                           = std::array<uint32_t, 4>;
+
+  explicit CounterRNG(uint64_t seed = DefaultSeed);
+
+  uint64_t seed() const;
+
+  /**
+   * @brief Generates the block of 4 random words with the given block index. The sample
+   * with index i is word (i % 4) of block (i / 4).
+   *
+   * @param blockIndex The index of the block.
+   * @return Block 4 random 32 bit words.
+   */
+  Block block(uint64_t blockIndex) const;
+
+  /**
+   * @brief Gets the random 32 bit word with the given index.
+   */
+  uint32_t bits(uint64_t index) const;
+
+  /**
+   * @brief Gets a uniformly distributed random float in the range [0, 1) for the given
+   * index.
+   */
+  float uniform(uint64_t index) const;
+
+  /**
+   * @brief Writes the random words with indices [offset, offset + count) to dst.
+   */
+  void fillBits(uint64_t offset, size_t count, uint32_t* dst) const;
+
+  /**
+   * @brief Writes the uniformly distributed floats in the range [0, 1) with indices
+   * [offset, offset + count) to dst. The output is identical to calling uniform(i) for
+   * each index, but the blocks are generated in batches that the compiler can vectorize,
+   * and large ranges are split across threads.
+   */
+  void fillUniform(uint64_t offset, size_t count, float* dst) const;
+
+  /**
+   * @brief Same as fillUniform, followed by mapping the values with index k to the range
+   * [min[k % stride], max[k % stride]). This is used to generate contiguous arrays of
+   * vectors, where stride is the number of coordinates per vector.
+   */
+  void fillUniform(uint64_t     offset,
+                   size_t       count,
+                   const float* min,
+                   const float* max,
+                   size_t       stride,
+                   float*       dst) const;
+
+  /**
+   * @brief Maps a 32 bit random word to a float in the range [0, 1).
+   */
+  static constexpr float toUniform(uint32_t word)
+  {
+    // Use the top 24 bits so that every value is exactly representable.
+    return float(word >> 8) * (1.f / float(1u << 24));
+  }
+
+  /**
+   * @brief Gets the random value in the given range for the given sample index. For glm
+   * vectors, the coordinate j of sample i uses the word with index (i * N + j).
+   */
+  template<typename T>
+  T sample(const T& min, const T& max, uint64_t index) const
+  {
+    if constexpr (std::is_integral_v<T>) {
+      using UT     = std::make_unsigned_t<T>;
+      uint64_t rng = uint64_t(UT(max - min));
+      return T(min + T((uint64_t(bits(index)) * rng) >> 32));
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+      return min + (max - min) * T(uniform(index));
+    }
+    else if constexpr (GlmVecTraits<T>::IsGlmVec) {
+      static constexpr int N = GlmVecTraits<T>::Size;
+      T                    v;
+      for (int j = 0; j < N; j++) {
+        v[j] = sample(min[j], max[j], index * N + uint64_t(j));
+      }
+      return v;
+    }
+    else {
+      static_assert(std::is_arithmetic_v<T> || GlmVecTraits<T>::IsGlmVec,
+                    "Cannot generate random values of given type!");
+    }
+  }
+
+private:
+  uint64_t mSeed;
+};
+
+/**
+ * @brief Discrete distribution over the indices [0, n) with the given weights. The
+ * cumulative weights are computed with a parallel prefix sum, and a guide table over the
+ * cumulative weights is built in parallel. Drawing a sample takes expected constant time,
+ * like an alias table, but unlike an alias table, every part of the construction runs in
+ * parallel.
+ */
+class DiscreteDistribution
+{
+public:
+  DiscreteDistribution() = default;
+
+  /**
+   * @brief Creates the distribution from the given non-negative weights. Throws if the
+   * weights are empty or add up to zero.
+   */
+  explicit DiscreteDistribution(std::span<const float> weights);
+
+  size_t size() const;
+  double total() const;
+
+  /**
+   * @brief Maps a number uniformly distributed in [0, 1) to an index. The probability of
+   * index i is proportional to its weight.
+   */
+  size_t sample(float u) const;
+
+private:
+  std::vector<double>   mCumulative;
+  std::vector<uint32_t> mGuide;
+};
+
+/**
+ * @brief Generates random values in the given range and writes them to dst. The values
+ * are deterministic for a given seed. The samples [offset, offset + count) are written,
+ * so that a large set of samples can be generated in independent chunks that together
+ * produce the same output as a single call. When dst is a contiguous iterator of floats
+ * or float vectors, the values are generated directly into the destination memory, in
+ * parallel.
+ *
+ * @tparam T The type of values. Must be integral, floating point or a glm vector.
+ * @tparam DstIter Output iterator.
+ * @param min Min value.
+ * @param max Max value (exclusive).
+ * @param count Number of values to generate.
+ * @param dst Destination.
+ * @param seed Seed for the generator.
+ * @param offset Index of the first sample.
+ */
+template<typename T, typename DstIter>
+void random(T        min,
+            T        max,
+            size_t   count,
+            DstIter  dst,
+            uint64_t seed   = CounterRNG::DefaultSeed,
+            uint64_t offset = 0)
+{
+  CounterRNG rng(seed);
+  if constexpr (std::contiguous_iterator<DstIter>) {
+    using ValueT = std::iter_value_t<DstIter>;
+    if constexpr (std::is_same_v<ValueT, T> && std::is_same_v<T, float>) {
+      rng.fillUniform(offset, count, &min, &max, 1, std::to_address(dst));
+      return;
+    }
+    else if constexpr (std::is_same_v<ValueT, T> && GlmVecTraits<T>::IsGlmVec) {
+      if constexpr (std::is_same_v<typename GlmVecTraits<T>::ValueType, float>) {
+        static constexpr size_t N = size_t(GlmVecTraits<T>::Size);
+        static_assert(sizeof(T) == N * sizeof(float));
+        rng.fillUniform(offset * N,
+                        count * N,
+                        &min[0],
+                        &max[0],
+                        N,
+                        reinterpret_cast<float*>(std::to_address(dst)));
+        return;
+      }
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    *(dst++) = rng.sample(min, max, offset + i);
+  }
+};
+
+}  // namespace utils
+}  // namespace gal
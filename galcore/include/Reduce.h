@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <type_traits>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include <Util.h>
+
+namespace gal {
+namespace utils {
+
+/**
+ * @brief Sum of fn(v) for the n values v starting at the given pointer, using pairwise
+ * summation. The rounding error grows with the logarithm of the number of values,
+ * instead of linearly like a running sum.
+ */
+template<typename TOut, typename TIn, typename TFn>
+TOut pairwiseSum(const TIn* values, size_t n, const TFn& fn)
+{
+  static constexpr size_t BaseSize = 16;
+  if (n <= BaseSize) {
+    TOut sum = TOut(0);
+    for (size_t i = 0; i < n; i++) {
+      sum += fn(values[i]);
+    }
+    return sum;
+  }
+  size_t half = n / 2;
+  return pairwiseSum<TOut>(values, half, fn) +
+         pairwiseSum<TOut>(values + half, n - half, fn);
+}
+
+/**
+ * @brief Sum of fn(v) for all the values v, using pairwise summation. Large inputs are
+ * summed in parallel. The input is always split into the same blocks, regardless of the
+ * number of threads, so the result is deterministic.
+ *
+ * @tparam TOut The type of the sum.
+ * @param values The values to sum.
+ * @param fn Maps each value to the term added to the sum.
+ */
+template<typename TOut, typename TIn, typename TFn>
+TOut transformSum(std::span<const TIn> values, const TFn& fn)
+{
+  if (values.size() < ParallelThreshold) {
+    return pairwiseSum<TOut>(values.data(), values.size(), fn);
+  }
+  return tbb::parallel_deterministic_reduce(
+    tbb::blocked_range<size_t>(0, values.size(), ParallelThreshold),
+    TOut(0),
+    [&](const tbb::blocked_range<size_t>& r, TOut sum) {
+      return sum + pairwiseSum<TOut>(values.data() + r.begin(), r.size(), fn);
+    },
+    std::plus<TOut>());
+}
+
+template<typename T>
+T sum(std::span<const T> values)
+{
+  return transformSum<T>(values, [](const T& v) { return v; });
+}
+
+/**
+ * @brief Arithmetic mean of the values. The mean of integers is a float.
+ */
+template<typename T, typename TOut = std::conditional_t<std::is_integral_v<T>, float, T>>
+TOut mean(std::span<const T> values)
+{
+  return transformSum<TOut>(values, [](const T& v) { return TOut(v); }) /
+         float(values.size());
+}
+
+/**
+ * @brief Population variance of the values, i.e. the mean of the squared deviations
+ * from the mean. The deviations are summed in a second pass over the values, which is
+ * more accurate than subtracting the square of the mean from the mean of the squares.
+ */
+template<typename T>
+float variance(std::span<const T> values)
+{
+  float mu = mean<T, float>(values);
+  return transformSum<float>(values,
+                             [mu](const T& v) {
+                               float d = float(v) - mu;
+                               return d * d;
+                             }) /
+         float(values.size());
+}
+
+/**
+ * @brief Index of the smallest value. If there are several, the first one is returned.
+ * The values must not be empty.
+ */
+template<typename T, typename TLess = std::less<T>>
+size_t argmin(std::span<const T> values, TLess less = {})
+{
+  // Picks the smaller value, or the smaller index when the values are equal.
+  auto pick = [&](size_t a, size_t b) {
+    if (a == SIZE_MAX || b == SIZE_MAX) {
+      return std::min(a, b);
+    }
+    return less(values[b], values[a]) || (!less(values[a], values[b]) && b < a) ? b : a;
+  };
+  auto scan = [&](size_t begin, size_t end, size_t best) {
+    for (size_t i = begin; i < end; i++) {
+      best = pick(best, i);
+    }
+    return best;
+  };
+  if (values.size() < ParallelThreshold) {
+    return scan(0, values.size(), SIZE_MAX);
+  }
+  return tbb::parallel_reduce(
+    tbb::blocked_range<size_t>(0, values.size(), ParallelThreshold),
+    SIZE_MAX,
+    [&](const tbb::blocked_range<size_t>& r, size_t best) {
+      return scan(r.begin(), r.end(), best);
+    },
+    pick);
+}
+
+/**
+ * @brief Index of the largest value. If there are several, the first one is returned.
+ * The values must not be empty.
+ */
+template<typename T, typename TLess = std::less<T>>
+size_t argmax(std::span<const T> values, TLess less = {})
+{
+  return argmin(values, [&](const T& a, const T& b) { return less(b, a); });
+}
+
+}  // namespace utils
+}  // namespace gal
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include <Util.h>
+
+namespace gal {
+namespace utils {
+
+/**
+ * @brief Prefix scan in two parallel passes. The first pass combines the values of each
+ * block, and the second pass scans each block starting from the combined values of the
+ * blocks before it. The blocks don't depend on the number of threads, so the result is
+ * deterministic even if op is not associative, as with floats.
+ */
+template<typename T, typename TDst, typename TOp>
+void blockScan(std::span<const T> src, TDst& dst, T init, TOp op, bool inclusive)
+{
+  auto scan = [&](size_t begin, size_t end, T sum) {
+    for (size_t i = begin; i < end; i++) {
+      // The source is read before writing, so the scan can be done in place.
+      T value = src[i];
+      dst[i]  = inclusive ? (sum = op(sum, value)) : std::exchange(sum, op(sum, value));
+    }
+  };
+  size_t n = src.size();
+  if (n <= ParallelThreshold) {
+    scan(0, n, init);
+    return;
+  }
+  std::vector<T> offsets(numBlocks(n) + 1, init);
+  forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+    T total = src[begin];
+    for (size_t i = begin + 1; i < end; i++) {
+      total = op(total, src[i]);
+    }
+    offsets[block + 1] = total;
+  });
+  for (size_t b = 1; b < offsets.size(); b++) {
+    offsets[b] = op(offsets[b - 1], offsets[b]);
+  }
+  forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+    scan(begin, end, offsets[block]);
+  });
+}
+
+/**
+ * @brief Writes init op src[0] op ... op src[i] to dst[i] for every i.
+ *
+ * @param src The values to scan.
+ * @param dst Random access destination, as long as the source. Can be the source.
+ * @param init Combined with the first value, i.e. zero for sums.
+ * @param op Associative binary operation.
+ */
+template<typename T, typename TDst, typename TOp = std::plus<T>>
+void inclusiveScan(std::span<const T> src, TDst&& dst, T init = T(0), TOp op = {})
+{
+  blockScan(src, dst, init, op, true);
+}
+
+/**
+ * @brief Writes init op src[0] op ... op src[i - 1] to dst[i] for every i, i.e. dst[0] is
+ * init, and the last value is not included.
+ *
+ * @param src The values to scan.
+ * @param dst Random access destination, as long as the source. Can be the source.
+ * @param init The first value of the scan, i.e. zero for sums.
+ * @param op Associative binary operation.
+ */
+template<typename T, typename TDst, typename TOp = std::plus<T>>
+void exclusiveScan(std::span<const T> src, TDst&& dst, T init = T(0), TOp op = {})
+{
+  blockScan(src, dst, init, op, false);
+}
+
+/**
+ * @brief Stable partition of the indices in [0, n) by a predicate. The predicate is
+ * evaluated once for each index, in parallel, and the number of selected indices in each
+ * block is prefix summed to find where the block writes its indices.
+ *
+ * @param n The number of indices.
+ * @param pred Returns true for the indices to be selected.
+ * @param dst Destination for the selected indices in increasing order, followed by the
+ * rejected indices in increasing order if KeepRejected is true.
+ * @return size_t The number of selected indices.
+ */
+template<bool KeepRejected, typename TPred>
+size_t partitionIndices(size_t n, const TPred& pred, std::vector<size_t>& dst)
+{
+  std::vector<uint8_t> flags(n);
+  std::vector<size_t>  offsets(numBlocks(n) + 1, 0);
+  forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+      flags[i] = pred(i) ? 1 : 0;
+      count += flags[i];
+    }
+    offsets[block + 1] = count;
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  size_t nSelected = offsets.back();
+  dst.resize(KeepRejected ? n : nSelected);
+  forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+    size_t selected = offsets[block];
+    size_t rejected = nSelected + begin - offsets[block];
+    for (size_t i = begin; i < end; i++) {
+      if (flags[i]) {
+        dst[selected++] = i;
+      }
+      else if constexpr (KeepRejected) {
+        dst[rejected++] = i;
+      }
+    }
+  });
+  return nSelected;
+}
+
+/**
+ * @brief Gets the indices in [0, n) for which the predicate is true, in increasing
+ * order.
+ */
+template<typename TPred>
+std::vector<size_t> selectIndices(size_t n, const TPred& pred)
+{
+  std::vector<size_t> indices;
+  partitionIndices<false>(n, pred, indices);
+  return indices;
+}
+
+/**
+ * @brief Copies src[indices[i]] to dst[i] for every i, in parallel for large inputs.
+ * Both the source and the destination must be random access.
+ */
+template<typename TSrc, typename TDst>
+void gather(const TSrc& src, std::span<const size_t> indices, TDst&& dst)
+{
+  forEachBlock(indices.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      dst[i] = src[indices[i]];
+    }
+  });
+}
+
+/**
+ * @brief Copies src[i] to dst[indices[i]] for every i, in parallel for large inputs. When
+ * an index is repeated, the last of its values is copied, so the result doesn't depend
+ * on the order in which the values are copied.
+ *
+ * @param src The values to copy. Must be random access.
+ * @param indices The destination index of each value. Must be smaller than dstSize.
+ * @param dst The destination. Must be random access.
+ * @param dstSize The size of the destination.
+ */
+template<typename TSrc, typename TDst>
+void scatter(const TSrc& src, std::span<const size_t> indices, TDst&& dst, size_t dstSize)
+{
+  size_t n = indices.size();
+  if (n <= ParallelThreshold) {
+    for (size_t i = 0; i < n; i++) {
+      dst[indices[i]] = src[i];
+    }
+    return;
+  }
+  // One plus the position of the last value copied to each index.
+  std::vector<std::atomic<size_t>> last(dstSize);
+  forEachBlock(n, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      auto&  slot    = last[indices[i]];
+      size_t current = slot.load(std::memory_order_relaxed);
+      while (current < i + 1 &&
+             !slot.compare_exchange_weak(current, i + 1, std::memory_order_relaxed)) {
+      }
+    }
+  });
+  forEachBlock(n, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (last[indices[i]].load(std::memory_order_relaxed) == i + 1) {
+        dst[indices[i]] = src[i];
+      }
+    }
+  });
+}
+
+}  // namespace utils
+}  // namespace gal
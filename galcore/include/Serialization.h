@@ -20,6 +20,14 @@ struct Serial : std::false_type
   static Bytes serialize(const T& data);
 };
 
+/**
+ * @brief Checks at compile time if a type can be written to and read from bytes.
+ */
+template<typename T>
+struct IsSerializable : public std::disjunction<IsValueType<T>, Serial<T>>
+{
+};
+
 class Bytes
 {
 public:
@@ -37,6 +45,10 @@ public:
 
   void saveToFile(const fs::path& path) const;
 
+  const char* data() const noexcept;
+
+  size_t size() const noexcept;
+
   template<typename T>
   Bytes& write(const T& data)
   {
@@ -170,7 +182,7 @@ struct Serial<std::string> : public std::true_type
 };
 
 template<int N, typename T, glm::qualifier Q>
-struct Serial<glm::vec<N, T, Q>>
+struct Serial<glm::vec<N, T, Q>> : public std::true_type
 {
   static glm::vec<N, T, Q> deserialize(Bytes& bytes)
   {
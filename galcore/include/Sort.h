@@ -0,0 +1,175 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <Scan.h>
+#include <Util.h>
+
+namespace gal {
+namespace utils {
+
+/**
+ * @brief Writes the indices of the keys to dst in the sorted order of the keys, using a
+ * parallel LSD radix sort. Keys that compare equal keep their relative order. Negative
+ * and positive zeros are equal. NaNs are moved to the start or the end, depending on
+ * their sign.
+ *
+ * @param keys The keys to sort.
+ * @param dst Destination for the sorted indices. Must be as long as the keys.
+ */
+void radixArgsort(std::span<const float> keys, std::span<size_t> dst);
+void radixArgsort(std::span<const int32_t> keys, std::span<size_t> dst);
+
+/**
+ * @brief Parallel sample sort of the indices of the keys. The samples of the keys are
+ * sorted to pick the splitters, the indices are scattered into the buckets between the
+ * splitters, and the buckets are sorted in parallel. Ties between equal keys are broken
+ * by the index, so the sort is stable, and buckets stay balanced when there are many
+ * equal keys.
+ */
+template<typename T, typename TLess>
+void sampleArgsort(std::span<const T> keys, std::span<size_t> dst, TLess less)
+{
+  auto cmp = [&](size_t a, size_t b) {
+    return less(keys[a], keys[b]) || (!less(keys[b], keys[a]) && a < b);
+  };
+  size_t n = keys.size();
+  std::iota(dst.begin(), dst.end(), size_t(0));
+  if (n < 2 * ParallelThreshold) {
+    std::sort(dst.begin(), dst.end(), cmp);
+    return;
+  }
+  static constexpr size_t Oversampling = 32;
+  size_t nBuckets = std::clamp(size_t(tbb::this_task_arena::max_concurrency()) * 4,
+                               size_t(2),
+                               n / ParallelThreshold);
+  std::vector<size_t> samples(nBuckets * Oversampling);
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = (i * n) / samples.size() + (i * 7919) % (n / samples.size());
+  }
+  std::sort(samples.begin(), samples.end(), cmp);
+  std::vector<size_t> splitters(nBuckets - 1);
+  for (size_t b = 0; b + 1 < nBuckets; b++) {
+    splitters[b] = samples[(b + 1) * Oversampling];
+  }
+  // Count the indices of each block that fall in each bucket.
+  size_t                nBlocks = numBlocks(n);
+  std::vector<uint32_t> buckets(n);
+  std::vector<size_t>   offsets(nBlocks * nBuckets, 0);
+  forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+    size_t* counts = offsets.data() + block * nBuckets;
+    for (size_t i = begin; i < end; i++) {
+      buckets[i] = uint32_t(
+        std::upper_bound(splitters.begin(), splitters.end(), i, cmp) - splitters.begin());
+      counts[buckets[i]]++;
+    }
+  });
+  // Each block writes its indices of a bucket after those of the blocks before it.
+  std::vector<size_t> starts(nBuckets + 1, 0);
+  size_t              sum = 0;
+  for (size_t b = 0; b < nBuckets; b++) {
+    starts[b] = sum;
+    for (size_t block = 0; block < nBlocks; block++) {
+      sum += std::exchange(offsets[block * nBuckets + b], sum);
+    }
+  }
+  starts[nBuckets] = n;
+  forEachBlock(n, [&](size_t block, size_t begin, size_t end) {
+    size_t* pos = offsets.data() + block * nBuckets;
+    for (size_t i = begin; i < end; i++) {
+      dst[pos[buckets[i]]++] = i;
+    }
+  });
+  tbb::parallel_for(size_t(0), nBuckets, [&](size_t b) {
+    std::sort(dst.begin() + starts[b], dst.begin() + starts[b + 1], cmp);
+  });
+}
+
+/**
+ * @brief Writes the indices of the keys to dst in the sorted order of the keys, i.e.
+ * keys[dst[0]] is the smallest key. The sort is stable, and runs in parallel for large
+ * inputs. 32 bit integer and float keys are radix sorted when compared with the default
+ * comparison, and other keys are sorted with a sample sort.
+ *
+ * @param keys The keys to sort.
+ * @param dst Destination for the sorted indices. Must be as long as the keys.
+ * @param less Comparison of the keys.
+ */
+template<typename T, typename TLess = std::less<T>>
+void argsort(std::span<const T> keys, std::span<size_t> dst, TLess less = {})
+{
+  if constexpr ((std::is_same_v<T, float> || std::is_same_v<T, int32_t>) &&
+                std::is_same_v<TLess, std::less<T>>) {
+    radixArgsort(keys, dst);
+  }
+  else {
+    sampleArgsort(keys, dst, less);
+  }
+}
+
+/**
+ * @brief Writes the indices of the smallest dst.size() keys to dst, in the sorted order
+ * of the keys. Like argsort, equal keys keep their relative order. For large inputs, the
+ * smallest keys of each block are selected in parallel, and only the selected keys are
+ * sorted.
+ *
+ * @param keys The keys to sort.
+ * @param dst Destination for the sorted indices. Must not be longer than the keys.
+ * @param less Comparison of the keys.
+ */
+template<typename T, typename TLess = std::less<T>>
+void partialArgsort(std::span<const T> keys, std::span<size_t> dst, TLess less = {})
+{
+  size_t n = keys.size();
+  size_t k = dst.size();
+  if (k == 0) {
+    return;
+  }
+  if (4 * k > n) {
+    std::vector<size_t> all(n);
+    argsort(keys, std::span<size_t>(all), less);
+    std::copy_n(all.begin(), k, dst.begin());
+    return;
+  }
+  auto cmp = [&](size_t a, size_t b) {
+    return less(keys[a], keys[b]) || (!less(keys[b], keys[a]) && a < b);
+  };
+  size_t nBlocks = std::max(size_t(1), n / std::max(ParallelThreshold, 4 * k));
+  // The smallest keys of each block, the k smallest keys overall are among these.
+  std::vector<std::vector<size_t>> selected(nBlocks);
+  auto                             select = [&](size_t block) {
+    std::vector<size_t>& indices = selected[block];
+    indices.resize((block + 1) * n / nBlocks - block * n / nBlocks);
+    std::iota(indices.begin(), indices.end(), block * n / nBlocks);
+    if (indices.size() > k) {
+      std::nth_element(indices.begin(), indices.begin() + k, indices.end(), cmp);
+      indices.resize(k);
+    }
+  };
+  if (nBlocks > 1) {
+    tbb::parallel_for(size_t(0), nBlocks, select);
+  }
+  else {
+    select(0);
+  }
+  std::vector<size_t> candidates;
+  candidates.reserve(nBlocks * k);
+  for (const auto& indices : selected) {
+    candidates.insert(candidates.end(), indices.begin(), indices.end());
+  }
+  std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(), cmp);
+  std::copy_n(candidates.begin(), k, dst.begin());
+}
+
+}  // namespace utils
+}  // namespace gal
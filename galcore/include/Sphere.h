@@ -17,6 +17,64 @@ struct Sphere
 
   bool contains(const glm::vec3& pt, float tolerance = 0.f) const;
 
+  /**
+   * @brief Signed distance of the point from the surface of the sphere. The distance is
+   * negative for points inside the sphere.
+   *
+   * @param pt The point.
+   * @return float Signed distance.
+   */
+  float signedDistance(const glm::vec3& pt) const;
+
+  /**
+   * @brief Gets the point on the surface of the sphere closest to the given point.
+   *
+   * @param pt The point.
+   * @return glm::vec3 Closest point.
+   */
+  glm::vec3 closestPoint(const glm::vec3& pt) const;
+
+  /**
+   * @brief Batch version of contains. Tests each of the n points and writes the results
+   * to dst. Large batches are processed in parallel.
+   *
+   * @tparam BoolT Type of the result. Must be constructible from bool.
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the results. Must have space for n results.
+   * @param tolerance Tolerance for points on the surface.
+   */
+  template<typename BoolT>
+  void contains(const glm::vec3* pts, size_t n, BoolT* dst, float tolerance = 0.f) const
+  {
+    // Compare squared distances to avoid the square root per point.
+    const float r  = radius + tolerance;
+    const float r2 = r < 0.f ? -1.f : r * r;
+    utils::parallelFor(n, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        dst[i] = BoolT(glm::distance2(center, pts[i]) <= r2);
+      }
+    });
+  }
+
+  /**
+   * @brief Batch version of signedDistance. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n distances.
+   */
+  void signedDistance(const glm::vec3* pts, size_t n, float* dst) const;
+
+  /**
+   * @brief Batch version of closestPoint. Large batches are processed in parallel.
+   *
+   * @param pts Pointer to the points.
+   * @param n Number of points.
+   * @param dst Output for the n closest points.
+   */
+  void closestPoints(const glm::vec3* pts, size_t n, glm::vec3* dst) const;
+
   static Sphere createCircumsphere(const glm::vec3& a,
                                    const glm::vec3& b,
                                    const glm::vec3& c,
@@ -74,6 +74,43 @@ public:
   static const bool value = decltype(Check<std::ostream, T>(0))::value;
 };
 
+/**
+ * @brief Checks if the type can be compared with the == operator.
+ *
+ * @tparam T The type to be checked.
+ */
+template<typename T>
+class IsEqualityComparable
+{
+  template<typename TT>
+  static auto Check(int)
+    -> decltype(std::declval<const TT&>() == std::declval<const TT&>(), std::true_type());
+
+  template<typename>
+  static auto Check(...) -> std::false_type;
+
+public:
+  static const bool value = decltype(Check<T>(0))::value;
+};
+
+/**
+ * @brief Checks if the type has a clear() member function.
+ *
+ * @tparam T The type to be checked.
+ */
+template<typename T>
+class HasClear
+{
+  template<typename TT>
+  static auto Check(int) -> decltype(std::declval<TT&>().clear(), std::true_type());
+
+  template<typename>
+  static auto Check(...) -> std::false_type;
+
+public:
+  static const bool value = decltype(Check<T>(0))::value;
+};
+
 /** You can't have polymorphic instances on the stack. Its inefficient to have
  * non-polymorphic instances on the heap. This helper template can decide where to put
  * what.
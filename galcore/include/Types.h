@@ -10,6 +10,7 @@
 #include <PointCloud.h>
 #include <Sphere.h>
 #include <Traits.h>
+#include <VoxelGrid.h>
 
 namespace gal {
 
@@ -76,3 +77,4 @@ GAL_TYPE_INFO(gal::PolyMesh, polymesh, 0x12892286);
 GAL_TYPE_INFO(gal::TextAnnotations, tags, 0x901da902);
 GAL_TYPE_INFO(gal::Glyph, glyphIcon, 0x71b91b77);
 GAL_TYPE_INFO(gal::GlyphAnnotations, glyph, 0x15301102);
+GAL_TYPE_INFO(gal::VoxelGrid, voxelgrid, 0x7c1e94d3);
@@ -3,6 +3,8 @@
 #include <float.h>
 #include <spdlog/spdlog.h>
 #include <stdint.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <algorithm>
 #include <cstdlib>
 #include <filesystem>
@@ -16,6 +18,7 @@
 #include <type_traits>
 #include <vector>
 
+#include <Random.h>
 #include <Traits.h>
 
 #ifdef _MSC_VER
@@ -120,31 +123,68 @@ void copy_coords(const glm::tvec3<T>& v, T*& dst)
 
 fs::path absPath(const fs::path& relPath);
 
-template<typename T, typename DstIter>
-void random(T min, T max, size_t count, DstIter dst)
+/**
+ * @brief Batch operations with fewer elements than this are run serially on the calling
+ * thread, because the overhead of scheduling tasks outweighs the gains.
+ */
+static constexpr size_t ParallelThreshold = size_t(1) << 14;
+
+/**
+ * @brief Runs the given callable over the index range [0, n) in contiguous chunks. The
+ * chunks are processed in parallel if n is at least ParallelThreshold. The callable is
+ * invoked with the begin and end of each chunk, so that the loop over a chunk is a tight
+ * loop the compiler can vectorize.
+ *
+ * @tparam TCallable Callable with the signature void(size_t begin, size_t end).
+ * @param n The size of the range.
+ * @param fn The callable.
+ */
+template<typename TCallable>
+void parallelFor(size_t n, const TCallable& fn)
 {
-  static constexpr std::string_view sErrorMsg =
-    "Cannot generate random values of given type!\n";
-  for (size_t i = 0; i < count; i++) {
-    if constexpr (std::is_integral_v<T>) {
-      *(dst++) = min + (static_cast<T>(std::rand()) % (max - min));
-    }
-    else if constexpr (std::is_floating_point_v<T>) {
-      static constexpr T TMax = static_cast<T>(RAND_MAX);
-      *(dst++)                = min + (max - min) * (static_cast<T>(std::rand()) / TMax);
-    }
-    else if constexpr (GlmVecTraits<T>::IsGlmVec) {
-      T v;
-      for (int j = 0; j < GlmVecTraits<T>::Size; j++) {
-        random(min[j], max[j], 1, &v[j]);
-      }
-      *(dst++) = v;
-    }
-    else {
-      std::cerr << sErrorMsg;
-    }
+  if (n < ParallelThreshold) {
+    fn(size_t(0), n);
+    return;
   }
-};
+  tbb::parallel_for(
+    tbb::blocked_range<size_t>(0, n, ParallelThreshold / 4),
+    [&fn](const tbb::blocked_range<size_t>& r) { fn(r.begin(), r.end()); });
+}
+
+/**
+ * @brief Number of blocks of ParallelThreshold consecutive indices in the range [0, n).
+ */
+inline size_t numBlocks(size_t n)
+{
+  return (n + ParallelThreshold - 1) / ParallelThreshold;
+}
+
+/**
+ * @brief Calls fn(block, begin, end) for each block of ParallelThreshold consecutive
+ * indices in [0, n). The blocks are processed in parallel when there are more than one.
+ * Unlike parallelFor, the blocks don't depend on the scheduling, so algorithms that
+ * combine the results of the blocks, like scans, are deterministic.
+ *
+ * @tparam TCallable Callable with the signature void(size_t block, size_t begin, size_t
+ * end).
+ * @param n The size of the range.
+ * @param fn The callable.
+ */
+template<typename TCallable>
+void forEachBlock(size_t n, const TCallable& fn)
+{
+  size_t nBlocks = numBlocks(n);
+  auto   run     = [&](size_t block) {
+    size_t begin = block * ParallelThreshold;
+    fn(block, begin, std::min(n, begin + ParallelThreshold));
+  };
+  if (nBlocks > 1) {
+    tbb::parallel_for(size_t(0), nBlocks, run);
+  }
+  else if (nBlocks == 1) {
+    run(0);
+  }
+}
 
 /**
  * @brief Scans the bits of the integer and returns the position of the first set bit. By
@@ -201,6 +241,67 @@ void combinations(size_t k, TIter begin, TIter end, TOutIter dst, const TCallabl
   }
 }
 
+/**
+ * @brief Writes the k indices of the combination with the given rank to dst. The
+ * combinations of k indices from [0, n) are ranked in the same lexicographic order in
+ * which they are generated by utils::combinations. This can be used to start enumerating
+ * the combinations from any rank, for example to split the enumeration across threads.
+ *
+ * @param rank The rank of the combination. Must be less than numCombinations(n, k).
+ * @param n The size of the set.
+ * @param k The size of a single combination.
+ * @param dst Output for the k indices, in increasing order.
+ */
+void combinationAt(size_t rank, size_t n, size_t k, size_t* dst);
+
+/**
+ * @brief Returns the combination with the given rank. See the overload writing to a
+ * destination for details.
+ */
+std::vector<size_t> combinationAt(size_t rank, size_t n, size_t k);
+
+/**
+ * @brief Replaces the given combination of k indices from [0, n) with the next one in
+ * lexicographic order.
+ *
+ * @param n The size of the set.
+ * @param k The size of a single combination.
+ * @param comb The k indices of the combination, in increasing order.
+ * @return true If the combination was advanced.
+ * @return false If the given combination was the last one. It is left unchanged.
+ */
+bool nextCombination(size_t n, size_t k, size_t* comb);
+
+/**
+ * @brief Enumerates all combinations of k indices from [0, n) in parallel. Each worker
+ * unranks the first combination of its range of ranks and walks the rest with
+ * nextCombination. The callback is invoked with the rank and the k indices of every
+ * combination, and must be safe to call concurrently. The rank can be used to write the
+ * combination into a preallocated output slot.
+ *
+ * @tparam TCallable Callable with the signature void(size_t rank, const size_t* comb).
+ * @param n The size of the set.
+ * @param k The size of a single combination.
+ * @param fn The callback.
+ */
+template<typename TCallable>
+void parallelCombinations(size_t n, size_t k, const TCallable& fn)
+{
+  size_t total = numCombinations(n, k);
+  if (k == 0 || total == 0) {
+    return;
+  }
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, total, 1024),
+                    [&](const tbb::blocked_range<size_t>& range) {
+                      std::vector<size_t> comb(k);
+                      combinationAt(range.begin(), n, k, comb.data());
+                      for (size_t r = range.begin(); r < range.end(); r++) {
+                        fn(r, (const size_t*)comb.data());
+                        nextCombination(n, k, comb.data());
+                      }
+                    });
+}
+
 /**
  * @brief Check the sign of the value.
  *
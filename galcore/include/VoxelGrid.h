@@ -0,0 +1,165 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Box.h>
+#include <Mesh.h>
+#include <Serialization.h>
+
+namespace gal {
+
+/**
+ * @brief Regular grid of signed distances sampled at the nodes of the grid. The nodes are
+ * grouped into cubic blocks of BlockSize^3 nodes. In a dense grid, every block is
+ * allocated and holds the signed distance everywhere in the grid. In a sparse grid, only
+ * the blocks within the narrow band around the surface are allocated, and the remaining
+ * blocks only store whether they are inside or outside. The distances are negative
+ * inside.
+ */
+class VoxelGrid
+{
+  friend struct Serial<VoxelGrid>;
+
+public:
+  static constexpr int      BlockSize   = 8;
+  static constexpr int      BlockVolume = BlockSize * BlockSize * BlockSize;
+  static constexpr uint32_t NoBlock     = UINT32_MAX;
+  static constexpr int8_t   SignInside  = -1;
+  static constexpr int8_t   SignOutside = 1;
+
+  using Triangle = std::array<glm::vec3, 3>;
+
+  VoxelGrid() = default;
+
+  /**
+   * @brief Creates a grid covering the given bounds. All the blocks are unallocated and
+   * outside.
+   *
+   * @param bounds The region covered by the grid.
+   * @param cellSize The distance between neighboring nodes.
+   * @param bandWidth The width of the narrow band around the surface.
+   */
+  VoxelGrid(const Box3& bounds, float cellSize, float bandWidth);
+
+  /**
+   * @brief Computes the signed distance field of the mesh. The distances within the
+   * narrow band are computed by rasterizing the triangles, in parallel over the blocks of
+   * the grid. The sign is computed by casting rays along the rows of the grid and
+   * counting the crossings with the mesh, using the face rtree of the mesh. If the grid
+   * is dense, the distances beyond the band are computed with a parallel fast sweep.
+   *
+   * @param mesh The mesh. Must be closed for the signs to be meaningful.
+   * @param cellSize The distance between neighboring nodes.
+   * @param bandWidth The width of the narrow band around the surface.
+   * @param sparse Whether to only allocate the blocks inside the narrow band.
+   * @return VoxelGrid The signed distance field.
+   */
+  static VoxelGrid fromMesh(const TriMesh& mesh,
+                            float          cellSize,
+                            float          bandWidth,
+                            bool           sparse);
+
+  const glm::vec3&  origin() const;
+  float             cellSize() const;
+  float             bandWidth() const;
+  const glm::ivec3& dims() const;
+  Box3              bounds() const;
+  size_t            numNodes() const;
+  size_t            numBlocks() const;
+  size_t            numAllocatedBlocks() const;
+  bool              isDense() const;
+
+  /**
+   * @brief Gets the position of the node with the given index.
+   */
+  glm::vec3 nodePosition(const glm::ivec3& node) const;
+
+  /**
+   * @brief Gets the signed distance stored at the node with the given index. Nodes in
+   * unallocated blocks report the band width with the sign of the block.
+   */
+  float value(const glm::ivec3& node) const;
+
+  /**
+   * @brief Samples the signed distance at the given point with trilinear interpolation.
+   * Points outside the grid are clamped to the boundary of the grid.
+   */
+  float sample(const glm::vec3& pt) const;
+
+  /**
+   * @brief Batch version of sample. Large batches are processed in parallel.
+   */
+  void sample(const glm::vec3* pts, size_t n, float* dst) const;
+
+  /**
+   * @brief Occupancy test. Checks if the point is inside the surface.
+   */
+  bool contains(const glm::vec3& pt) const;
+
+private:
+  glm::vec3             mOrigin    = {0.f, 0.f, 0.f};
+  float                 mCellSize  = 1.f;
+  float                 mBandWidth = 0.f;
+  glm::ivec3            mDims      = {0, 0, 0};
+  glm::ivec3            mBlockDims = {0, 0, 0};
+  std::vector<uint32_t> mBlockIndices;
+  std::vector<int8_t>   mBlockSigns;
+  std::vector<float>    mValues;
+
+  size_t     blockOf(const glm::ivec3& node) const;
+  size_t     localIndex(const glm::ivec3& node) const;
+  float*     blockData(size_t block);
+  glm::ivec3 blockFirstNode(size_t block) const;
+  Box3       blockBounds(size_t block) const;
+  void       computeBandDistances(const TriMesh&               mesh,
+                                  const std::vector<Triangle>& tris,
+                                  bool                         sparse);
+  void       computeSigns(const TriMesh& mesh, const std::vector<Triangle>& tris);
+  void       sweep();
+};
+
+template<>
+struct Serial<VoxelGrid> : public std::true_type
+{
+  static VoxelGrid deserialize(Bytes& bytes)
+  {
+    VoxelGrid grid;
+    uint64_t  nBlocks = 0;
+    uint64_t  nValues = 0;
+    bytes >> grid.mOrigin >> grid.mCellSize >> grid.mBandWidth;
+    for (int i = 0; i < 3; i++) {
+      bytes >> grid.mDims[i] >> grid.mBlockDims[i];
+    }
+    bytes >> nBlocks >> nValues;
+    grid.mBlockIndices.resize(nBlocks);
+    grid.mBlockSigns.resize(nBlocks);
+    grid.mValues.resize(nValues);
+    bytes.readBytes(nBlocks * sizeof(uint32_t), (char*)grid.mBlockIndices.data());
+    bytes.readBytes(nBlocks * sizeof(int8_t), (char*)grid.mBlockSigns.data());
+    bytes.readBytes(nValues * sizeof(float), (char*)grid.mValues.data());
+    return grid;
+  }
+
+  static Bytes serialize(const VoxelGrid& grid)
+  {
+    Bytes bytes;
+    bytes << grid.mOrigin << grid.mCellSize << grid.mBandWidth;
+    for (int i = 0; i < 3; i++) {
+      bytes << grid.mDims[i] << grid.mBlockDims[i];
+    }
+    bytes << uint64_t(grid.mBlockIndices.size()) << uint64_t(grid.mValues.size());
+    bytes.writeBytes((const char*)grid.mBlockIndices.data(),
+                     grid.mBlockIndices.size() * sizeof(uint32_t));
+    bytes.writeBytes((const char*)grid.mBlockSigns.data(),
+                     grid.mBlockSigns.size() * sizeof(int8_t));
+    bytes.writeBytes((const char*)grid.mValues.data(),
+                     grid.mValues.size() * sizeof(float));
+    return bytes;
+  }
+};
+
+}  // namespace gal
@@ -83,6 +83,43 @@ GAL_FUNC(perimeter,
   result = circ.perimeter();
 }
 
+GAL_FUNC(circleContains,
+         "Checks which of the given 2d points are inside the circle",
+         ((gal::Circle2d, circ, "The circle"),
+          ((data::ReadView<glm::vec2, 1>), points, "Points to test")),
+         (((data::WriteView<gal::Bool, 1>), results, "Whether each point is inside")))
+{
+  results.resize(points.size());
+  if (!points.empty()) {
+    circ.contains(points.data(), points.size(), &results[0]);
+  }
+}
+
+GAL_FUNC(circleSignedDistance,
+         "Signed distances of the 2d points from the circle. The distances are negative "
+         "inside the circle",
+         ((gal::Circle2d, circ, "The circle"),
+          ((data::ReadView<glm::vec2, 1>), points, "Points")),
+         (((data::WriteView<float, 1>), distances, "Signed distances")))
+{
+  distances.resize(points.size());
+  if (!points.empty()) {
+    circ.signedDistance(points.data(), points.size(), &distances[0]);
+  }
+}
+
+GAL_FUNC(circleClosestPoints,
+         "Closest points on the circle, to the given 2d points",
+         ((gal::Circle2d, circ, "The circle"),
+          ((data::ReadView<glm::vec2, 1>), points, "Points")),
+         (((data::WriteView<glm::vec2, 1>), closest, "Closest points")))
+{
+  closest.resize(points.size());
+  if (!points.empty()) {
+    circ.closestPoints(points.data(), points.size(), &closest[0]);
+  }
+}
+
 void bind_CircleFunc(py::module& module)
 {
   GAL_FN_BIND(bounds, module);
@@ -91,6 +128,9 @@ void bind_CircleFunc(py::module& module)
   GAL_FN_BIND(circle2d, module);
   GAL_FN_BIND(circle2dFromDiameter, module);
   GAL_FN_BIND(circumCircle2d, module);
+  GAL_FN_BIND_OVERLOADS(module, contains, circleContains);
+  GAL_FN_BIND_OVERLOADS(module, signedDistance, circleSignedDistance);
+  GAL_FN_BIND_OVERLOADS(module, closestPoints, circleClosestPoints);
 }
 
 }  // namespace func
@@ -1,4 +1,11 @@
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include <pybind11/pybind11.h>
 #include <spdlog/common.h>
@@ -10,6 +17,7 @@
 #include <Functions.h>
 #include <Line.h>
 #include <MapMacro.h>
+#include <Profiler.h>
 #include <TypeManager.h>
 #include <Types.h>
 #include <Util.h>
@@ -24,13 +32,179 @@ spdlog::logger& logger()
   return *sLogger;
 }
 
+namespace python {
+namespace py = pybind11;
+
+#if PY_VERSION_HEX < 0x030900B1
+static PyCodeObject* PyFrame_GetCode(PyFrameObject* frame)
+{
+  Py_INCREF(frame->f_code);
+  return frame->f_code;
+}
+
+static PyFrameObject* PyFrame_GetBack(PyFrameObject* frame)
+{
+  Py_XINCREF(frame->f_back);
+  return frame->f_back;
+}
+#endif
+
+/**
+ * @brief The python contexts are interned in a tree of frames, where the parent of a
+ * frame is the frame that called it. Functions created in the same context share the
+ * same node, and only store its index. The root node is the empty context.
+ */
+struct ContextNode
+{
+  uint32_t                mParent;
+  uint32_t                mCode;
+  std::optional<fs::path> mPath;
+};
+
+struct CodeInfo
+{
+  PyObject*   mObject;
+  std::string mFilename;
+  std::string mName;
+};
+
+static std::mutex                              sContextMutex;    // NOLINT
+static std::vector<CodeInfo>                   sCodes;           // NOLINT
+static std::unordered_map<PyObject*, uint32_t> sCodeIndices;     // NOLINT
+static std::deque<ContextNode>                 sContexts(1);     // NOLINT
+static std::unordered_map<uint64_t, uint32_t>  sContextIndices;  // NOLINT
+// Number of functions alive in all sessions, which may refer to the contexts.
+static std::atomic<size_t> sNumFunctions = 0;  // NOLINT
+
+static uint32_t internCode(PyObject* code)
+{
+  auto match = sCodeIndices.find(code);
+  if (match != sCodeIndices.end()) {
+    return match->second;
+  }
+  // The code object is kept alive, so that its address is not reused by another one.
+  Py_INCREF(code);
+  uint32_t index = uint32_t(sCodes.size());
+  sCodes.push_back({code,
+                    py::cast<std::string>(py::handle(code).attr("co_filename")),
+                    py::cast<std::string>(py::handle(code).attr("co_name"))});
+  sCodeIndices.emplace(code, index);
+  return index;
+}
+
+uint32_t capturecontext()
+{
+  // Functions created outside of python have no context.
+  if (!Py_IsInitialized() || !PyGILState_Check()) {
+    return 0;
+  }
+  static thread_local std::vector<PyObject*> sFrames;
+  sFrames.clear();
+  PyFrameObject* frame = PyEval_GetFrame();
+  Py_XINCREF(frame);
+  while (frame) {
+    sFrames.push_back((PyObject*)PyFrame_GetCode(frame));
+    PyFrameObject* back = PyFrame_GetBack(frame);
+    Py_DECREF(frame);
+    frame = back;
+  }
+  std::lock_guard lock(sContextMutex);
+  uint32_t        node = 0;
+  // Walk down the tree from the outermost frame.
+  for (auto it = sFrames.rbegin(); it != sFrames.rend(); it++) {
+    uint32_t code  = internCode(*it);
+    uint64_t key   = (uint64_t(node) << 32) | code;
+    auto     match = sContextIndices.find(key);
+    if (match == sContextIndices.end()) {
+      match = sContextIndices.emplace(key, uint32_t(sContexts.size())).first;
+      sContexts.push_back({node, code, std::nullopt});
+    }
+    node = match->second;
+    Py_DECREF(*it);
+  }
+  return node;
+}
+
+const fs::path& contextpath(uint32_t context)
+{
+  std::lock_guard lock(sContextMutex);
+  ContextNode&    node = sContexts[context];
+  if (node.mPath) {
+    return *node.mPath;
+  }
+  // Same format as the stack summary from the traceback module, visited from the
+  // innermost frame to the outermost.
+  fs::path result;
+  fs::path filename, cfn;
+  for (uint32_t i = context; i != 0; i = sContexts[i].mParent) {
+    const CodeInfo& code = sCodes[sContexts[i].mCode];
+    cfn                  = fs::path(code.mFilename);
+    if (filename != cfn || filename.empty()) {
+      if (!filename.empty()) {
+        result = filename.stem() / result;
+      }
+      filename = cfn;
+    }
+    if (code.mName != "<module>") {
+      result = code.mName / result;
+    }
+  }
+  node.mPath = filename.stem() / result;
+  return *node.mPath;
+}
+
+fs::path getcontextpath()
+{
+  return contextpath(capturecontext());
+}
+
+/**
+ * @brief Releases the interned contexts, if no function of any session refers to them.
+ */
+static void clearcontexts()
+{
+  std::vector<CodeInfo> codes;
+  {
+    // A function is counted before it captures its context, which requires this lock.
+    std::lock_guard lock(sContextMutex);
+    if (sNumFunctions > 0) {
+      return;
+    }
+    std::swap(codes, sCodes);
+    sCodeIndices.clear();
+    sContexts.resize(1);
+    sContextIndices.clear();
+  }
+  // The GIL is acquired after releasing the lock, because the contexts are captured
+  // while holding the GIL.
+  if (Py_IsInitialized()) {
+    py::gil_scoped_acquire gil;
+    for (const CodeInfo& code : codes) {
+      Py_DECREF(code.mObject);
+    }
+  }
+}
+
+}  // namespace python
+
 Function::Function()
-    : mContextPath(python::getcontextpath())
-{}
+{
+  // Counted before capturing the context, so the contexts are not cleared in between.
+  python::sNumFunctions++;
+  mContext = python::capturecontext();
+  // Variables write their outputs while they are constructed, before they are added to
+  // the session, so they need the session to version their outputs.
+  mSession = &Session::current();
+}
+
+Function::~Function()
+{
+  python::sNumFunctions--;
+}
 
 const fs::path& Function::contextpath() const
 {
-  return mContextPath;
+  return python::contextpath(mContext);
 }
 
 const FuncInfo& Function::info() const
@@ -63,70 +237,150 @@ int& Function::index()
   return mIndex;
 }
 
-namespace store {
+Session& Function::session() const
+{
+  return *mSession;
+}
 
-static std::vector<std::unique_ptr<Function>> sFunctions;  // NOLINT
+// Session made current on this thread, if it is not the default session.
+static thread_local Session* sCurrentSession = nullptr;  // NOLINT
+
+Session::Session()
+    : mProfileStats(mProperties)
+{}
+
+Session::~Session()
+{
+  clear();
+}
+
+Function* Session::addFunction(const FuncInfo& fnInfo, std::unique_ptr<Function> fn)
+{
+  fn->info()   = fnInfo;
+  fn->mIndex   = int(mFunctions.size());
+  fn->mSession = this;
+  mFunctions.push_back(std::move(fn));
+  mProperties.resize(mFunctions.size());
+  return mFunctions.back().get();
+}
+
+size_t Session::numFunctions() const
+{
+  return mFunctions.size();
+}
+
+const Function& Session::function(size_t i) const
+{
+  return *(mFunctions[i]);
+}
+
+Properties& Session::properties()
+{
+  return mProperties;
+}
+
+Property<profile::Stats>& Session::profileStats()
+{
+  return mProfileStats;
+}
+
+uint64_t Session::revision() const
+{
+  return mRevision;
+}
+
+uint64_t Session::newRevision()
+{
+  return ++mRevision;
+}
+
+void Session::setParallelEvaluation(bool flag)
+{
+  mParallelEvaluation = flag;
+}
+
+bool Session::parallelEvaluation() const
+{
+  return mParallelEvaluation;
+}
+
+void Session::setProfiling(bool flag)
+{
+  mProfiling = flag;
+}
+
+bool Session::profiling() const
+{
+  return mProfiling.load(std::memory_order_relaxed);
+}
+
+void Session::clear()
+{
+  mFunctions.clear();
+  mProperties.clear();
+  python::clearcontexts();
+}
+
+Session& Session::defaultSession()
+{
+  // Never destroyed, because unloading the functions at exit would use static objects,
+  // such as the interned contexts, that may already be destroyed.
+  static Session* sSession = new Session();
+  return *sSession;
+}
+
+Session& Session::current()
+{
+  return sCurrentSession ? *sCurrentSession : defaultSession();
+}
+
+Session* Session::makeCurrent(Session* session)
+{
+  return std::exchange(sCurrentSession, session);
+}
+
+void setParallelEvaluation(bool flag)
+{
+  Session::current().setParallelEvaluation(flag);
+}
+
+bool parallelEvaluation()
+{
+  return Session::current().parallelEvaluation();
+}
+
+namespace store {
 
 Function* addFunction(const FuncInfo& fnInfo, std::unique_ptr<Function> fn)
 {
-  fn->info()  = fnInfo;
-  fn->index() = int(sFunctions.size());
-  sFunctions.push_back(std::move(fn));
-  properties().resize(sFunctions.size());
-  return sFunctions.back().get();
+  return Session::current().addFunction(fnInfo, std::move(fn));
 };
 
 size_t numFunctions()
 {
-  return sFunctions.size();
+  return Session::current().numFunctions();
 }
 
 const Function& function(size_t i)
 {
-  return *(sFunctions[i]);
+  return Session::current().function(i);
 }
 
 Properties& properties()
 {
-  static Properties sProps;
-  return sProps;
+  return Session::current().properties();
 }
 
 void unloadAllFunctions()
 {
   logger().debug("Unloading all functions...");
-  sFunctions.clear();
+  Session::current().clear();
 }
 
 }  // namespace store
 
 namespace python {
 namespace py = pybind11;
-fs::path getcontextpath()
-{
-  auto traceback = py::module_::import("traceback");
-  auto summary   = py::list(traceback.attr("extract_stack")());
-  int  n         = int(len(summary));
-
-  fs::path    result;
-  fs::path    filename, cfn;
-  std::string name;
-  for (int i = n - 1; i > -1; i--) {
-    cfn = fs::path(std::string(py::cast<std::string>(summary[i].attr("filename"))));
-    if (filename != cfn || filename.empty()) {
-      if (!filename.empty()) {
-        result = filename.stem() / result;
-      }
-      filename = cfn;
-    }
-    name = py::cast<std::string>(summary[i].attr("name"));
-    if (name != "<module>") {
-      result = name / result;
-    }
-  }
-  result = filename.stem() / result;
-  return result;
-}
 
 FuncDocString::FuncDocString(const FuncInfo& fnInfo)
     : mDocString(fnInfo.mDesc)
@@ -159,6 +413,21 @@ const char* FuncDocString::c_str() const
   return mDocString.c_str();
 }
 
+// The sessions that were current before the sessions entered on this thread.
+static thread_local std::vector<Session*> sPreviousSessions;  // NOLINT
+
+static Session& enterSession(Session& session)
+{
+  sPreviousSessions.push_back(Session::makeCurrent(&session));
+  return session;
+}
+
+static void exitSession(Session& session, const py::args&)
+{
+  Session::makeCurrent(sPreviousSessions.back());
+  sPreviousSessions.pop_back();
+}
+
 }  // namespace python
 
 // Forward declare the binding functions.
@@ -172,6 +441,8 @@ void bind_MathFunc(py::module&);
 void bind_ListFunc(py::module&);
 void bind_TreeFunc(py::module&);
 void bind_SortFunc(py::module&);
+void bind_ReduceFunc(py::module&);
+void bind_VoxelFunc(py::module&);
 
 }  // namespace func
 }  // namespace gal
@@ -183,6 +454,91 @@ PYBIND11_MODULE(pygalfunc, pgf)  // NOLINT
 
   typemanager::invoke<defClass>((py::module&)pgf);
 
+  py::class_<Session>(pgf,
+                      "Session",
+                      "An independent function graph. The functions created inside the "
+                      "with block of a session belong to that session. Different "
+                      "sessions can be evaluated concurrently from different threads, "
+                      "but a session must only be used by one thread at a time. "
+                      "Functions created outside of any session belong to the default "
+                      "session.")
+    .def(py::init<>())
+    .def("__enter__", &enterSession, py::return_value_policy::reference)
+    .def("__exit__", &exitSession)
+    .def("setParallelEvaluation",
+         &Session::setParallelEvaluation,
+         "Sets whether independent functions of the session are evaluated in parallel.")
+    .def("parallelEvaluation",
+         &Session::parallelEvaluation,
+         "Whether independent functions of the session are evaluated in parallel.")
+    .def("setProfiling",
+         &Session::setProfiling,
+         "Sets whether the run times and the output sizes of the functions of the "
+         "session are recorded.")
+    .def("profiling", &Session::profiling, "Whether the session is profiled.")
+    .def("clear",
+         &Session::clear,
+         "Unloads all the functions of the session. Their registers must not be used "
+         "afterwards.");
+
+  pgf.def("setParallelEvaluation",
+          &setParallelEvaluation,
+          "Sets whether independent functions of the current session are evaluated in "
+          "parallel. If this is false, the functions are evaluated one after another on "
+          "a single thread.");
+  pgf.def("parallelEvaluation",
+          &parallelEvaluation,
+          "Whether independent functions of the current session are evaluated in "
+          "parallel.");
+  pgf.def(
+    "setCacheDirectory",
+    [](const std::string& dir, uint64_t maxBytes) { cache::setDirectory(dir, maxBytes); },
+    "Stores the outputs of cached functions in the given directory, so they are reused "
+    "when the functions run with the same inputs, even in later sessions. The least "
+    "recently used outputs are deleted when the total size exceeds the limit.",
+    py::arg("dir"),
+    py::arg("maxBytes") = cache::DefaultMaxBytes);
+  pgf.def("disableCache", &cache::disable, "Stops using the cache directory.");
+  pgf.def("clearCache", &cache::clear, "Deletes all the entries in the cache directory.");
+  pgf.def(
+    "saveSnapshot",
+    [](const std::string& path, bool outputs) {
+      py::gil_scoped_release release;
+      snapshot::saveToFile(path, outputs);
+    },
+    "Saves the function graph of the current session to a file, so it can be restored "
+    "without running the script that created it. If outputs is true, the graph is "
+    "evaluated, and the outputs of the functions are saved as well, so they don't run "
+    "again after the graph is restored.",
+    py::arg("path"),
+    py::arg("outputs") = false);
+  pgf.def("setProfiling",
+          &profile::setEnabled,
+          "Sets whether the run times and the output sizes of the functions of the "
+          "current session are recorded.");
+  pgf.def("profiling", &profile::enabled, "Whether the current session is profiled.");
+  pgf.def("resetProfile", &profile::reset, "Clears the recorded profile.");
+  pgf.def(
+    "profile",
+    []() {
+      py::list dst;
+      for (const auto& [fn, stats] : profile::records()) {
+        py::dict entry;
+        entry["name"]         = std::string(fn->info().mName);
+        entry["context"]      = fn->contextpath().string();
+        entry["runs"]         = stats.mNumRuns;
+        entry["combinations"] = stats.mNumCombinations;
+        entry["totalTime"]    = std::chrono::duration<double>(stats.mTotalTime).count();
+        entry["lastTime"]     = std::chrono::duration<double>(stats.mLastTime).count();
+        entry["elements"]     = stats.mNumElements;
+        entry["bytes"]        = stats.mNumBytes;
+        dst.append(entry);
+      }
+      return dst;
+    },
+    "Statistics of the functions that ran since profiling was enabled, sorted by the "
+    "total run time. The times are in seconds.");
+
   bind_UtilFunc(pgf);
   bind_GeomFunc(pgf);
   bind_CircleFunc(pgf);
@@ -193,4 +549,6 @@ PYBIND11_MODULE(pygalfunc, pgf)  // NOLINT
   bind_ListFunc(pgf);
   bind_TreeFunc(pgf);
   bind_SortFunc(pgf);
+  bind_ReduceFunc(pgf);
+  bind_VoxelFunc(pgf);
 };
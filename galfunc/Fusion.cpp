@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <Functions.h>
+
+namespace gal {
+namespace func {
+
+static constexpr size_t NotInChain = SIZE_MAX;
+
+FusedChain::FusedChain(std::vector<const Function*> functions)
+    : mFunctions(std::move(functions))
+{
+  if (mFunctions.empty()) {
+    throw std::invalid_argument("A fused chain needs at least one function");
+  }
+  std::vector<InputInfo> inputs;
+  mSources.resize(mFunctions.size());
+  for (size_t i = 0; i < mFunctions.size(); i++) {
+    mFunctions[i]->getInputs(inputs);
+    for (const auto& input : inputs) {
+      auto   match = std::find(mFunctions.begin(), mFunctions.begin() + i, input.mFunc);
+      size_t node  = match == mFunctions.begin() + i ? NotInChain
+                                                     : size_t(match - mFunctions.begin());
+      mSources[i].push_back({input.mFunc, size_t(input.mOutputIdx), node, {}});
+    }
+  }
+}
+
+const Function& FusedChain::last() const
+{
+  return *(mFunctions.back());
+}
+
+size_t FusedChain::size() const
+{
+  return mSize;
+}
+
+data::DepthT FusedChain::depth() const
+{
+  return mDepth;
+}
+
+const std::vector<uint64_t>& FusedChain::signature() const
+{
+  return mSignature;
+}
+
+bool FusedChain::prepare()
+{
+  mSignature.clear();
+  mSize  = 0;
+  mDepth = 0;
+  for (size_t i = 0; i < mFunctions.size(); i++) {
+    for (size_t j = 0; j < mSources[i].size(); j++) {
+      Source& src = mSources[i][j];
+      if (src.mNode != NotInChain) {
+        continue;
+      }
+      if (!mFunctions[i]->flatInput(j, src.mTree)) {
+        return false;
+      }
+      mSize  = std::max(mSize, src.mTree.mSize);
+      mDepth = std::max(mDepth, src.mTree.mDepth);
+      mSignature.push_back(uint64_t(reinterpret_cast<uintptr_t>(src.mFunc)));
+      mSignature.push_back(src.mOutputIdx);
+      mSignature.push_back(src.mFunc->version(src.mOutputIdx));
+    }
+  }
+  return true;
+}
+
+void FusedChain::update()
+{
+  if (prepare()) {
+    last().updateFused(*this);
+    return;
+  }
+  for (const Function* fn : mFunctions) {
+    fn->updateLocal();
+  }
+}
+
+void FusedChain::runBlock(size_t                                begin,
+                          size_t                                end,
+                          std::vector<std::vector<std::byte*>>& buffers,
+                          std::span<void* const>                outputs) const
+{
+  // Split the block where the shorter inputs run out of values, and start repeating their
+  // last value, so every input is either contiguous or constant in each part.
+  std::vector<size_t> ends = {end};
+  for (const auto& sources : mSources) {
+    for (const auto& src : sources) {
+      if (src.mNode == NotInChain && src.mTree.mSize > begin && src.mTree.mSize < end) {
+        ends.push_back(src.mTree.mSize);
+      }
+    }
+  }
+  std::sort(ends.begin(), ends.end());
+  ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+  std::vector<ElementArray> src;
+  std::vector<ElementArray> dst;
+  size_t                    from = begin;
+  for (size_t to : ends) {
+    for (size_t i = 0; i < mFunctions.size(); i++) {
+      const Function& fn = *(mFunctions[i]);
+      src.clear();
+      for (const auto& source : mSources[i]) {
+        if (source.mNode == NotInChain) {
+          const FlatTree& tree       = source.mTree;
+          bool            isConstant = tree.mSize <= from;
+          size_t          pos        = isConstant ? tree.mSize - 1 : from;
+          src.push_back(
+            {const_cast<std::byte*>(static_cast<const std::byte*>(tree.mValues)) +
+               pos * tree.mValueSize,
+             isConstant});
+        }
+        else {
+          const Function& producer = *(mFunctions[source.mNode]);
+          src.push_back({buffers[source.mNode][source.mOutputIdx] +
+                           (from - begin) * producer.outputValueSize(source.mOutputIdx),
+                         false});
+        }
+      }
+      dst.clear();
+      for (size_t o = 0; o < fn.numOutputs(); o++) {
+        if (i + 1 == mFunctions.size()) {
+          dst.push_back(
+            {static_cast<std::byte*>(outputs[o]) + from * fn.outputValueSize(o), false});
+        }
+        else {
+          dst.push_back({buffers[i][o] + (from - begin) * fn.outputValueSize(o), false});
+        }
+      }
+      fn.runElements(src, dst, to - from);
+    }
+    from = to;
+  }
+}
+
+void FusedChain::run(std::span<void* const> outputs) const
+{
+  size_t nBlocks = (mSize + BlockSize - 1) / BlockSize;
+  auto   runBlocks = [&](size_t first, size_t last) {
+    // Buffers for the outputs of the functions before the last one, for one block.
+    std::vector<std::vector<std::max_align_t>> storage;
+    std::vector<std::vector<std::byte*>>       buffers(mFunctions.size());
+    for (size_t i = 0; i + 1 < mFunctions.size(); i++) {
+      const Function& fn = *(mFunctions[i]);
+      for (size_t o = 0; o < fn.numOutputs(); o++) {
+        size_t nBytes = BlockSize * fn.outputValueSize(o);
+        storage.emplace_back((nBytes + sizeof(std::max_align_t) - 1) /
+                             sizeof(std::max_align_t));
+        buffers[i].push_back(reinterpret_cast<std::byte*>(storage.back().data()));
+      }
+    }
+    for (size_t b = first; b < last; b++) {
+      runBlock(b * BlockSize, std::min(mSize, (b + 1) * BlockSize), buffers, outputs);
+    }
+  };
+  // The functions of the chain are pure, so the blocks can be run in parallel.
+  if (nBlocks > 1 && last().session().parallelEvaluation()) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, nBlocks),
+                      [&](const tbb::blocked_range<size_t>& range) {
+                        runBlocks(range.begin(), range.end());
+                      });
+  }
+  else {
+    runBlocks(0, nBlocks);
+  }
+}
+
+}  // namespace func
+}  // namespace gal
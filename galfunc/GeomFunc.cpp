@@ -7,62 +7,62 @@
 namespace gal {
 namespace func {
 
-GAL_FUNC(vec3,  // NOLINT
-         "Creates a 3D vector from coordinates",
-         ((float, x, "x coordinate"),
-          (float, y, "y coordinate"),
-          (float, z, "z coordinate")),
-         ((glm::vec3, vector, "3D vector")))
+GAL_PURE_FUNC(vec3,  // NOLINT
+              "Creates a 3D vector from coordinates",
+              ((float, x, "x coordinate"),
+               (float, y, "y coordinate"),
+               (float, z, "z coordinate")),
+              ((glm::vec3, vector, "3D vector")))
 {
   vector.x = x;
   vector.y = y;
   vector.z = z;
 }
 
-GAL_FUNC(vec2,  // NOLINT
-         "Creates a 2D vector from coordinates",
-         ((float, x, "x coordinate"), (float, y, "y coordinate")),
-         ((glm::vec2, vector, "2D vector")))
+GAL_PURE_FUNC(vec2,  // NOLINT
+              "Creates a 2D vector from coordinates",
+              ((float, x, "x coordinate"), (float, y, "y coordinate")),
+              ((glm::vec2, vector, "2D vector")))
 {
   vector.x = x;
   vector.y = y;
 }
 
-GAL_FUNC(vec3FromVec2,  // NOLINT
-         "Creates a 2D vector from coordinates",
-         ((glm::vec2, v2, "2d vector")),
-         ((glm::vec3, v3, "3D vector")))
+GAL_PURE_FUNC(vec3FromVec2,  // NOLINT
+              "Creates a 2D vector from coordinates",
+              ((glm::vec2, v2, "2d vector")),
+              ((glm::vec3, v3, "3D vector")))
 {
   v3.x = v2.x;
   v3.y = v2.y;
   v3.z = 0.f;
 }
 
-GAL_FUNC(vec2FromVec3,  // NOLINT
-         "Creates a 2D vector from coordinates",
-         ((glm::vec3, v3, "3d vector")),
-         ((glm::vec2, v2, "2d vector")))
+GAL_PURE_FUNC(vec2FromVec3,  // NOLINT
+              "Creates a 2D vector from coordinates",
+              ((glm::vec3, v3, "3d vector")),
+              ((glm::vec2, v2, "2d vector")))
 {
   v2.x = v3.x;
   v2.y = v3.y;
 }
 
-GAL_FUNC(vec3Coords,  // NOLINT
-         "Gets the coordinates of the vector",
-         ((glm::vec3, v, "Vector")),
-         ((float, x, "x coordinate"),
-          (float, y, "y coordinate"),
-          (float, z, "z coordinate")))
+GAL_PURE_FUNC(vec3Coords,  // NOLINT
+              "Gets the coordinates of the vector",
+              ((glm::vec3, v, "Vector")),
+              ((float, x, "x coordinate"),
+               (float, y, "y coordinate"),
+               (float, z, "z coordinate")))
 {
   x = v.x;
   y = v.y;
   z = v.z;
 }
 
-GAL_FUNC(vec2Coords,  // NOLINT
-         "Gets the coordinates of the vector",
-         ((glm::vec2, v, "Vector")),
-         ((float, x, "x coordinate"), (float, y, "y coordinate")))
+GAL_PURE_FUNC(vec2Coords,  // NOLINT
+              "Gets the coordinates of the vector",
+              ((glm::vec2, v, "Vector")),
+              ((float, x, "x coordinate"), (float, y, "y coordinate")))
 {
   x = v.x;
   y = v.y;
@@ -102,14 +102,32 @@ GAL_FUNC(randomPointsInBox,  // NOLINT
          (((data::WriteView<glm::vec3, 1>), points, "Point cloud")))
 {
   size_t nPts = size_t(numPoints);
-  points.reserve(nPts);
-  box.randomPoints(nPts, std::back_inserter(points));
+  points.resize(nPts);
+  if (nPts > 0) {
+    box.randomPoints(nPts, &points[0]);
+  }
 }
 
-GAL_FUNC(convexHullFromPoints,  // NOLINT
-         "Creates a convex hull from the given point cloud",
-         (((data::ReadView<glm::vec3, 1>), points, "Point cloud")),
-         ((gal::TriMesh, hull, "Convex hull")))
+GAL_FUNC(randomPointsInBoxSeeded,  // NOLINT
+         "Creates a random point cloud with points inside the given box. The points are "
+         "deterministic for a given seed",
+         ((gal::Box3, box, "Box to sample from"),
+          (int32_t, numPoints, "Number of points to sample"),
+          (int32_t, seed, "Seed for the random number generator")),
+         (((data::WriteView<glm::vec3, 1>), points, "Point cloud")))
+{
+  size_t nPts = size_t(numPoints);
+  points.resize(nPts);
+  if (nPts > 0) {
+    box.randomPoints(nPts, &points[0], uint64_t(uint32_t(seed)));
+  }
+}
+
+GAL_CACHED_FUNC(convexHullFromPoints,  // NOLINT
+                1,
+                "Creates a convex hull from the given point cloud",
+                (((data::ReadView<glm::vec3, 1>), points, "Point cloud")),
+                ((gal::TriMesh, hull, "Convex hull")))
 {
   hull = std::move(gal::ConvexHull(points.begin(), points.end()).toMesh());
 }
@@ -123,18 +141,18 @@ GAL_FUNC(pointCloud3d,  // NOLINT
   std::copy(points.begin(), points.end(), cloud.begin());
 }
 
-GAL_FUNC(distance3,  // NOLINT
-         "Gets the distance betwen the two points",
-         ((glm::vec3, a, "first point"), (glm::vec3, b, "second point")),
-         ((float, dist, "Distance")))
+GAL_PURE_FUNC(distance3,  // NOLINT
+              "Gets the distance betwen the two points",
+              ((glm::vec3, a, "first point"), (glm::vec3, b, "second point")),
+              ((float, dist, "Distance")))
 {
   dist = glm::distance(a, b);
 }
 
-GAL_FUNC(distance2,  // NOLINT
-         "Gets the distance betwen the two points",
-         ((glm::vec2, a, "first point"), (glm::vec2, b, "second point")),
-         ((float, dist, "Distance")))
+GAL_PURE_FUNC(distance2,  // NOLINT
+              "Gets the distance betwen the two points",
+              ((glm::vec2, a, "first point"), (glm::vec2, b, "second point")),
+              ((float, dist, "Distance")))
 {
   dist = glm::distance(a, b);
 }
@@ -157,6 +175,68 @@ GAL_FUNC(box2Points,  // NOLINT
   max = box.max;
 }
 
+GAL_FUNC(boxContains,  // NOLINT
+         "Checks which of the given points are inside the box",
+         ((gal::Box3, box, "The box"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points to test")),
+         (((data::WriteView<gal::Bool, 1>), results, "Whether each point is inside")))
+{
+  results.resize(points.size());
+  if (!points.empty()) {
+    box.contains(points.data(), points.size(), &results[0]);
+  }
+}
+
+GAL_FUNC(boxSignedDistance,  // NOLINT
+         "Signed distances of the points from the boundary of the box. The distances "
+         "are negative inside the box",
+         ((gal::Box3, box, "The box"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points")),
+         (((data::WriteView<float, 1>), distances, "Signed distances")))
+{
+  distances.resize(points.size());
+  if (!points.empty()) {
+    box.signedDistance(points.data(), points.size(), &distances[0]);
+  }
+}
+
+GAL_FUNC(boxClosestPoints,  // NOLINT
+         "Closest points inside the box, to the given points",
+         ((gal::Box3, box, "The box"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points")),
+         (((data::WriteView<glm::vec3, 1>), closest, "Closest points")))
+{
+  closest.resize(points.size());
+  if (!points.empty()) {
+    box.closestPoints(points.data(), points.size(), &closest[0]);
+  }
+}
+
+GAL_FUNC(planeSignedDistance,  // NOLINT
+         "Signed distances of the points from the plane. The distances are positive on "
+         "the side the normal points to",
+         ((gal::Plane, plane, "The plane"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points")),
+         (((data::WriteView<float, 1>), distances, "Signed distances")))
+{
+  distances.resize(points.size());
+  if (!points.empty()) {
+    plane.signedDistance(points.data(), points.size(), &distances[0]);
+  }
+}
+
+GAL_FUNC(planeClosestPoints,  // NOLINT
+         "Projects the points onto the plane",
+         ((gal::Plane, plane, "The plane"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points")),
+         (((data::WriteView<glm::vec3, 1>), closest, "Projected points")))
+{
+  closest.resize(points.size());
+  if (!points.empty()) {
+    plane.project(points.data(), points.size(), &closest[0]);
+  }
+}
+
 void bind_GeomFunc(py::module& module)
 {
   GAL_FN_BIND(vec3, module);
@@ -164,9 +244,13 @@ void bind_GeomFunc(py::module& module)
   GAL_FN_BIND(plane, module);
   GAL_FN_BIND(box3, module);
   GAL_FN_BIND(box2, module);
-  GAL_FN_BIND(randomPointsInBox, module);
+  GAL_FN_BIND_OVERLOADS(
+    module, randomPointsInBox, randomPointsInBox, randomPointsInBoxSeeded);
   GAL_FN_BIND(convexHullFromPoints, module);
   GAL_FN_BIND(pointCloud3d, module);
+  GAL_FN_BIND_OVERLOADS(module, contains, boxContains);
+  GAL_FN_BIND_OVERLOADS(module, signedDistance, boxSignedDistance, planeSignedDistance);
+  GAL_FN_BIND_OVERLOADS(module, closestPoints, boxClosestPoints, planeClosestPoints);
 
   // TODO: Handle these with generic converters later.
   GAL_FN_BIND(vec3FromVec2, module);
@@ -1,39 +1,87 @@
+#include <concepts>
+#include <span>
+#include <stdexcept>
+
 #include <Functions.h>
+#include <Reduce.h>
+#include <Scan.h>
 #include <TypeManager.h>
 
 namespace gal {
 namespace func {
 
-GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
-                  series,
-                  "Populates a list with members of an arithmetic progression.",
-                  ((T, start, "Start of the series"),
-                   (T, step, "Difference between consecutive members of the series."),
-                   (int32_t, count, "Number of elements in the series")),
-                  (((data::WriteView<T, 1>), result, "The series")))
+namespace listfunc {  // Namespace to avoid linker confusion.
+
+/**
+ * @brief Converts the indices of the items of a list, and checks that they are in range.
+ *
+ * @param indices The indices.
+ * @param n The length of the list.
+ */
+std::vector<size_t> checkedIndices(const data::ReadView<int32_t, 1>& indices, size_t n)
+{
+  std::vector<size_t> dst(indices.size());
+  const int32_t*      src = indices.data();
+  utils::forEachBlock(dst.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (src[i] < 0 || size_t(src[i]) >= n) {
+        throw std::range_error("Index out of range of the list");
+      }
+      dst[i] = size_t(src[i]);
+    }
+  });
+  return dst;
+}
+
+/**
+ * @brief Indices at which the runs of consecutive equal items of the list start.
+ */
+template<typename T>
+std::vector<size_t> runStarts(const data::ReadView<T, 1>& list)
+{
+  data::ListValues<T> values(list);
+  return utils::selectIndices(list.size(), [&](size_t i) {
+    return i == 0 || !(values[i] == values[i - 1]);
+  });
+}
+
+}  // namespace listfunc
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       series,
+                       "Populates a list with members of an arithmetic progression.",
+                       ((T, start, "Start of the series"),
+                        (T,
+                         step,
+                         "Difference between consecutive members of the series."),
+                        (int32_t, count, "Number of elements in the series")),
+                       (((data::WriteView<T, 1>), result, "The series")))
 {
   if (count == 0) {
     return;
   }
   result.resize(count);
-  T item = start;
-  for (int32_t i = 0; i < count; i++) {
-    result[i] = item;
-    item += step;
-  }
+  utils::forEachBlock(size_t(count), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      result[i] = start + T(i) * step;
+    }
+  });
 }
 
-GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
-                  repeat,
-                  "Creates a list by repeating the given value the given number of times",
-                  ((T, val, "The value to be repeated"),
-                   (int32_t, count, "Number of times to repeat the value.")),
-                  (((data::WriteView<T, 1>), result, "Resulting list")))
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       repeat,
+                       "Creates a list by repeating the given value the given number of "
+                       "times",
+                       ((T, val, "The value to be repeated"),
+                        (int32_t, count, "Number of times to repeat the value.")),
+                       (((data::WriteView<T, 1>), result, "Resulting list")))
 {
   result.resize(count);
-  for (int32_t i = 0; i < count; i++) {
-    result[i] = val;
-  }
+  utils::forEachBlock(size_t(count), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      result[i] = val;
+    }
+  });
 }
 
 GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
@@ -45,32 +93,33 @@ GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
   item = list[index];
 }
 
-GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
-                  subList,
-                  "Gets a slice of the list",
-                  (((data::ReadView<T, 1>), list, "Source list"),
-                   (int32_t, start, "Index to start copying from"),
-                   (int32_t, stop, "Index to copy until")),
-                  (((data::WriteView<T, 1>), sublist, "The sub list.")))
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       subList,
+                       "Gets a slice of the list",
+                       (((data::ReadView<T, 1>), list, "Source list"),
+                        (int32_t, start, "Index to start copying from"),
+                        (int32_t, stop, "Index to copy until")),
+                       (((data::WriteView<T, 1>), sublist, "The sub list.")))
 {
   if (stop < start || start < 0 || stop >= list.size()) {
     throw std::range_error("Invalid indices for sub-list");
   }
+  data::ListValues<T> values(list);
   sublist.resize(stop - start);
-  for (int i = start, j = 0; i < stop; i++, j++) {
-    sublist[j] = list[i];
-  }
+  utils::forEachBlock(size_t(stop - start), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      sublist[i] = values[start + i];
+    }
+  });
 }
 
-GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
-                  listSum,
-                  "Sum of all items in the list",
-                  (((data::ReadView<T, 1>), list, "List")),
-                  ((T, sum, "Sum of items")))
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       listSum,
+                       "Sum of all items in the list",
+                       (((data::ReadView<T, 1>), list, "List")),
+                       ((T, sum, "Sum of items")))
 {
-  static constexpr T sZero = T(0);
-
-  sum = std::accumulate(list.begin(), list.end(), sZero);
+  sum = utils::sum(std::span<const T>(list.data(), list.size()));
 }
 
 GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
@@ -82,7 +131,7 @@ GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
   length = int32_t(list.size());
 }
 
-GAL_FUNC_TEMPLATE(  // NOLINT
+GAL_PURE_FUNC_TEMPLATE(  // NOLINT
   ((typename, T)),
   dispatch,
   "Dispatches elements of a list based on a boolean pattern",
@@ -91,22 +140,138 @@ GAL_FUNC_TEMPLATE(  // NOLINT
   (((data::WriteView<T, 1>), trueLst, "Items with true values"),
    ((data::WriteView<T, 1>), falseLst, "Items with false values")))
 {
-  if (items.size() != pattern.size()) {
+  size_t n = items.size();
+  if (n != pattern.size()) {
     throw std::length_error(
       "The dispatch pattern must be of the same length as the list of items to be "
       "dispatched.");
   }
-  for (size_t i = 0; i < pattern.size(); i++) {
-    if (pattern[i]) {
-      trueLst.push_back(items[i]);
+  data::ListValues<Bool> flags(pattern);
+  auto                   isTrue = [&](size_t i) { return bool(flags[i]); };
+  std::vector<size_t>    indices;
+  size_t                 nTrue = utils::partitionIndices<true>(n, isTrue, indices);
+  data::ListValues<T> values(items);
+  trueLst.resize(nTrue);
+  utils::gather(values, std::span<const size_t>(indices.data(), nTrue), trueLst);
+  falseLst.resize(n - nTrue);
+  utils::gather(values, std::span<const size_t>(indices).subspan(nTrue), falseLst);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       filter,
+                       "Gets the items of a list whose values in a boolean pattern are "
+                       "true, in their original order",
+                       (((data::ReadView<T, 1>), items, "Items to be filtered"),
+                        ((data::ReadView<Bool, 1>), pattern, "Boolean values")),
+                       (((data::WriteView<T, 1>), filtered, "Items with true values")))
+{
+  size_t n = items.size();
+  if (n != pattern.size()) {
+    throw std::length_error(
+      "The pattern must be of the same length as the list of items to be filtered.");
+  }
+  data::ListValues<Bool> flags(pattern);
+  std::vector<size_t>    indices =
+    utils::selectIndices(n, [&](size_t i) { return bool(flags[i]); });
+  filtered.resize(indices.size());
+  utils::gather(data::ListValues<T>(items), std::span<const size_t>(indices), filtered);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       gather,
+                       "Gets the items of a list at the given indices",
+                       (((data::ReadView<T, 1>), list, "Source list"),
+                        ((data::ReadView<int32_t, 1>), indices, "Indices of the items")),
+                       (((data::WriteView<T, 1>), items, "Items at the indices")))
+{
+  std::vector<size_t> checked = listfunc::checkedIndices(indices, list.size());
+  items.resize(checked.size());
+  utils::gather(data::ListValues<T>(list), std::span<const size_t>(checked), items);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       scatter,
+                       "Replaces the items of a list at the given indices with the given "
+                       "values. When an index is repeated, its last value is used",
+                       (((data::ReadView<T, 1>), list, "Source list"),
+                        ((data::ReadView<T, 1>), values, "New values of the items"),
+                        ((data::ReadView<int32_t, 1>), indices, "Indices of the items")),
+                       (((data::WriteView<T, 1>), result, "List with the new values")))
+{
+  size_t n = list.size();
+  if (indices.size() != values.size()) {
+    throw std::length_error("The number of indices must be the same as the number of "
+                            "values");
+  }
+  std::vector<size_t> checked = listfunc::checkedIndices(indices, n);
+  data::ListValues<T> src(list);
+  result.resize(n);
+  utils::forEachBlock(n, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      result[i] = src[i];
     }
-    else {
-      falseLst.push_back(items[i]);
+  });
+  utils::scatter(
+    data::ListValues<T>(values), std::span<const size_t>(checked), result, n);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       inclusiveScan,
+                       "Running sum of a list. Each sum includes the item at its index",
+                       (((data::ReadView<T, 1>), list, "List to be summed")),
+                       (((data::WriteView<T, 1>), sums, "Running sums")))
+{
+  size_t n = list.size();
+  sums.resize(n);
+  utils::inclusiveScan(std::span<const T>(list.data(), n), sums);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       exclusiveScan,
+                       "Running sum of a list, starting at zero. Each sum includes the "
+                       "items before its index",
+                       (((data::ReadView<T, 1>), list, "List to be summed")),
+                       (((data::WriteView<T, 1>), sums, "Running sums")))
+{
+  size_t n = list.size();
+  sums.resize(n);
+  utils::exclusiveScan(std::span<const T>(list.data(), n), sums);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       unique,
+                       "Removes the consecutive repeated items of a list. Sort the list "
+                       "first to remove all the repeated items",
+                       (((data::ReadView<T, 1>), list, "Source list")),
+                       (((data::WriteView<T, 1>), items, "Items without repetitions")))
+{
+  std::vector<size_t> starts = listfunc::runStarts(list);
+  items.resize(starts.size());
+  utils::gather(data::ListValues<T>(list), std::span<const size_t>(starts), items);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       runLengthEncode,
+                       "Encodes each run of consecutive equal items of a list as the "
+                       "item and the length of the run",
+                       (((data::ReadView<T, 1>), list, "Source list")),
+                       (((data::WriteView<T, 1>), items, "Item of each run"),
+                        ((data::WriteView<int32_t, 1>), counts, "Length of each run")))
+{
+  std::vector<size_t> starts = listfunc::runStarts(list);
+  size_t              n      = list.size();
+  items.resize(starts.size());
+  utils::gather(data::ListValues<T>(list), std::span<const size_t>(starts), items);
+  counts.resize(starts.size());
+  utils::forEachBlock(starts.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      size_t next = i + 1 < starts.size() ? starts[i + 1] : n;
+      counts[i]   = int32_t(next - starts[i]);
     }
-  }
+  });
 }
 
-namespace listfunc {  // Anon namespace to avoid linker confusion.
+namespace listfunc {
 
 template<typename T>
 struct bindForAllTypes
@@ -118,6 +283,14 @@ struct bindForAllTypes
     GAL_FN_BIND_TEMPLATE(subList, mod, T);
     GAL_FN_BIND_TEMPLATE(listLength, mod, T);
     GAL_FN_BIND_TEMPLATE(dispatch, mod, T);
+    GAL_FN_BIND_TEMPLATE(filter, mod, T);
+    GAL_FN_BIND_TEMPLATE(gather, mod, T);
+    GAL_FN_BIND_TEMPLATE(scatter, mod, T);
+    // Runs can only be found in lists of comparable items.
+    if constexpr (std::equality_comparable<T>) {
+      GAL_FN_BIND_TEMPLATE(unique, mod, T);
+      GAL_FN_BIND_TEMPLATE(runLengthEncode, mod, T);
+    }
   }
 };
 
@@ -128,6 +301,14 @@ void bind_ListFunc(py::module& mod)
   GAL_FN_BIND_TEMPLATE(series, mod, int32_t);
   GAL_FN_BIND_TEMPLATE(listSum, mod, float);
   GAL_FN_BIND_TEMPLATE(listSum, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(inclusiveScan, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(inclusiveScan, mod, float);
+  GAL_FN_BIND_TEMPLATE(inclusiveScan, mod, glm::vec2);
+  GAL_FN_BIND_TEMPLATE(inclusiveScan, mod, glm::vec3);
+  GAL_FN_BIND_TEMPLATE(exclusiveScan, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(exclusiveScan, mod, float);
+  GAL_FN_BIND_TEMPLATE(exclusiveScan, mod, glm::vec2);
+  GAL_FN_BIND_TEMPLATE(exclusiveScan, mod, glm::vec3);
   typemanager::invoke<listfunc::bindForAllTypes>((py::module&)mod);
 }
 
@@ -7,6 +7,7 @@
 #include <Functions.h>
 #include <Line.h>
 #include <Mesh.h>
+#include <MeshSampling.h>
 
 namespace gal {
 namespace func {
@@ -40,7 +41,9 @@ GAL_FUNC(loadTriangleMesh,  // NOLINT
          ((std::string, filepath, "The path to the obj file")),
          ((gal::TriMesh, mesh, "Loaded mesh")))
 {
-  mesh = TriMesh::loadFromFile(filepath);
+  // The key of the cached mesh depends on the file, not just the path.
+  mesh = cache::readFile<TriMesh>(
+    "loadTriangleMesh", 1, filepath, [&]() { return TriMesh::loadFromFile(filepath); });
 }
 
 GAL_FUNC(loadPolyMesh,  // NOLINT
@@ -61,25 +64,25 @@ GAL_FUNC_TEMPLATE(((typename, MeshT)),  // NOLINT
   scaled.transform(glm::scale(glm::vec3(scale)));
 }
 
-GAL_FUNC(clipMesh,  // NOLINT
-         "Clips the given mesh with the plane. Returns a new mesh.",
-         ((gal::TriMesh, mesh, "mesh to clip"),
-          (gal::Plane, plane, "Plane to clip with")),
-         ((gal::TriMesh, clipped, "Clipped mesh")))
+GAL_PURE_FUNC(clipMesh,  // NOLINT
+              "Clips the given mesh with the plane. Returns a new mesh.",
+              ((gal::TriMesh, mesh, "mesh to clip"),
+               (gal::Plane, plane, "Plane to clip with")),
+              ((gal::TriMesh, clipped, "Clipped mesh")))
 {
   clipped = mesh.clippedWithPlane(plane);
 }
 
-GAL_FUNC(meshSphereQuery,  // NOLINT
-         "Queries the mesh face rtree with the given sphere and "
-         "returns the new sub-mesh",
-         ((gal::TriMesh, mesh, "Mesh to query"),
-          (gal::Sphere, sphere, "Sphere to query the faces with")),
-         ((gal::TriMesh, resultMesh, "Mesh with the queried faces"),
-          ((data::WriteView<int32_t, 1>),
-           faceIndices,
-           "Indices of the faces that are inside / near the query sphere"),
-          (int32_t, numFaces, "The number of faces in the query results")))
+GAL_PURE_FUNC(meshSphereQuery,  // NOLINT
+              "Queries the mesh face rtree with the given sphere and "
+              "returns the new sub-mesh",
+              ((gal::TriMesh, mesh, "Mesh to query"),
+               (gal::Sphere, sphere, "Sphere to query the faces with")),
+              ((gal::TriMesh, resultMesh, "Mesh with the queried faces"),
+               ((data::WriteView<int32_t, 1>),
+                faceIndices,
+                "Indices of the faces that are inside / near the query sphere"),
+               (int32_t, numFaces, "The number of faces in the query results")))
 {
   // TODO: Refactor this to not require this vector (avoid allocation).
   std::vector<int> results;
@@ -90,11 +93,13 @@ GAL_FUNC(meshSphereQuery,  // NOLINT
   numFaces   = int32_t(results.size());
 }
 
-GAL_FUNC(subTriMesh,  // NOLINT
-         "Gets a mesh with the subset of the faces of the input mesh",
-         ((gal::TriMesh, mesh, "Input mesh"),
-          ((data::ReadView<int32_t, 1>), indices, "Faces to copy into the output mesh")),
-         ((gal::TriMesh, resultMesh, "Resulting mesh with the subset of faces")))
+GAL_PURE_FUNC(subTriMesh,  // NOLINT
+              "Gets a mesh with the subset of the faces of the input mesh",
+              ((gal::TriMesh, mesh, "Input mesh"),
+               ((data::ReadView<int32_t, 1>),
+                indices,
+                "Faces to copy into the output mesh")),
+              ((gal::TriMesh, resultMesh, "Resulting mesh with the subset of faces")))
 {
   resultMesh = mesh.subMesh(std::span<const int32_t>(indices.data(), indices.size()));
 }
@@ -108,12 +113,12 @@ GAL_FUNC(subPolyMesh,  // NOLINT
   resultMesh = mesh.subMesh(std::span<const int32_t>(indices.data(), indices.size()));
 }
 
-GAL_FUNC(closestPoints,  // NOLINT
-         "Creates the result point cloud by closest-point-querying the mesh with "
-         "the given point cloud",
-         ((gal::TriMesh, mesh, "Mesh"),
-          ((data::ReadView<glm::vec3, 1>), inCloud, "Query point cloud")),
-         (((data::WriteView<glm::vec3, 1>), outCloud, "Result point cloud")))
+GAL_PURE_FUNC(closestPoints,  // NOLINT
+              "Creates the result point cloud by closest-point-querying the mesh with "
+              "the given point cloud",
+              ((gal::TriMesh, mesh, "Mesh"),
+               ((data::ReadView<glm::vec3, 1>), inCloud, "Query point cloud")),
+              (((data::WriteView<glm::vec3, 1>), outCloud, "Result point cloud")))
 {
   mesh.updateRTrees();
   outCloud.resize(inCloud.size());
@@ -240,11 +245,12 @@ GAL_FUNC(vertexColors,  // NOLINT
                  [&](gal::VertH vh) { return mesh.color(vh); });
 }
 
-GAL_FUNC(decimate,  // NOLINT
-         "Decimates the mesh while persisting the intermediate meshes",
-         ((gal::TriMesh, mesh, "Mesh to be decimated"),
-          (int32_t, nCollapses, "Number of edges to collapse.")),
-         ((gal::TriMesh, decimated, "The decimated mesh")))
+GAL_CACHED_FUNC(decimate,  // NOLINT
+                1,
+                "Decimates the mesh while persisting the intermediate meshes",
+                ((gal::TriMesh, mesh, "Mesh to be decimated"),
+                 (int32_t, nCollapses, "Number of edges to collapse.")),
+                ((gal::TriMesh, decimated, "The decimated mesh")))
 {
   decimated = gal::decimate(mesh, nCollapses);
 }
@@ -259,6 +265,56 @@ GAL_FUNC(translate,  // NOLINT
   translated.transform(glm::translate(shift));
 }
 
+static void copySamples(const gal::MeshSamples&        samples,
+                        gal::PointCloud<3>&            cloud,
+                        data::WriteView<int32_t, 1>&   faces,
+                        data::WriteView<glm::vec3, 1>& barycentrics)
+{
+  cloud = samples.points;
+  faces.resize(samples.size());
+  barycentrics.resize(samples.size());
+  if (samples.size() > 0) {
+    std::copy(samples.faces.begin(), samples.faces.end(), &faces[0]);
+    std::copy(samples.barycentrics.begin(), samples.barycentrics.end(), &barycentrics[0]);
+  }
+}
+
+GAL_PURE_FUNC(sampleSurface,  // NOLINT
+              "Samples points uniformly on the surface of the mesh. The samples are "
+              "deterministic for a given seed",
+              ((gal::TriMesh, mesh, "The mesh"),
+               (int32_t, numPoints, "Number of points to sample"),
+               (int32_t, seed, "Seed for the random number generator")),
+              ((gal::PointCloud<3>, cloud, "Sampled points"),
+               ((data::WriteView<int32_t, 1>), faces, "Face containing each point"),
+               ((data::WriteView<glm::vec3, 1>),
+                barycentrics,
+                "Barycentric coordinates of each point in its face")))
+{
+  copySamples(gal::sampleSurface(mesh, size_t(std::max(numPoints, 0)), uint32_t(seed)),
+              cloud,
+              faces,
+              barycentrics);
+}
+
+GAL_CACHED_FUNC(samplePoissonDisk,  // NOLINT
+                1,
+                "Samples points on the surface of the mesh, such that no two points are "
+                "closer than the given radius. The samples are deterministic for a given "
+                "seed",
+                ((gal::TriMesh, mesh, "The mesh"),
+                 (float, radius, "Minimum distance between the points"),
+                 (int32_t, seed, "Seed for the random number generator")),
+                ((gal::PointCloud<3>, cloud, "Sampled points"),
+                 ((data::WriteView<int32_t, 1>), faces, "Face containing each point"),
+                 ((data::WriteView<glm::vec3, 1>),
+                  barycentrics,
+                  "Barycentric coordinates of each point in its face")))
+{
+  copySamples(
+    gal::samplePoissonDisk(mesh, radius, uint32_t(seed)), cloud, faces, barycentrics);
+}
+
 void bind_MeshFunc(py::module& module)
 {
   GAL_FN_BIND(centroid, module);
@@ -284,6 +340,8 @@ void bind_MeshFunc(py::module& module)
   GAL_FN_BIND(vertexColors, module);
   GAL_FN_BIND(decimate, module);
   GAL_FN_BIND(translate, module);
+  GAL_FN_BIND(sampleSurface, module);
+  GAL_FN_BIND(samplePoissonDisk, module);
 }
 
 }  // namespace func
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <mutex>
+
+#include <Functions.h>
+#include <Profiler.h>
+
+namespace gal {
+namespace func {
+namespace profile {
+
+static std::mutex sMutex;  // NOLINT
+
+void setEnabled(bool flag)
+{
+  Session::current().setProfiling(flag);
+}
+
+bool enabled()
+{
+  return Session::current().profiling();
+}
+
+void reset()
+{
+  std::lock_guard  lock(sMutex);
+  Property<Stats>& prop = Session::current().profileStats();
+  for (size_t i = 0; i < prop.size(); i++) {
+    prop[i] = Stats {};
+  }
+}
+
+void record(const Function& fn,
+            Duration        time,
+            uint64_t        nCombinations,
+            uint64_t        nElements,
+            uint64_t        nBytes)
+{
+  std::lock_guard  lock(sMutex);
+  Property<Stats>& prop = fn.session().profileStats();
+  // Functions that are not managed by a session don't have an index.
+  if (fn.index() < 0 || size_t(fn.index()) >= prop.size()) {
+    return;
+  }
+  Stats& dst = prop[fn.index()];
+  dst.mNumRuns++;
+  dst.mNumCombinations += nCombinations;
+  dst.mTotalTime += time;
+  dst.mLastTime    = time;
+  dst.mNumElements = nElements;
+  dst.mNumBytes    = nBytes;
+}
+
+std::vector<Record> records()
+{
+  std::vector<Record> dst;
+  {
+    std::lock_guard  lock(sMutex);
+    Session&         session = Session::current();
+    Property<Stats>& prop    = session.profileStats();
+    size_t           n       = std::min(prop.size(), session.numFunctions());
+    for (size_t i = 0; i < n; i++) {
+      if (prop[i].mNumRuns > 0) {
+        dst.push_back({&session.function(i), prop[i]});
+      }
+    }
+  }
+  std::sort(dst.begin(), dst.end(), [](const Record& a, const Record& b) {
+    return a.mStats.mTotalTime > b.mStats.mTotalTime;
+  });
+  return dst;
+}
+
+}  // namespace profile
+}  // namespace func
+}  // namespace gal
@@ -21,6 +21,13 @@ void Properties::remove(int i)
   }
 }
 
+void Properties::replace(int i, IProperty* ptr)
+{
+  if (i > -1 && i < mProps.size()) {
+    mProps[i] = ptr;
+  }
+}
+
 void Properties::clear()
 {
   for (auto p : mProps) {
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
+#include <tbb/parallel_for.h>
+
+#include <Box.h>
+#include <Functions.h>
+#include <Reduce.h>
+#include <TypeManager.h>
+
+namespace gal {
+namespace func {
+
+namespace reducefunc {  // Namespace to avoid linker confusion.
+
+/**
+ * @brief Reduces each branch of the source tree at the given depth to a single value, in
+ * parallel across the branches. Depth 1 reduces each innermost list, and depth 0 reduces
+ * the whole tree. The reduced values keep the structure of the tree above the depth of
+ * the branches.
+ *
+ * @param src The source tree.
+ * @param depth The depth of the branches.
+ * @param dst The tree of the reduced values.
+ * @param fn Reduces the span of values of a branch to a single value.
+ */
+template<typename T, typename TOut, typename TFn>
+void reduceBranches(const data::Tree<T>& src,
+                    int32_t              depth,
+                    data::Tree<TOut>&    dst,
+                    const TFn&           fn)
+{
+  if (depth < 0) {
+    throw std::invalid_argument("The depth of the branches cannot be negative");
+  }
+  if (src.empty()) {
+    return;
+  }
+  // Branches deeper than the tree contain the whole tree.
+  int32_t maxDepth = int32_t(src.maxDepth()) + 1;
+  auto    d        = data::DepthT(depth == 0 ? maxDepth : std::min(depth, maxDepth));
+  // Start of each branch, followed by the end of the last branch.
+  std::vector<size_t> starts;
+  for (size_t i = 0; i < src.size(); i += src.stride(i, d)) {
+    starts.push_back(i);
+  }
+  starts.push_back(src.size());
+  std::vector<TOut> results(starts.size() - 1);
+  const auto&       values = src.values();
+  tbb::parallel_for(size_t(0), results.size(), [&](size_t b) {
+    results[b] =
+      fn(std::span<const T>(values.data() + starts[b], starts[b + 1] - starts[b]));
+  });
+  dst.reserve(results.size());
+  for (size_t b = 0; b < results.size(); b++) {
+    dst.push_back(data::DepthT(std::max(int32_t(src.depth(starts[b])) - int32_t(d), 0)),
+                  results[b]);
+  }
+}
+
+}  // namespace reducefunc
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       branchSum,
+                       "Sums the values in each branch of the tree at the given depth",
+                       ((data::Tree<T>, tree, "Tree to be summed"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<T>, sums, "Sum of each branch")))
+{
+  reducefunc::reduceBranches(
+    tree, depth, sums, [](std::span<const T> values) { return utils::sum(values); });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       branchMin,
+                       "Gets the smallest value in each branch of the tree at the given "
+                       "depth",
+                       ((data::Tree<T>, tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<T>, mins, "Smallest value of each branch")))
+{
+  reducefunc::reduceBranches(tree, depth, mins, [](std::span<const T> values) {
+    return values[utils::argmin(values)];
+  });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       branchMax,
+                       "Gets the largest value in each branch of the tree at the given "
+                       "depth",
+                       ((data::Tree<T>, tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<T>, maxs, "Largest value of each branch")))
+{
+  reducefunc::reduceBranches(tree, depth, maxs, [](std::span<const T> values) {
+    return values[utils::argmax(values)];
+  });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       branchArgMin,
+                       "Gets the index of the smallest value in each branch of the tree "
+                       "at the given depth. The index is counted from the start of the "
+                       "branch",
+                       ((data::Tree<T>, tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<int32_t>, indices, "Index of the smallest value")))
+{
+  reducefunc::reduceBranches(tree, depth, indices, [](std::span<const T> values) {
+    return int32_t(utils::argmin(values));
+  });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       branchArgMax,
+                       "Gets the index of the largest value in each branch of the tree "
+                       "at the given depth. The index is counted from the start of the "
+                       "branch",
+                       ((data::Tree<T>, tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<int32_t>, indices, "Index of the largest value")))
+{
+  reducefunc::reduceBranches(tree, depth, indices, [](std::span<const T> values) {
+    return int32_t(utils::argmax(values));
+  });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T), (typename, TMean)),  // NOLINT
+                       branchMean,
+                       "Gets the mean of the values in each branch of the tree at the "
+                       "given depth",
+                       ((data::Tree<T>, tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<TMean>, means, "Mean of each branch")))
+{
+  reducefunc::reduceBranches(tree, depth, means, [](std::span<const T> values) {
+    return utils::mean<T, TMean>(values);
+  });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       branchVariance,
+                       "Gets the population variance of the values in each branch of the "
+                       "tree at the given depth",
+                       ((data::Tree<T>, tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<float>, variances, "Variance of each branch")))
+{
+  reducefunc::reduceBranches(tree, depth, variances, [](std::span<const T> values) {
+    return utils::variance(values);
+  });
+}
+
+GAL_PURE_FUNC_TEMPLATE(((int, Dim)),  // NOLINT
+                       branchBounds,
+                       "Gets the bounding box of the vectors in each branch of the tree "
+                       "at the given depth",
+                       (((data::Tree<glm::vec<Dim, float>>), tree, "Source tree"),
+                        (int32_t,
+                         depth,
+                         "Depth of the branches. Zero reduces the whole tree")),
+                       ((data::Tree<Box<Dim>>, boxes, "Bounding box of each branch")))
+{
+  reducefunc::reduceBranches(
+    tree, depth, boxes, [](std::span<const glm::vec<Dim, float>> points) {
+      return Box<Dim>(points);
+    });
+}
+
+void bind_ReduceFunc(py::module& mod)
+{
+  GAL_FN_BIND_TEMPLATE(branchSum, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(branchSum, mod, float);
+  GAL_FN_BIND_TEMPLATE(branchSum, mod, glm::vec2);
+  GAL_FN_BIND_TEMPLATE(branchSum, mod, glm::vec3);
+  GAL_FN_BIND_TEMPLATE(branchMin, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(branchMin, mod, float);
+  GAL_FN_BIND_TEMPLATE(branchMax, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(branchMax, mod, float);
+  GAL_FN_BIND_TEMPLATE(branchArgMin, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(branchArgMin, mod, float);
+  GAL_FN_BIND_TEMPLATE(branchArgMax, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(branchArgMax, mod, float);
+  GAL_FN_BIND_TEMPLATE(branchMean, mod, int32_t, float);
+  GAL_FN_BIND_TEMPLATE(branchMean, mod, float, float);
+  GAL_FN_BIND_TEMPLATE(branchMean, mod, glm::vec2, glm::vec2);
+  GAL_FN_BIND_TEMPLATE(branchMean, mod, glm::vec3, glm::vec3);
+  GAL_FN_BIND_TEMPLATE(branchVariance, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(branchVariance, mod, float);
+  GAL_FN_BIND_TEMPLATE(branchBounds, mod, 2);
+  GAL_FN_BIND_TEMPLATE(branchBounds, mod, 3);
+}
+
+}  // namespace func
+}  // namespace gal
@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <Functions.h>
+#include <ResultCache.h>
+
+namespace gal {
+namespace func {
+namespace cache {
+
+static constexpr std::string_view Extension = ".galcache";
+static constexpr uint32_t         Magic     = 0x636c6167;  // "galc"
+// Entries written in an older format are discarded.
+static constexpr uint32_t FormatVersion = 1;
+
+static std::atomic<bool>     sEnabled     = false;  // NOLINT
+static std::atomic<uint64_t> sTempCounter = 0;      // NOLINT
+
+static uint64_t rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+// Finalizer from MurmurHash3, so that every bit of the input affects every bit of the
+// output.
+static uint64_t fmix(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccd;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53;
+  k ^= k >> 33;
+  return k;
+}
+
+std::string Key::str() const
+{
+  static constexpr std::string_view sDigits = "0123456789abcdef";
+  std::string                       str;
+  str.reserve(32);
+  for (uint64_t h : mHash) {
+    for (int shift = 60; shift >= 0; shift -= 4) {
+      str.push_back(sDigits[(h >> shift) & 0xf]);
+    }
+  }
+  return str;
+}
+
+void Hasher::mix(uint64_t word)
+{
+  mLanes[0] ^= rotl(word * 0x87c37b91114253d5, 31) * 0x4cf5ad432745937f;
+  mLanes[0] = rotl(mLanes[0], 27) * 5 + 0x52dce729;
+  mLanes[1] ^= rotl(word * 0x4cf5ad432745937f, 33) * 0x87c37b91114253d5;
+  mLanes[1] = rotl(mLanes[1], 31) * 5 + 0x38495ab5;
+}
+
+Hasher& Hasher::add(const char* data, size_t nBytes)
+{
+  // Bytes are packed into little endian words, so the key doesn't depend on how the
+  // bytes are split between calls.
+  auto addByte = [this](char b) {
+    mWord |= uint64_t(uint8_t(b)) << (8 * (mLength++ % 8));
+    if (mLength % 8 == 0) {
+      mix(mWord);
+      mWord = 0;
+    }
+  };
+  size_t i = 0;
+  for (; i < nBytes && mLength % 8 != 0; i++) {
+    addByte(data[i]);
+  }
+  for (; i + 8 <= nBytes; i += 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, data + i, sizeof(word));
+    mix(word);
+    mLength += 8;
+  }
+  for (; i < nBytes; i++) {
+    addByte(data[i]);
+  }
+  return *this;
+}
+
+Hasher& Hasher::add(const Bytes& bytes)
+{
+  // The size separates consecutive fields, so that moving bytes from one field to the
+  // next changes the key.
+  add(uint64_t(bytes.size()));
+  return add(bytes.data(), bytes.size());
+}
+
+Hasher& Hasher::add(std::string_view str)
+{
+  add(uint64_t(str.size()));
+  return add(str.data(), str.size());
+}
+
+Key Hasher::key() const
+{
+  Hasher h = *this;
+  if (h.mLength % 8 != 0) {
+    h.mix(h.mWord);
+  }
+  uint64_t a = h.mLanes[0] ^ mLength;
+  uint64_t b = h.mLanes[1] ^ mLength;
+  a += b;
+  b += a;
+  a = fmix(a);
+  b = fmix(b);
+  a += b;
+  b += a;
+  return {{a, b}};
+}
+
+struct Entry
+{
+  std::string mName;
+  uint64_t    mSize;
+};
+
+/**
+ * @brief Entries in the cache directory, ordered from the least recently used to the
+ * most recently used.
+ */
+struct Index
+{
+  using EntryList = std::list<Entry>;
+
+  std::mutex                                           mMutex;
+  fs::path                                             mDir;
+  uint64_t                                             mMaxBytes   = DefaultMaxBytes;
+  uint64_t                                             mTotalBytes = 0;
+  EntryList                                            mEntries;
+  std::unordered_map<std::string, EntryList::iterator> mLookup;
+
+  fs::path path(const std::string& name) const
+  {
+    return mDir / (name + std::string(Extension));
+  }
+
+  void reset()
+  {
+    mEntries.clear();
+    mLookup.clear();
+    mTotalBytes = 0;
+  }
+
+  void insert(const std::string& name, uint64_t size)
+  {
+    auto match = mLookup.find(name);
+    if (match != mLookup.end()) {
+      mTotalBytes -= match->second->mSize;
+      mEntries.erase(match->second);
+    }
+    mTotalBytes += size;
+    mLookup[name] = mEntries.insert(mEntries.end(), Entry {name, size});
+  }
+
+  void erase(const std::string& name, bool deleteFile)
+  {
+    auto match = mLookup.find(name);
+    if (match == mLookup.end()) {
+      return;
+    }
+    if (deleteFile) {
+      std::error_code err;
+      fs::remove(path(name), err);
+    }
+    mTotalBytes -= match->second->mSize;
+    mEntries.erase(match->second);
+    mLookup.erase(match);
+  }
+
+  void evict()
+  {
+    while (mTotalBytes > mMaxBytes && !mEntries.empty()) {
+      erase(std::string(mEntries.front().mName), true);
+    }
+  }
+};
+
+static Index& entries()
+{
+  static Index sIndex;
+  return sIndex;
+}
+
+void setDirectory(const fs::path& dir, uint64_t maxBytes)
+{
+  fs::create_directories(dir);
+  std::vector<std::pair<fs::file_time_type, Entry>> found;
+  for (const auto& item : fs::directory_iterator(dir)) {
+    if (item.is_regular_file() && item.path().extension() == Extension) {
+      found.emplace_back(item.last_write_time(),
+                         Entry {item.path().stem().string(), item.file_size()});
+    }
+  }
+  // The modification time of an entry is updated every time it is used.
+  std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
+  Index&          idx = entries();
+  std::lock_guard lock(idx.mMutex);
+  idx.reset();
+  idx.mDir      = dir;
+  idx.mMaxBytes = maxBytes;
+  for (const auto& [time, entry] : found) {
+    idx.insert(entry.mName, entry.mSize);
+  }
+  idx.evict();
+  sEnabled = true;
+  logger().info("Caching function results in '{}' ({} entries, {} bytes)",
+                dir.string(),
+                idx.mEntries.size(),
+                idx.mTotalBytes);
+}
+
+void disable()
+{
+  sEnabled = false;
+}
+
+bool enabled()
+{
+  return sEnabled;
+}
+
+void clear()
+{
+  Index&          idx = entries();
+  std::lock_guard lock(idx.mMutex);
+  for (const Entry& entry : idx.mEntries) {
+    std::error_code err;
+    fs::remove(idx.path(entry.mName), err);
+  }
+  idx.reset();
+}
+
+bool load(const Key& key, Bytes& dst)
+{
+  if (!enabled()) {
+    return false;
+  }
+  Index&      idx  = entries();
+  std::string name = key.str();
+  fs::path    path;
+  {
+    std::lock_guard lock(idx.mMutex);
+    auto            match = idx.mLookup.find(name);
+    if (match == idx.mLookup.end()) {
+      return false;
+    }
+    idx.mEntries.splice(idx.mEntries.end(), idx.mEntries, match->second);
+    path = idx.path(name);
+  }
+  try {
+    Bytes    file    = Bytes::loadFromFile(path);
+    uint32_t magic   = 0;
+    uint32_t version = 0;
+    Key      stored;
+    file >> magic >> version >> stored.mHash[0] >> stored.mHash[1];
+    if (magic != Magic || version != FormatVersion || stored != key) {
+      throw std::runtime_error("Invalid header");
+    }
+    file.readNested(dst);
+  }
+  catch (const std::exception& e) {
+    logger().warn("Discarding the cache entry {}: {}", name, e.what());
+    std::lock_guard lock(idx.mMutex);
+    idx.erase(name, true);
+    return false;
+  }
+  std::error_code err;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), err);
+  return true;
+}
+
+void store(const Key& key, const Bytes& src)
+{
+  if (!enabled()) {
+    return;
+  }
+  Index&      idx  = entries();
+  std::string name = key.str();
+  fs::path    path;
+  fs::path    temp;
+  {
+    std::lock_guard lock(idx.mMutex);
+    if (src.size() > idx.mMaxBytes) {
+      return;
+    }
+    path = idx.path(name);
+    temp = idx.mDir / (name + "." + std::to_string(sTempCounter++) + ".tmp");
+  }
+  Bytes file;
+  file << Magic << FormatVersion << key.mHash[0] << key.mHash[1];
+  file.writeNested(src);
+  // The entry is written to a temporary file first, so that a concurrent or interrupted
+  // write never leaves a partial entry behind.
+  file.saveToFile(temp);
+  std::error_code err;
+  uint64_t        size = fs::file_size(temp, err);
+  if (!err && size == file.size()) {
+    fs::rename(temp, path, err);
+  }
+  else if (!err) {
+    err = std::make_error_code(std::errc::io_error);
+  }
+  if (err) {
+    logger().warn("Unable to write the cache entry {}: {}", name, err.message());
+    fs::remove(temp, err);
+    return;
+  }
+  std::lock_guard lock(idx.mMutex);
+  idx.insert(name, size);
+  idx.evict();
+}
+
+Key fileKey(std::string_view name, uint32_t version, const fs::path& path)
+{
+  Hasher hasher;
+  hasher.add(name)
+    .add(version)
+    .add(std::string_view(fs::absolute(path).string()))
+    .add(uint64_t(fs::file_size(path)))
+    .add(int64_t(fs::last_write_time(path).time_since_epoch().count()));
+  return hasher.key();
+}
+
+}  // namespace cache
+}  // namespace func
+}  // namespace gal
@@ -0,0 +1,214 @@
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <Functions.h>
+
+namespace gal {
+namespace func {
+
+static std::atomic<uint64_t> sLeafVersion = 1;  // NOLINT
+
+uint64_t newLeafVersions(size_t n)
+{
+  return sLeafVersion.fetch_add(n);
+}
+
+// Shared by all sessions, so sessions evaluated concurrently share the worker threads,
+// instead of oversubscribing the cores.
+static tbb::task_arena& arena()
+{
+  static tbb::task_arena sArena;
+  return sArena;
+}
+
+/**
+ * @brief The expired functions upstream of a set of target functions, sorted
+ * topologically, i.e. every function appears after all of its inputs.
+ */
+struct ExpiredGraph
+{
+  static constexpr size_t NoChain = SIZE_MAX;
+
+  std::vector<const Function*>     mNodes;
+  std::vector<std::vector<size_t>> mSuccessors;
+  std::vector<size_t>              mNumPredecessors;
+  std::vector<FusedChain>          mChains;
+  // Index of the chain that ends with each node, if any.
+  std::vector<size_t> mChainIndices;
+  // Nodes that are run as part of the chain of a node downstream of them.
+  std::vector<bool> mIsFused;
+
+  explicit ExpiredGraph(std::span<const Function* const> targets)
+  {
+    // A function that is not expired never has expired functions upstream of it, so the
+    // search stops at the first function that is up to date.
+    std::unordered_map<const Function*, size_t>   indices;
+    std::unordered_set<const Function*>           visited;
+    std::vector<std::pair<const Function*, bool>> stack;
+    std::vector<InputInfo>                        inputs;
+    for (auto it = targets.rbegin(); it != targets.rend(); it++) {
+      if ((*it)->isExpired()) {
+        stack.emplace_back(*it, false);
+      }
+    }
+    // Iterative depth first search. Visiting the inputs in order produces the same order
+    // as recursively updating the inputs of each function.
+    while (!stack.empty()) {
+      auto [fn, expanded] = stack.back();
+      stack.pop_back();
+      if (expanded) {
+        indices.emplace(fn, mNodes.size());
+        mNodes.push_back(fn);
+        continue;
+      }
+      if (!visited.insert(fn).second) {
+        continue;
+      }
+      stack.emplace_back(fn, true);
+      fn->getInputs(inputs);
+      for (auto it = inputs.rbegin(); it != inputs.rend(); it++) {
+        if (it->mFunc->isExpired() && !visited.contains(it->mFunc)) {
+          stack.emplace_back(it->mFunc, false);
+        }
+      }
+    }
+    mSuccessors.resize(mNodes.size());
+    mNumPredecessors.resize(mNodes.size(), 0);
+    std::vector<size_t> preds;
+    for (size_t i = 0; i < mNodes.size(); i++) {
+      mNodes[i]->getInputs(inputs);
+      preds.clear();
+      for (const auto& input : inputs) {
+        auto match = indices.find(input.mFunc);
+        if (match != indices.end()) {
+          preds.push_back(match->second);
+        }
+      }
+      // A function can use more than one output of the same upstream function.
+      std::sort(preds.begin(), preds.end());
+      preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+      for (size_t p : preds) {
+        mSuccessors[p].push_back(i);
+      }
+      mNumPredecessors[i] = preds.size();
+    }
+    fuse(targets);
+  }
+
+  /**
+   * @brief Fuses every elementwise function whose outputs are only read by one
+   * elementwise function downstream, into the chain of that function. Targets are never
+   * fused, because their outputs are needed.
+   */
+  void fuse(std::span<const Function* const> targets)
+  {
+    size_t                              n = mNodes.size();
+    std::unordered_set<const Function*> isTarget(targets.begin(), targets.end());
+    std::vector<size_t>                 fusedInto(n, NoChain);
+    for (size_t i = 0; i < n; i++) {
+      if (mSuccessors[i].size() == 1 && mNodes[i]->isElementwise() &&
+          mNodes[mSuccessors[i].front()]->isElementwise() &&
+          !isTarget.contains(mNodes[i])) {
+        fusedInto[i] = mSuccessors[i].front();
+      }
+    }
+    mIsFused.resize(n, false);
+    mChainIndices.resize(n, NoChain);
+    std::vector<std::vector<const Function*>> members(n);
+    // The nodes are sorted topologically, so the members of a chain are found in order.
+    for (size_t i = 0; i < n; i++) {
+      if (fusedInto[i] == NoChain) {
+        continue;
+      }
+      mIsFused[i] = true;
+      size_t last = fusedInto[i];
+      while (fusedInto[last] != NoChain) {
+        last = fusedInto[last];
+      }
+      members[last].push_back(mNodes[i]);
+    }
+    for (size_t i = 0; i < n; i++) {
+      if (!members[i].empty()) {
+        members[i].push_back(mNodes[i]);
+        mChainIndices[i] = mChains.size();
+        mChains.emplace_back(std::move(members[i]));
+      }
+    }
+  }
+
+  static bool isCancelled(const std::atomic<bool>* cancel)
+  {
+    return cancel && cancel->load(std::memory_order_relaxed);
+  }
+
+  void runNode(size_t i)
+  {
+    if (mIsFused[i]) {
+      // Run by the last node of its chain.
+      return;
+    }
+    else if (mChainIndices[i] != NoChain) {
+      mChains[mChainIndices[i]].update();
+    }
+    else {
+      mNodes[i]->updateLocal();
+    }
+  }
+
+  void runSerial(const std::atomic<bool>* cancel)
+  {
+    for (size_t i = 0; i < mNodes.size() && !isCancelled(cancel); i++) {
+      runNode(i);
+    }
+  }
+
+  void runParallel(const std::atomic<bool>* cancel)
+  {
+    std::vector<std::atomic<size_t>> pending(mNodes.size());
+    for (size_t i = 0; i < mNodes.size(); i++) {
+      pending[i] = mNumPredecessors[i];
+    }
+    tbb::task_group              group;
+    std::function<void(size_t)> runTask = [&](size_t i) {
+      // The successors of the skipped functions are never scheduled.
+      if (isCancelled(cancel)) {
+        return;
+      }
+      runNode(i);
+      for (size_t s : mSuccessors[i]) {
+        if (--pending[s] == 0) {
+          group.run([&runTask, s]() { runTask(s); });
+        }
+      }
+    };
+    arena().execute([&]() {
+      for (size_t i = 0; i < mNodes.size(); i++) {
+        if (mNumPredecessors[i] == 0) {
+          group.run([&runTask, i]() { runTask(i); });
+        }
+      }
+      // Rethrows the first exception thrown by any of the functions. The functions
+      // downstream of a failed function are never run, and stay expired.
+      group.wait();
+    });
+  }
+};
+
+void evaluate(std::span<const Function* const> targets, const std::atomic<bool>* cancel)
+{
+  ExpiredGraph graph(targets);
+  if (graph.mNodes.size() < 2 || !graph.mNodes.front()->session().parallelEvaluation()) {
+    graph.runSerial(cancel);
+  }
+  else {
+    graph.runParallel(cancel);
+  }
+}
+
+}  // namespace func
+}  // namespace gal
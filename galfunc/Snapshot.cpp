@@ -0,0 +1,181 @@
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Functions.h>
+
+namespace gal {
+namespace func {
+namespace snapshot {
+
+static constexpr uint32_t Magic = 0x736c6167;  // "gals"
+// Snapshots written in an older format cannot be loaded.
+static constexpr uint32_t FormatVersion = 1;
+
+struct TypeEntry
+{
+  FuncInfo              mInfo;
+  const std::type_info* mType = nullptr;
+  // Null if another type has the same id, so neither can be restored.
+  Factory mFactory = nullptr;
+};
+
+static std::mutex sMutex;  // NOLINT
+
+static std::unordered_map<uint64_t, TypeEntry>& types()
+{
+  static std::unordered_map<uint64_t, TypeEntry> sTypes;
+  return sTypes;
+}
+
+void registerType(uint64_t              typeId,
+                  const FuncInfo&       info,
+                  const std::type_info& type,
+                  Factory               factory)
+{
+  std::lock_guard lock(sMutex);
+  auto [match, inserted] = types().emplace(typeId, TypeEntry {info, &type, factory});
+  if (!inserted && *(match->second.mType) != type) {
+    logger().warn("Function {} has the same type id as {}. Neither can be restored from "
+                  "snapshots.",
+                  info.mName,
+                  match->second.mInfo.mName);
+    match->second.mFactory = nullptr;
+  }
+}
+
+static TypeEntry findType(uint64_t typeId, std::string_view name)
+{
+  std::lock_guard lock(sMutex);
+  auto            match = types().find(typeId);
+  if (match == types().end() || !match->second.mFactory) {
+    throw std::runtime_error("The type of the function " + std::string(name) +
+                             " is not registered for snapshots");
+  }
+  return match->second;
+}
+
+Bytes save(bool withOutputs)
+{
+  const Session& session = Session::current();
+  size_t         n       = session.numFunctions();
+  if (withOutputs) {
+    std::vector<const Function*> targets(n);
+    for (size_t i = 0; i < n; i++) {
+      targets[i] = &session.function(i);
+    }
+    try {
+      evaluate(targets);
+    }
+    catch (const std::exception& e) {
+      // The outputs of the functions that are up to date are still saved.
+      logger().warn("Unable to evaluate the graph before saving the snapshot: {}",
+                    e.what());
+    }
+  }
+  Bytes bytes;
+  bytes << Magic << FormatVersion << uint64_t(n);
+  std::vector<InputInfo> inputs;
+  for (size_t i = 0; i < n; i++) {
+    const Function& fn   = session.function(i);
+    uint64_t        id   = fn.typeId();
+    std::string     name = std::string(fn.info().mName);
+    if (*(findType(id, name).mType) != typeid(fn)) {
+      throw std::runtime_error("The function " + name +
+                               " is not an instance of its registered type");
+    }
+    fn.getInputs(inputs);
+    bytes << id << name << uint64_t(inputs.size());
+    for (const InputInfo& input : inputs) {
+      // Functions are always created after their inputs.
+      if (&(input.mFunc->session()) != &session || input.mFunc->index() >= int(i)) {
+        throw std::logic_error("An input of the function " + name +
+                               " is not an earlier function of the session");
+      }
+      bytes << uint64_t(input.mFunc->index()) << uint64_t(input.mOutputIdx);
+    }
+    // The outputs of variables are their values, which are always saved.
+    bool  isVariable = inputs.empty();
+    Bytes outputs;
+    bool  hasOutputs =
+      (isVariable || (withOutputs && !fn.isExpired())) && fn.saveOutputs(outputs);
+    if (isVariable && !hasOutputs) {
+      throw std::runtime_error("The value of the variable " + name +
+                               " cannot be serialized");
+    }
+    bytes << uint8_t(hasOutputs);
+    if (hasOutputs) {
+      bytes.writeNested(std::move(outputs));
+    }
+  }
+  return bytes;
+}
+
+void saveToFile(const fs::path& path, bool withOutputs)
+{
+  save(withOutputs).saveToFile(path);
+}
+
+void load(Bytes& bytes)
+{
+  uint32_t magic   = 0;
+  uint32_t version = 0;
+  bytes >> magic >> version;
+  if (magic != Magic) {
+    throw std::runtime_error("The bytes are not a snapshot of a function graph");
+  }
+  if (version != FormatVersion) {
+    throw std::runtime_error("Snapshot format version " + std::to_string(version) +
+                             " is not supported");
+  }
+  uint64_t n = 0;
+  bytes >> n;
+  // The functions are added to the session only after all of them are restored.
+  std::vector<std::unique_ptr<Function>> functions;
+  std::vector<InputInfo>                 inputs;
+  for (uint64_t i = 0; i < n; i++) {
+    uint64_t    id      = 0;
+    std::string name;
+    uint64_t    nInputs = 0;
+    bytes >> id >> name >> nInputs;
+    TypeEntry entry = findType(id, name);
+    inputs.clear();
+    for (uint64_t j = 0; j < nInputs; j++) {
+      uint64_t src    = 0;
+      uint64_t output = 0;
+      bytes >> src >> output;
+      if (src >= i) {
+        throw std::runtime_error("An input of the function " + name +
+                                 " is not an earlier function of the snapshot");
+      }
+      inputs.emplace_back(functions[src].get(), int(output));
+    }
+    std::unique_ptr<Function> fn = entry.mFactory(inputs);
+    fn->info()                   = entry.mInfo;
+    uint8_t hasOutputs = 0;
+    bytes >> hasOutputs;
+    if (hasOutputs) {
+      Bytes outputs;
+      bytes.readNested(outputs);
+      fn->loadOutputs(outputs);
+    }
+    functions.push_back(std::move(fn));
+  }
+  Session& session = Session::current();
+  for (auto& fn : functions) {
+    FuncInfo info = fn->info();
+    session.addFunction(info, std::move(fn));
+  }
+}
+
+void loadFromFile(const fs::path& path)
+{
+  Bytes bytes = Bytes::loadFromFile(path);
+  load(bytes);
+}
+
+}  // namespace snapshot
+}  // namespace func
+}  // namespace gal
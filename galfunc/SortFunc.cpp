@@ -1,45 +1,100 @@
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
 #include <Functions.h>
+#include <Sort.h>
 #include <TypeManager.h>
 #include <Util.h>
 
 namespace gal {
 namespace func {
 
-GAL_FUNC_TEMPLATE(((typename, TVal), (typename, TKey)),  // NOLINT
-                  sort,
-                  "Sorts a list based on given keys.",
-                  (((data::ReadView<TVal, 1>), list, "List to be sorted"),
-                   ((data::ReadView<TKey, 1>), keys, "Keys to be used for sorting")),
-                  (((data::WriteView<TVal, 1>), sorted, "Sorted values")))
+namespace sortfunc {  // Namespace to avoid linker confusion.
+
+template<typename TVal, typename TKey>
+size_t checkedLength(const data::ReadView<TVal, 1>& list,
+                     const data::ReadView<TKey, 1>& keys)
 {
-  std::vector<size_t> indices(list.size());
-  std::iota(indices.begin(), indices.end(), size_t(0));
-  std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
-    return keys[a] < keys[b];
-  });
-  sorted.reserve(list.size());
-  std::transform(
-    indices.begin(), indices.end(), std::back_inserter(sorted), [&](size_t i) {
-      return list[i];
-    });
+  size_t n = list.size();
+  if (keys.size() != n) {
+    throw std::length_error("The number of keys must be the same as the number of "
+                            "items in the list");
+  }
+  return n;
 }
 
-namespace sortfunc {  // Namespace to avoid linker confusion.
+}  // namespace sortfunc
+
+GAL_PURE_FUNC_TEMPLATE(((typename, TVal), (typename, TKey)),  // NOLINT
+                       sort,
+                       "Sorts a list based on given keys. Items with equal keys keep "
+                       "their order.",
+                       (((data::ReadView<TVal, 1>), list, "List to be sorted"),
+                        ((data::ReadView<TKey, 1>), keys, "Keys to be used for sorting")),
+                       (((data::WriteView<TVal, 1>), sorted, "Sorted values")))
+{
+  size_t              n = sortfunc::checkedLength(list, keys);
+  std::vector<size_t> indices(n);
+  utils::argsort(std::span<const TKey>(keys.data(), n), std::span<size_t>(indices));
+  sorted.resize(n);
+  utils::gather(data::ListValues<TVal>(list), std::span<const size_t>(indices), sorted);
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, TKey)),  // NOLINT
+                       argsort,
+                       "Gets the indices that sort the given keys. Equal keys keep their "
+                       "order.",
+                       (((data::ReadView<TKey, 1>), keys, "Keys to be sorted")),
+                       (((data::WriteView<int32_t, 1>), indices, "Sorted indices")))
+{
+  size_t              n = keys.size();
+  std::vector<size_t> sortedIndices(n);
+  utils::argsort(std::span<const TKey>(keys.data(), n),
+                 std::span<size_t>(sortedIndices));
+  indices.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    indices[i] = int32_t(sortedIndices[i]);
+  }
+}
+
+GAL_PURE_FUNC_TEMPLATE(((typename, TVal), (typename, TKey)),  // NOLINT
+                       partialSort,
+                       "Gets the given number of items with the smallest keys, sorted by "
+                       "their keys.",
+                       (((data::ReadView<TVal, 1>), list, "List to be sorted"),
+                        ((data::ReadView<TKey, 1>), keys, "Keys to be used for sorting"),
+                        (int32_t, count, "Number of items to get")),
+                       (((data::WriteView<TVal, 1>), sorted, "Sorted values")))
+{
+  size_t              n = sortfunc::checkedLength(list, keys);
+  std::vector<size_t> indices(std::min(n, size_t(std::max(count, 0))));
+  utils::partialArgsort(std::span<const TKey>(keys.data(), n),
+                        std::span<size_t>(indices));
+  sorted.resize(indices.size());
+  utils::gather(data::ListValues<TVal>(list), std::span<const size_t>(indices), sorted);
+}
+
+namespace sortfunc {
 
 template<typename T>
 struct bindForAllTypes
 {
   static void invoke(py::module& mod)
   {
-    // Two overloads for the sort function with different key types.
+    // Two overloads for the sort functions with different key types.
     GAL_FN_BIND_TEMPLATE(sort, mod, T, int32_t);
     GAL_FN_BIND_TEMPLATE(sort, mod, T, float);
+    GAL_FN_BIND_TEMPLATE(partialSort, mod, T, int32_t);
+    GAL_FN_BIND_TEMPLATE(partialSort, mod, T, float);
   }
 };
 
 }  // namespace sortfunc
 void bind_SortFunc(py::module& mod)
 {
+  GAL_FN_BIND_TEMPLATE(argsort, mod, int32_t);
+  GAL_FN_BIND_TEMPLATE(argsort, mod, float);
   typemanager::invoke<sortfunc::bindForAllTypes>((py::module&)mod);
 }
 
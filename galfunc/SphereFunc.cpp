@@ -32,11 +32,51 @@ GAL_FUNC(bounds,
   bbox = s.bounds();
 }
 
+GAL_FUNC(sphereContains,
+         "Checks which of the given points are inside the sphere",
+         ((gal::Sphere, sphere, "The sphere"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points to test")),
+         (((data::WriteView<gal::Bool, 1>), results, "Whether each point is inside")))
+{
+  results.resize(points.size());
+  if (!points.empty()) {
+    sphere.contains(points.data(), points.size(), &results[0]);
+  }
+}
+
+GAL_FUNC(sphereSignedDistance,
+         "Signed distances of the points from the surface of the sphere. The distances "
+         "are negative inside the sphere",
+         ((gal::Sphere, sphere, "The sphere"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points")),
+         (((data::WriteView<float, 1>), distances, "Signed distances")))
+{
+  distances.resize(points.size());
+  if (!points.empty()) {
+    sphere.signedDistance(points.data(), points.size(), &distances[0]);
+  }
+}
+
+GAL_FUNC(sphereClosestPoints,
+         "Closest points on the surface of the sphere, to the given points",
+         ((gal::Sphere, sphere, "The sphere"),
+          ((data::ReadView<glm::vec3, 1>), points, "Points")),
+         (((data::WriteView<glm::vec3, 1>), closest, "Closest points")))
+{
+  closest.resize(points.size());
+  if (!points.empty()) {
+    sphere.closestPoints(points.data(), points.size(), &closest[0]);
+  }
+}
+
 void bind_SphereFunc(py::module& module)
 {
   GAL_FN_BIND(bounds, module);
   GAL_FN_BIND(sphere, module);
   GAL_FN_BIND(boundingSphere, module);
+  GAL_FN_BIND_OVERLOADS(module, contains, sphereContains);
+  GAL_FN_BIND_OVERLOADS(module, signedDistance, sphereSignedDistance);
+  GAL_FN_BIND_OVERLOADS(module, closestPoints, sphereClosestPoints);
 }
 
 }  // namespace func
@@ -1,17 +1,17 @@
 #include <Functions.h>
+#include <Reduce.h>
 #include <TypeManager.h>
 
 namespace gal {
 namespace func {
 
-GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
-                  treeSum,
-                  "Gets the sum of all elements in the tree",
-                  ((data::Tree<T>, tree, "Tree to be summed.")),
-                  ((T, sum, "Sum of all elements of the tree.")))
+GAL_PURE_FUNC_TEMPLATE(((typename, T)),  // NOLINT
+                       treeSum,
+                       "Gets the sum of all elements in the tree",
+                       ((data::Tree<T>, tree, "Tree to be summed.")),
+                       ((T, sum, "Sum of all elements of the tree.")))
 {
-  static constexpr T sZero = T(0);
-  sum = std::accumulate(tree.values().begin(), tree.values().end(), sZero);
+  sum = utils::sum(std::span<const T>(tree.values()));
 }
 
 GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
@@ -20,6 +20,7 @@ GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
                   ((data::Tree<T>, treeIn, "Input tree")),
                   ((data::Tree<T>, treeOut, "Grafted tree")))
 {
+  // The copy shares the values with the input, only the depths are copied.
   treeOut = treeIn;
   treeOut.graft();
 }
@@ -30,6 +31,7 @@ GAL_FUNC_TEMPLATE(((typename, T)),  // NOLINT
                   ((data::Tree<T>, in, "Input tree")),
                   ((data::Tree<T>, out, "Flattened tree")))
 {
+  // The copy shares the values with the input, only the depths are copied.
   out = in;
   out.flatten();
 }
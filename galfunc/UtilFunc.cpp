@@ -34,13 +34,31 @@ GAL_FUNC_TEMPLATE(  // NOLINT
    (int32_t, nc, "Number of items in each combination")),
   (((data::WriteView<T, 2>), combs, "Resulting combinations")))
 {
-  size_t n = items.size();
-  size_t k = size_t(nc);
-  combs.reserve(k * utils::numCombinations(items.size(), size_t(k)));
-  std::vector<T> temp(k);
-  utils::combinations(k, items.begin(), items.end(), temp.begin(), [&]() {
-    auto child = combs.child();
-    std::move(temp.begin(), temp.end(), std::back_inserter(child));
+  size_t n     = items.size();
+  size_t k     = size_t(nc);
+  size_t total = utils::numCombinations(n, k);
+  if (k == 0 || total == 0) {
+    return;
+  }
+  // Allocate the branches up front, so that the combinations can be written directly
+  // into their slots in parallel.
+  combs.reserve(k * total);
+  size_t offset = combs.treeValues().size();
+  for (size_t i = 0; i < total; i++) {
+    combs.child().resize(k);
+  }
+  // The values are taken once, so the workers only index into them.
+  auto& values = combs.treeValues();
+  utils::parallelCombinations(n, k, [&](size_t rank, const size_t* comb) {
+    size_t pos = offset + rank * k;
+    for (size_t i = 0; i < k; i++) {
+      if constexpr (data::Tree<T>::IsPolymorphic) {
+        *(values[pos + i]) = items[comb[i]];
+      }
+      else {
+        values[pos + i] = items[comb[i]];
+      }
+    }
   });
 }
 
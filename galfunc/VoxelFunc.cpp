@@ -0,0 +1,64 @@
+#include <Functions.h>
+
+namespace gal {
+namespace func {
+
+GAL_CACHED_FUNC(meshDistanceGrid,
+                1,
+                "Computes the signed distance field of the mesh on a regular grid. The "
+                "distances are negative inside the mesh",
+                ((gal::TriMesh, mesh, "Closed mesh"),
+                 (float, cellSize, "Distance between neighboring nodes of the grid"),
+                 (float, bandWidth, "Width of the narrow band around the surface"),
+                 (gal::Bool, sparse, "Only store the distances within the narrow band")),
+                ((gal::VoxelGrid, grid, "Signed distance grid")))
+{
+  grid = gal::VoxelGrid::fromMesh(mesh, cellSize, bandWidth, bool(sparse));
+}
+
+GAL_PURE_FUNC(gridSignedDistance,
+              "Samples the signed distances at the given points from the grid",
+              ((gal::VoxelGrid, grid, "Signed distance grid"),
+               ((data::ReadView<glm::vec3, 1>), points, "Points")),
+              (((data::WriteView<float, 1>), distances, "Signed distances")))
+{
+  distances.resize(points.size());
+  if (!points.empty()) {
+    grid.sample(points.data(), points.size(), &distances[0]);
+  }
+}
+
+GAL_PURE_FUNC(gridContains,
+              "Checks which of the given points are inside the surface of the grid",
+              ((gal::VoxelGrid, grid, "Signed distance grid"),
+               ((data::ReadView<glm::vec3, 1>), points, "Points to test")),
+              (((data::WriteView<gal::Bool, 1>),
+                results,
+                "Whether each point is inside")))
+{
+  results.resize(points.size());
+  utils::parallelFor(points.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      results[i] = gal::Bool(grid.contains(points[i]));
+    }
+  });
+}
+
+GAL_FUNC(bounds,
+         "Bounding box of the grid",
+         ((gal::VoxelGrid, grid, "Signed distance grid")),
+         ((gal::Box3, bbox, "Bounding box")))
+{
+  bbox = grid.bounds();
+}
+
+void bind_VoxelFunc(py::module& module)
+{
+  GAL_FN_BIND(meshDistanceGrid, module);
+  GAL_FN_BIND(bounds, module);
+  GAL_FN_BIND_OVERLOADS(module, signedDistance, gridSignedDistance);
+  GAL_FN_BIND_OVERLOADS(module, contains, gridContains);
+}
+
+}  // namespace func
+}  // namespace gal
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <type_traits>
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
 #include <glm/glm.hpp>
 
 #include <Data.h>
+#include <PointCloud.h>
 
 namespace py = pybind11;
 
@@ -215,6 +219,151 @@ struct Converter<py::object, std::filesystem::path>
   }
 };
 
+/**
+ * @brief Checks if NumPy was imported, without importing it. NumPy is not a dependency,
+ * so arrays are only used when the script already imported NumPy.
+ */
+inline bool isNumpyImported()
+{
+  // Borrowed reference to sys.modules.
+  return PyDict_GetItemString(PyImport_GetModuleDict(), "numpy") != nullptr;
+}
+
+/**
+ * @brief Checks if the object is a NumPy array. Conversions of many objects check if
+ * NumPy was imported once, and pass the result.
+ */
+inline bool isNumpyArray(const py::handle& obj, bool numpyImported = isNumpyImported())
+{
+  return numpyImported && py::isinstance<py::array>(obj);
+}
+
+/**
+ * @brief Layout of values of a type in NumPy arrays. Only types made of a fixed number of
+ * scalars without padding are supported, and point clouds, which are arrays of points.
+ */
+template<typename T, typename = void>
+struct ArrayTraits
+{
+  static constexpr bool IsSupported = false;
+  static constexpr bool IsNested    = false;
+};
+
+template<typename T>
+struct ArrayTraits<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+{
+  static constexpr bool IsSupported = true;
+  // Whether each value is an array of its own.
+  static constexpr bool IsNested = false;
+  using ScalarT                  = T;
+
+  static std::vector<py::ssize_t> shape(size_t n) { return {py::ssize_t(n)}; }
+
+  static bool validShape(const py::array& arr) { return arr.ndim() == 1; }
+};
+
+template<int N, typename T, glm::qualifier Q>
+struct ArrayTraits<glm::vec<N, T, Q>>
+{
+  static_assert(sizeof(glm::vec<N, T, Q>) == N * sizeof(T), "Vectors must not be padded");
+
+  static constexpr bool IsSupported = true;
+  static constexpr bool IsNested    = false;
+  using ScalarT                     = T;
+
+  static std::vector<py::ssize_t> shape(size_t n) { return {py::ssize_t(n), N}; }
+
+  static bool validShape(const py::array& arr)
+  {
+    return arr.ndim() == 2 && arr.shape(1) == N;
+  }
+};
+
+template<int N>
+struct ArrayTraits<PointCloud<N>> : public ArrayTraits<glm::vec<N, float>>
+{
+  static constexpr bool IsNested = true;
+};
+
+template<int N>
+struct Converter<py::object, PointCloud<N>>
+{
+  static void assign(const py::object& src, PointCloud<N>& dst)
+  {
+    assign(src, dst, isNumpyImported());
+  }
+
+  static void assign(const py::object& src, PointCloud<N>& dst, bool numpyImported)
+  {
+    using TraitsT = ArrayTraits<PointCloud<N>>;
+    if (!isNumpyArray(src, numpyImported)) {
+      dst = src.cast<PointCloud<N>>();
+      return;
+    }
+    auto arr = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(src);
+    if (!arr || !TraitsT::validShape(arr)) {
+      throw std::invalid_argument("Expected an array of points with shape (n, " +
+                                  std::to_string(N) + ")");
+    }
+    dst.resize(size_t(arr.shape(0)));
+    std::memcpy(dst.data(), arr.data(), dst.size() * sizeof(glm::vec<N, float>));
+  }
+};
+
+template<int N>
+struct Converter<PointCloud<N>, py::object>
+{
+  static void assign(const PointCloud<N>& src, py::object& dst)
+  {
+    if (!isNumpyImported()) {
+      dst = py::str(TypeInfo<PointCloud<N>>::name() + " object");
+      return;
+    }
+    // Copy the points, because the point cloud may not outlive the array.
+    dst = py::array_t<float>(ArrayTraits<PointCloud<N>>::shape(src.size()),
+                             (const float*)(src.data()));
+  }
+};
+
+/**
+ * @brief Creates NumPy arrays of the values and the depths of the tree, and returns them
+ * as a tuple. The array of values shares memory with the tree, and is read-only. The
+ * tree copies its values before modifying them while they are shared, so the array never
+ * changes. The depths are copied. For point clouds, the values are a list of arrays, one
+ * per point cloud.
+ */
+template<typename T>
+py::tuple treeToArrays(const data::Tree<T>& tree)
+{
+  using TraitsT  = ArrayTraits<T>;
+  using ScalarT  = typename TraitsT::ScalarT;
+  using StorageT = typename data::Tree<T>::InternalStorageT;
+  using HolderT  = std::shared_ptr<const StorageT>;
+  static_assert(TraitsT::IsSupported, "This type cannot be shared with NumPy");
+  // The capsule keeps the values alive for as long as the arrays that share them.
+  py::capsule base(new HolderT(tree.sharedValues()),
+                   [](void* ptr) { delete static_cast<HolderT*>(ptr); });
+  auto readonly = [](py::array arr) {
+    arr.attr("setflags")(py::arg("write") = false);
+    return arr;
+  };
+  py::object values;
+  if constexpr (TraitsT::IsNested) {
+    py::list lst;
+    for (const auto& val : tree.values()) {
+      lst.append(readonly(py::array_t<ScalarT>(
+        TraitsT::shape(val.size()), (const ScalarT*)(val.data()), base)));
+    }
+    values = lst;
+  }
+  else {
+    values = readonly(py::array_t<ScalarT>(
+      TraitsT::shape(tree.size()), (const ScalarT*)(tree.values().data()), base));
+  }
+  py::array_t<data::DepthT> depths(py::ssize_t(tree.size()), tree.depths().data());
+  return py::make_tuple(values, depths);
+}
+
 template<typename T>
 struct Converter<data::Tree<T>, py::object>
 {
@@ -313,9 +462,84 @@ private:
   static constexpr bool IsSharedPtr =
     std::is_same_v<std::shared_ptr<T>, std::remove_const_t<ValueType>>;
 
-  static bool isList(const py::object& obj)
+  static bool isList(const py::object& obj) { return PyList_Check(obj.ptr()); }
+
+  /**
+   * @brief Copies the values from a NumPy array, which is treated like a flat list. The
+   * source can also be a tuple of values and depths arrays, such as the ones returned by
+   * treeToArrays. Each array is copied with a single memcpy if its type matches the type
+   * of the tree.
+   *
+   * @return bool False if the source is not an array, and must be converted otherwise.
+   */
+  static bool assignArrays(const py::object& src, data::Tree<T>& dst, bool numpyImported)
   {
-    return py::str(obj.attr("__class__")).contains("'list'");
+    if (!numpyImported) {
+      return false;
+    }
+    using TraitsT     = ArrayTraits<T>;
+    py::object values = src;
+    py::object depths = py::none();
+    if (py::isinstance<py::tuple>(src) && py::len(src) == 2) {
+      py::tuple tup = py::cast<py::tuple>(src);
+      values        = tup[0];
+      depths        = tup[1];
+      if (!isNumpyArray(values, true) || !isNumpyArray(depths, true)) {
+        return false;
+      }
+    }
+    else if (!isNumpyArray(src, true) || py::cast<py::array>(src).ndim() == 0) {
+      return false;
+    }
+    dst.clear();
+    if constexpr (TraitsT::IsNested) {
+      // The array is a single value.
+      if (!depths.is_none()) {
+        return false;
+      }
+      T val;
+      Converter<py::object, T>::assign(src, val, true);
+      dst.push_back(0, std::move(val));
+      return true;
+    }
+    else {
+      using ScalarT = typename TraitsT::ScalarT;
+      using FlagsT  = py::array;
+      auto arr =
+        py::array_t<ScalarT, FlagsT::c_style | FlagsT::forcecast>::ensure(values);
+      if (!arr || !TraitsT::validShape(arr)) {
+        throw std::invalid_argument("The shape of the array doesn't match a list of " +
+                                    TypeInfo<T>::name());
+      }
+      size_t n     = size_t(arr.shape(0));
+      auto&  dvals = dst.values();
+      dvals.resize(n);
+      std::memcpy(dvals.data(), arr.data(), n * sizeof(T));
+      auto& ddepths = dst.depths();
+      if (depths.is_none()) {
+        ddepths.assign(n, 0);
+        if (n > 0) {
+          ddepths.front() = 1;
+        }
+        return true;
+      }
+      auto darr =
+        py::array_t<DepthT, FlagsT::c_style | FlagsT::forcecast>::ensure(depths);
+      if (!darr || darr.ndim() != 1 || size_t(darr.shape(0)) != n) {
+        throw std::invalid_argument("The depths array must have one depth per value");
+      }
+      ddepths.assign(darr.data(), darr.data() + n);
+      if (n > 0 && *std::max_element(ddepths.begin(), ddepths.end()) != ddepths.front()) {
+        throw std::invalid_argument("The first depth must be the largest");
+      }
+      // A depth of zero means the value is in the same list as the previous value, so
+      // only a single value can start at depth zero.
+      if (n > 1 && ddepths.front() == 0) {
+        throw std::invalid_argument(
+          "The first depth must be greater than zero when there are several values");
+      }
+      return true;
+    }
   }
 
   static size_t leafCount(const py::object& obj)
@@ -334,26 +558,38 @@ private:
     }
   }
 
+  static void assignLeaf(const py::object& src, T& dst, bool numpyImported)
+  {
+    // The leaves of nested types can be arrays.
+    if constexpr (ArrayTraits<T>::IsNested) {
+      Converter<py::object, T>::assign(src, dst, numpyImported);
+    }
+    else {
+      Converter<py::object, T>::assign(src, dst);
+    }
+  }
+
   static void assignInternal(const py::object&       src,
                              std::vector<ValueType>& vals,
                              std::vector<DepthT>&    depths,
+                             bool                    numpyImported,
                              DepthT                  depth = 0)
   {
     if (isList(src)) {
       py::list lst    = py::cast<py::list>(src);
       size_t   length = py::len(lst);
       for (size_t i = 0; i < length; i++) {
-        assignInternal(lst[i], vals, depths, i == 0 ? depth + 1 : 0);
+        assignInternal(lst[i], vals, depths, numpyImported, i == 0 ? depth + 1 : 0);
       }
     }
     else {
       ValueType val;
       if constexpr (IsSharedPtr) {
         val = std::make_shared<T>();
-        Converter<py::object, T>::assign(src, *val);
+        assignLeaf(src, *val, numpyImported);
       }
       else {
-        Converter<py::object, T>::assign(src, val);
+        assignLeaf(src, val, numpyImported);
       }
       vals.push_back(std::move(val));
       depths.push_back(depth);
@@ -363,9 +599,15 @@ private:
 public:
   static void assign(const py::object& src, data::Tree<T>& dst)
   {
+    bool numpyImported = isNumpyImported();
+    if constexpr (ArrayTraits<T>::IsSupported) {
+      if (assignArrays(src, dst, numpyImported)) {
+        return;
+      }
+    }
     dst.clear();
     dst.reserve(leafCount(src));
-    assignInternal(src, dst.values(), dst.depths());
+    assignInternal(src, dst.values(), dst.depths(), numpyImported);
   }
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <execution>
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -24,12 +25,92 @@ struct CombiView;
 
 }  // namespace repeat
 
+/**
+ * @brief Number of active views into a tree. Write-views increment it and read-views
+ * decrement it. Views are created from several threads when functions run in parallel,
+ * hence atomic. A copy of a tree has no active views, so copying resets the count.
+ */
+struct AccessFlag : public std::atomic<int32_t>
+{
+  AccessFlag()
+      : std::atomic<int32_t>(0)
+  {}
+
+  AccessFlag(const AccessFlag&)
+      : std::atomic<int32_t>(0)
+  {}
+
+  AccessFlag& operator=(const AccessFlag&) { return *this; }
+};
+
+/**
+ * @brief Values released by a tree when it is cleared, kept to be reused when the tree is
+ * written again. The recycled values belong to the tree, so a copy of a tree starts with
+ * an empty bin.
+ */
+template<typename T>
+struct RecycleBin : public std::vector<T>
+{
+  RecycleBin() = default;
+
+  RecycleBin(const RecycleBin&)
+      : std::vector<T>()
+  {}
+
+  RecycleBin(RecycleBin&&) = default;
+
+  RecycleBin& operator=(const RecycleBin&) { return *this; }
+
+  RecycleBin& operator=(RecycleBin&&) = default;
+};
+
+/**
+ * @brief Resets the value to an empty state. Values that can be cleared are cleared in
+ * place, so they keep the memory they allocated, the others are reassigned a default
+ * constructed value.
+ */
+template<typename T>
+void resetValue(T& value)
+{
+  if constexpr (HasClear<T>::value) {
+    value.clear();
+  }
+  else {
+    value = T();
+  }
+}
+
+/**
+ * @brief Resets a polymorphic value, so it can be reused without a new allocation.
+ * Values that are shared with others are released instead.
+ *
+ * @return bool True if the value was reset, false if it was released.
+ */
+template<typename T>
+bool recycleValue(std::shared_ptr<T>& value)
+{
+  if constexpr (HasClear<T>::value ||
+                (std::is_default_constructible_v<T> && std::is_move_assignable_v<T>)) {
+    if (value && value.use_count() == 1) {
+      resetValue(*value);
+      return true;
+    }
+  }
+  value.reset();
+  return false;
+}
+
 /**
  * @brief Datastructure to store arbitrary dimensional trees of a datatype. The tree uses
  * contiguous storage to store the leaf elements. The nested vectors are divided up a bit
  * like the graduations on a measuring tape, where the finest graduations represent leaf
  * nodes, the coarser graduations represent the parent nodes, and so on.
  *
+ * The values are shared between copies of a tree, and are only copied when one of the
+ * copies is modified. The depths are not shared. So copying a tree and changing the
+ * depths of the copy, as is done when grafting or flattening, costs as much as the
+ * depths and not the values.
+ *
  * @tparam T The type of data stored in the leaf nodes of the tree.
  */
 template<typename T>
@@ -43,49 +124,47 @@ public:
   using InternalStorageT              = std::vector<ValueType>;
 
   friend struct OffsetData;
+  /**
+   * @brief Index used to find the stride from an element to the next element with the
+   * same or higher depth. For every depth, it stores the sorted positions of the elements
+   * that begin a branch of that depth, so its size is proportional to the number of
+   * branches, not the number of elements. It is updated in place when elements are
+   * appended to the tree, and rebuilt only when the depths are changed otherwise.
+   */
   struct OffsetData
   {
-    std::vector<size_t> mDepthScan;
-    std::vector<size_t> mOffsets;
+    // mLevels[d] has the positions of the elements whose depth is greater than d.
+    std::vector<std::vector<size_t>> mLevels;
 
   public:
     void update(const Tree<T>& tree)
     {
       clear();
-      if (tree.empty()) {
-        return;
-      }
-      mDepthScan.resize(tree.mDepths.size());
-      std::transform_exclusive_scan(std::execution::par,
-                                    tree.mDepths.begin(),
-                                    tree.mDepths.end(),
-                                    mDepthScan.begin(),
-                                    size_t(0),
-                                    std::plus<size_t> {},
-                                    [](DepthT d) { return size_t(d); });
-      mOffsets.resize(mDepthScan.back() + size_t(tree.mDepths.back()));
-      DepthT              dmax = tree.maxDepth();
-      std::vector<size_t> pegs(dmax, 0);
       for (size_t i = 0; i < tree.mDepths.size(); i++) {
-        size_t dcur = size_t(tree.mDepths[i]);
-        if (dcur == 0) {
-          continue;
-        }
-        for (size_t d = 0; d < dcur; d++) {
-          if (i > 0) {
-            size_t& peg                   = pegs[d];
-            mOffsets[mDepthScan[peg] + d] = i - peg;
-            peg                           = i;
-          }
-          mOffsets[mDepthScan[i] + d] = tree.mDepths.size() - i;
-        }
+        add(i, 0, tree.mDepths[i]);
+      }
+    }
+
+    /**
+     * @brief Adds the element at the given position to the levels in the range [from,
+     * to). The positions must be added to every level in increasing order.
+     */
+    void add(size_t pos, DepthT from, DepthT to)
+    {
+      if (mLevels.size() < size_t(to)) {
+        mLevels.resize(to);
+      }
+      for (DepthT d = from; d < to; d++) {
+        mLevels[d].push_back(pos);
       }
     }
 
     void clear()
     {
-      mDepthScan.clear();
-      mOffsets.clear();
+      // Keep the memory of the levels for reuse.
+      for (auto& level : mLevels) {
+        level.clear();
+      }
     }
 
     size_t offset(const Tree<T>& tt, size_t pos, DepthT depth) const
@@ -96,11 +175,14 @@ public:
       else if (depth == 0) {
         return 1;
       }
-      else if (pos >= mDepthScan.size()) {
+      else if (pos >= tt.size()) {
         throw std::out_of_range("Index out of range");
       }
       else {
-        return mOffsets[mDepthScan[pos] + depth - 1];
+        // The element at pos is in this level, so the next one is where the stride ends.
+        const auto& level = mLevels[depth - 1];
+        auto        next  = std::upper_bound(level.begin(), level.end(), pos);
+        return (next == level.end() ? tt.size() : *next) - pos;
       }
     }
   };
@@ -120,30 +202,65 @@ private:
 
   friend repeat::CombiView<T, false>;
 
-  InternalStorageT                  mValues;
+  std::shared_ptr<InternalStorageT> mValues;
   std::vector<DepthT>               mDepths;
   std::vector<DepthT>               mQueuedDepths;
+  std::vector<uint64_t>             mLeafVersions;
   mutable utils::Cached<OffsetData> mCache;
-  mutable int32_t                   mAccessFlag = 0;
+  mutable AccessFlag                mAccessFlag;
+  // Only used for polymorphic values.
+  RecycleBin<ValueType> mRecycled;
+
+  /**
+   * @brief Takes a value from the recycle bin, or makes a new one if the bin is empty.
+   */
+  ValueType newValue()
+  {
+    if (mRecycled.empty()) {
+      return std::make_shared<T>();
+    }
+    ValueType value = std::move(mRecycled.back());
+    mRecycled.pop_back();
+    return value;
+  }
+
+  /**
+   * @brief Gets the values for writing. If the values are shared with other trees, they
+   * are copied first, so the other trees are not affected.
+   */
+  InternalStorageT& mutableValues()
+  {
+    if (!mValues) {
+      mValues = std::make_shared<InternalStorageT>();
+    }
+    else if (mValues.use_count() > 1) {
+      mValues = std::make_shared<InternalStorageT>(*mValues);
+    }
+    return *mValues;
+  }
 
   void ensureDepth(DepthT d)
   {
     if (!mDepths.empty()) {
-      mDepths[0] = std::max(++d, mDepths[0]);
+      DepthT old = mDepths[0];
+      mDepths[0] = std::max(++d, old);
+      if (mCache && mDepths[0] > old) {
+        mCache->add(0, old, mDepths[0]);
+      }
     }
   }
 
   void pushDepth(DepthT d)
   {
-    expireCache();
     ensureDepth(d);
-    if (mQueuedDepths.empty()) {
-      mDepths.push_back(d);
-    }
-    else {
-      mDepths.push_back(mQueuedDepths.back());
+    if (!mQueuedDepths.empty()) {
+      d = mQueuedDepths.back();
       mQueuedDepths.clear();
     }
+    mDepths.push_back(d);
+    if (mCache) {
+      mCache->add(mDepths.size() - 1, 0, d);
+    }
   }
 
   void queueDepth(DepthT d)
@@ -198,33 +315,84 @@ public:
       return;
     }
     mDepths.resize(n, 0);
-    size_t i = mValues.size();
-    mValues.resize(n);
-
-    if (!mQueuedDepths.empty()) {
+    auto&  values = mutableValues();
+    size_t i      = values.size();
+    values.resize(n);
+    if (n < i) {
+      expireCache();
+    }
+    else if (!mQueuedDepths.empty()) {
       mDepths[i] = mQueuedDepths.back();
       mQueuedDepths.clear();
+      if (mCache) {
+        mCache->add(i, 0, mDepths[i]);
+      }
     }
   }
 
-  DepthT&       depth(size_t i) { return mDepths[i]; }
+  /**
+   * @brief The depths can be modified through the non-const accessors, so they expire
+   * the index used for strides. Prefer the const overloads for reading.
+   */
+  DepthT& depth(size_t i)
+  {
+    expireCache();
+    return mDepths[i];
+  }
   const DepthT& depth(size_t i) const { return mDepths[i]; }
 
-  ValueType&       value(size_t i) { return mValues[i]; }
-  const ValueType& value(size_t i) const { return mValues[i]; }
+  ValueType&       value(size_t i) { return mutableValues()[i]; }
+  const ValueType& value(size_t i) const { return values()[i]; }
 
-  InternalStorageT&          values() { return mValues; }
-  const InternalStorageT&    values() const { return mValues; }
-  std::vector<DepthT>&       depths() { return mDepths; }
+  /**
+   * @brief The values of the tree. Getting the values of a non-const tree copies them if
+   * they are shared with another tree, so prefer the const overload for reading.
+   */
+  InternalStorageT&       values() { return mutableValues(); }
+  const InternalStorageT& values() const
+  {
+    static const InternalStorageT sEmpty;
+    return mValues ? *mValues : sEmpty;
+  }
+  std::vector<DepthT>& depths()
+  {
+    expireCache();
+    return mDepths;
+  }
   const std::vector<DepthT>& depths() const { return mDepths; }
 
-  size_t size() const { return mValues.size(); }
+  /**
+   * @brief Shares the values with an owner outside the tree, such as a NumPy array. Like
+   * a copy of the tree, the tree copies the values before modifying them while they are
+   * shared. Null if the tree never had any values.
+   */
+  std::shared_ptr<const InternalStorageT> sharedValues() const { return mValues; }
+
+  /**
+   * @brief Checks if this tree shares its values with the other tree, i.e. if one is an
+   * unmodified copy of the other, regardless of the depths.
+   */
+  bool sharesValuesWith(const Tree<T>& other) const
+  {
+    return mValues && mValues == other.mValues;
+  }
+
+  /**
+   * @brief Versions of the leaves of the tree, assigned by the function that owns the
+   * tree every time it writes the tree. Leaves with the same version have the same value,
+   * so a leaf that didn't change keeps its version. These are only valid if there is one
+   * version per leaf, and are cleared along with the tree.
+   */
+  std::vector<uint64_t>&       leafVersions() { return mLeafVersions; }
+  const std::vector<uint64_t>& leafVersions() const { return mLeafVersions; }
+
+  size_t size() const { return mValues ? mValues->size() : 0; }
 
   bool empty() const { return size() == 0; }
 
   void reserve(size_t n)
   {
-    mValues.reserve(n);
+    mutableValues().reserve(n);
     mDepths.reserve(n);
   }
 
@@ -249,10 +417,17 @@ public:
   void push_back(DepthT d, T item)
   {
     if constexpr (IsPolymorphic) {
-      mValues.emplace_back(std::make_shared<T>(std::move(item)));
+      if (mRecycled.empty()) {
+        mutableValues().emplace_back(std::make_shared<T>(std::move(item)));
+      }
+      else {
+        ValueType value = newValue();
+        *value          = std::move(item);
+        mutableValues().emplace_back(std::move(value));
+      }
     }
     else {
-      mValues.emplace_back(std::move(item));
+      mutableValues().emplace_back(std::move(item));
     }
     pushDepth(d);
   }
@@ -260,10 +435,10 @@ public:
   void emplace_back(DepthT d)
   {
     if constexpr (IsPolymorphic) {
-      mValues.emplace_back(std::make_shared<T>());
+      mutableValues().emplace_back(newValue());
     }
     else {
-      mValues.emplace_back();
+      mutableValues().emplace_back();
     }
     pushDepth(d);
   }
@@ -272,21 +447,36 @@ public:
   void emplace_back(DepthT d, TArgs... args)
   {
     if constexpr (IsPolymorphic) {
-      mValues.emplace_back(std::make_shared<T>(args...));
+      mutableValues().emplace_back(std::make_shared<T>(args...));
     }
     else {
-      mValues.emplace_back(args...);
+      mutableValues().emplace_back(args...);
     }
     pushDepth(d);
   }
 
   void clear()
   {
-    mValues.clear();
+    // Keep the memory for reuse, unless it is shared with another tree.
+    if (mValues.use_count() == 1) {
+      if constexpr (IsPolymorphic) {
+        for (auto& value : *mValues) {
+          if (recycleValue(value)) {
+            mRecycled.push_back(std::move(value));
+          }
+        }
+      }
+      mValues->clear();
+    }
+    else {
+      mValues.reset();
+    }
     mDepths.clear();
     mQueuedDepths.clear();
+    mLeafVersions.clear();
+    // The index of an empty tree is empty, and stays valid as the tree is written again.
     mCache->clear();
-    expireCache();
+    mCache.unexpire();
   }
 
   void graft()
@@ -320,7 +510,7 @@ public:
       }
       os << ' ';
       if constexpr (gal::IsPrintable<T>::value) {
-        os << tree.mValues[i];
+        os << tree.value(i);
       }
       else {
         os << '<' << gal::TypeInfo<T>::name() << '>';
@@ -451,7 +641,7 @@ public:
     return *this;
   }
 
-  const typename Tree<T>::InternalStorageT& storage() const { return mTree->mValues; }
+  const typename Tree<T>::InternalStorageT& storage() const { return mTree->values(); }
 
   Iterator<T, Dim - 1> end() const
   {
@@ -483,7 +673,7 @@ public:
 
   bool empty() const { return size() == 0; }
 
-  const ValueType* data() const { return mTree->mValues.data() + mIndex; }
+  const ValueType* data() const { return mTree->values().data() + mIndex; }
 
   /**
    * @brief Index at which the sibling of this node begins.
@@ -522,6 +712,31 @@ public:
   }
 };
 
+/**
+ * @brief Constant time random access to the values of a 1 dimensional read-view, unlike
+ * the subscript operator of the view. The values of polymorphic types are stored behind
+ * pointers.
+ */
+template<typename T>
+struct ListValues
+{
+  const typename Tree<T>::ValueType* mValues;
+
+  explicit ListValues(const ReadView<T, 1>& list)
+      : mValues(list.data())
+  {}
+
+  const T& operator[](size_t i) const
+  {
+    if constexpr (Tree<T>::IsPolymorphic) {
+      return *(mValues[i]);
+    }
+    else {
+      return mValues[i];
+    }
+  }
+};
+
 /**
  * @brief Iterator that points to a node in the tree.
  *
@@ -544,9 +759,9 @@ public:
       , mIndex(index)
   {}
 
-  const InternalStorageT&    storage() const { return mTree.mValues; }
+  const InternalStorageT&    storage() const { return mTree.values(); }
   const std::vector<DepthT>& depths() const { return mTree.mDepths; }
-  const InternalStorageT*    internalPtr() const { return &(mTree.mValues); }
+  const InternalStorageT*    internalPtr() const { return &(mTree.values()); }
 
   template<DepthT D2>
   bool operator==(const Iterator<T, D2>& other) const
@@ -638,7 +853,6 @@ protected:
     }
     mTree->queueDepth(Dim);
     mTree->mAccessFlag++;
-    mTree->expireCache();
   }
 
   void releaseWriteMode()
@@ -655,6 +869,13 @@ protected:
 
 public:
   void reserve(size_t n) { mTree->reserve(mTree->size() + n); }
+
+  /**
+   * @brief Values of the whole tree this view writes into, including the values written
+   * before this view was created. The values written by this view are at the end. This
+   * is meant for writing values that were already allocated, possibly in parallel.
+   */
+  typename Tree<T>::InternalStorageT& treeValues() { return mTree->values(); }
 };
 
 /**
@@ -802,15 +1023,37 @@ public:
     if (n == 0) {
       return;
     }
+    // Same as push_back, so the depth of the tree is the same either way.
+    this->mTree->ensureDepth(DepthT(size() == 0 ? 1 : 0));
     this->mTree->resize(n + this->mTree->size());
     if constexpr (IsPolymorphic) {
-      size_t m = this->mTree->size();
+      size_t m      = this->mTree->size();
+      auto&  values = this->mTree->values();
       for (size_t i = m - n; i < m; i++) {
-        this->mTree->value(i) = std::make_shared<T>();
+        values[i] = this->mTree->newValue();
       }
     }
   }
 
+  /**
+   * @brief Copies all the values of the source tree to the end of this view. The effect
+   * on the tree is the same as pushing the values into this view one at a time.
+   * Polymorphic values are shared with the source tree instead of being copied.
+   *
+   * @param src The source tree. Its depths are ignored.
+   */
+  void append(const Tree<T>& src)
+  {
+    if (src.empty()) {
+      return;
+    }
+    size_t n = this->mTree->size();
+    this->mTree->ensureDepth(DepthT(size() == 0 ? 1 : 0));
+    this->mTree->resize(n + src.size());
+    std::copy(
+      src.values().begin(), src.values().end(), this->mTree->values().begin() + n);
+  }
+
   T& operator[](size_t i)
   {
     if constexpr (IsPolymorphic) {
@@ -1235,6 +1478,24 @@ public:
   {
     return getArgsInternal<ArgsTupleT>(view, trees, std::make_index_sequence<NTrees> {});
   }
+
+  /**
+   * @brief Same as getArgs, but only for the leading input arguments. Unlike getArgs,
+   * this has no side effects on the output trees.
+   *
+   * @tparam InputArgsTupleT Tuple of input arguments type.
+   * @param view The current view.
+   * @param trees The data trees.
+   * @return InputArgsTupleT tuple of input arguments.
+   */
+  template<typename InputArgsTupleT>
+  static InputArgsTupleT getInputArgs(Type& view, const TreeTupleT& trees)
+  {
+    static constexpr size_t NArgs = std::tuple_size_v<InputArgsTupleT>;
+    static_assert(NArgs <= NInputs, "Expecting only input arguments");
+    return getArgsInternal<InputArgsTupleT>(
+      view, trees, std::make_index_sequence<NArgs> {});
+  }
 };
 
 /**
@@ -1366,6 +1627,40 @@ public:
     }
     return HelperT::template getArgs<ArgTupleT>(mViews.back(), mTrees);
   }
+
+  /**
+   * @brief Gets a tuple of the input arguments corresponding to the current combination
+   * of inputs. The output trees are not touched.
+   *
+   * @tparam InputArgTupleT Input argument tuple type.
+   * @return InputArgTupleT
+   */
+  template<typename InputArgTupleT>
+  InputArgTupleT currentInputs()
+  {
+    if (mViews.empty()) {
+      throw std::logic_error("No combinations left.");
+    }
+    return HelperT::template getInputArgs<InputArgTupleT>(mViews.back(), mTrees);
+  }
+
+  /**
+   * @brief Index of the node of the N-th tree that the current combination points to.
+   */
+  template<size_t N>
+  size_t currentIndex() const
+  {
+    if (mViews.empty()) {
+      throw std::logic_error("No combinations left.");
+    }
+    return std::get<N>(mViews.back()).index();
+  }
+
+  /**
+   * @brief Depth of the view of the given argument, i.e. the height of the nodes of its
+   * tree that are passed to the function.
+   */
+  DepthT viewDepth(size_t arg) const { return mViewDepths[arg]; }
 };
 
 }  // namespace repeat
@@ -1409,6 +1704,67 @@ private:
   bool mValue = false;
 };
 
+template<>
+struct IsValueType<Bool> : public std::true_type
+{
+};
+
+/**
+ * @brief A tree is serialized as its values followed by its depths. Trees of types that
+ * cannot be serialized are not serializable either.
+ */
+template<typename T>
+struct Serial<func::data::Tree<T>> : public IsSerializable<T>
+{
+  using TreeT = func::data::Tree<T>;
+
+  static TreeT deserialize(Bytes& bytes)
+  {
+    TreeT    tree;
+    uint64_t size = 0;
+    bytes >> size;
+    tree.resize(size);
+    if constexpr (TreeT::IsPolymorphic) {
+      for (auto& value : tree.values()) {
+        value = std::make_shared<T>();
+        bytes >> *value;
+      }
+    }
+    else if constexpr (IsValueType<T>::value) {
+      bytes.readBytes(size * sizeof(T), (char*)tree.values().data());
+    }
+    else {
+      for (auto& value : tree.values()) {
+        bytes >> value;
+      }
+    }
+    bytes.readBytes(size * sizeof(func::data::DepthT), (char*)tree.depths().data());
+    return tree;
+  }
+
+  static Bytes serialize(const TreeT& tree)
+  {
+    Bytes bytes;
+    bytes << uint64_t(tree.size());
+    if constexpr (TreeT::IsPolymorphic) {
+      for (const auto& value : tree.values()) {
+        bytes << *value;
+      }
+    }
+    else if constexpr (IsValueType<T>::value) {
+      bytes.writeBytes((const char*)tree.values().data(), tree.size() * sizeof(T));
+    }
+    else {
+      for (const auto& value : tree.values()) {
+        bytes << value;
+      }
+    }
+    bytes.writeBytes((const char*)tree.depths().data(),
+                     tree.size() * sizeof(func::data::DepthT));
+    return bytes;
+  }
+};
+
 }  // namespace gal
 
 GAL_TYPE_INFO(gal::Bool, bool, 0xe2953d62);
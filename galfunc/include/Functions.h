@@ -1,16 +1,30 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <spdlog/spdlog.h>
+#include <tbb/parallel_for.h>
 
 #include <Data.h>
 #include <MapMacro.h>
+#include <Profiler.h>
 #include <Property.h>
+#include <ResultCache.h>
+#include <Timer.h>
 #include <TypeManager.h>
 #include <Util.h>
 
@@ -29,6 +43,21 @@ namespace python {
  */
 fs::path getcontextpath();
 
+/**
+ * @brief Captures the current python context. This only interns the code objects of the
+ * frames on the python stack, and the path is built when it is first requested.
+ *
+ * @return uint32_t Id of the context, zero if there is no python context.
+ */
+uint32_t capturecontext();
+
+/**
+ * @brief Gets the path of a context captured earlier.
+ *
+ * @param context Id of the context.
+ */
+const fs::path& contextpath(uint32_t context);
+
 }  // namespace python
 
 struct FuncInfo
@@ -42,9 +71,43 @@ struct FuncInfo
   size_t                  mNumOutputs;
   const std::string_view* mOutputNames;
   const std::string_view* mOutputDescriptions;
+
+  // Pure functions only write their outputs, so they can run in parallel.
+  bool mIsPure = false;
+  // The outputs of cached functions are stored on disk, keyed by the inputs, and reused
+  // when the function runs with the same inputs again, even in a later session.
+  bool mIsCached = false;
+  // Version of the implementation of a cached function, which is part of the cache key.
+  // It must be incremented when the results of the function change, so that the results
+  // of the older implementation are not reused.
+  uint32_t mCacheVersion = 0;
 };
 
 struct Function;
+struct FusedChain;
+struct Session;
+
+/**
+ * @brief Values of an argument of an elementwise function, used when the function runs
+ * as part of a fused chain. A constant array has a single value, which is used for every
+ * call.
+ */
+struct ElementArray
+{
+  void* mData       = nullptr;
+  bool  mIsConstant = false;
+};
+
+/**
+ * @brief Values of an input tree that is a single value or a flat list.
+ */
+struct FlatTree
+{
+  const void*  mValues    = nullptr;
+  size_t       mSize      = 0;
+  size_t       mValueSize = 0;
+  data::DepthT mDepth     = 0;
+};
 
 struct InputInfo
 {
@@ -64,8 +127,10 @@ spdlog::logger& logger();
  */
 struct Function
 {
+  friend struct Session;
+
   // Virtual destructor because of polymorphism.
-  virtual ~Function() = default;
+  virtual ~Function();
 
   Function(Function const&)            = delete;
   Function(Function&&)                 = delete;
@@ -77,7 +142,27 @@ struct Function
    */
   virtual void update() const = 0;
 
-  virtual void addSubscriber(bool& dirtyFlag) const = 0;
+  /**
+   * @brief Brings the function up to date, assuming all the upstream functions are
+   * already up to date. The function only runs if the version of at least one of its
+   * inputs changed since it last ran. This is used by the evaluation engine, which
+   * decides the order in which functions are updated.
+   */
+  virtual void updateLocal() const = 0;
+
+  /**
+   * @brief Checks if the function has not been brought up to date since the last change
+   * to the graph. An expired function does not necessarily have to run again.
+   */
+  virtual bool isExpired() const = 0;
+
+  /**
+   * @brief Version of the given output. The version changes every time the output
+   * changes, and stays the same if the function runs again and produces the same output.
+   *
+   * @param output Index of the output.
+   */
+  virtual uint64_t version(size_t output) const = 0;
 
   const fs::path& contextpath() const;
 
@@ -90,25 +175,295 @@ struct Function
 
   virtual void getInputs(std::vector<InputInfo>& dst) const = 0;
 
+  /**
+   * @brief Identifies the type of the function in snapshots. Instances of a function
+   * template have the same name, but different types.
+   */
+  virtual uint64_t typeId() const = 0;
+
+  /**
+   * @brief Gets the tree of the given output, if it has the given type.
+   *
+   * @return const void* The tree, or nullptr if the output is a tree of another type.
+   */
+  virtual const void* outputTree(size_t output, const std::type_info& type) const = 0;
+
+  /**
+   * @brief Writes the outputs to the bytes.
+   *
+   * @return bool False if the outputs can't be serialized.
+   */
+  virtual bool saveOutputs(Bytes& dst) const = 0;
+
+  /**
+   * @brief Reads the outputs written by saveOutputs. The outputs are considered up to
+   * date with the current versions of the inputs, so the function doesn't run again
+   * until its inputs change.
+   */
+  virtual void loadOutputs(Bytes& src) const = 0;
+
+  /**
+   * @brief Checks if the function is pure, and is called once per value of its inputs.
+   * Such functions can be fused with the elementwise functions downstream of them.
+   */
+  virtual bool isElementwise() const { return false; }
+
+  /**
+   * @brief Gets the values of the given input of an elementwise function.
+   *
+   * @return bool False if the input tree is empty, or is not a single value or a flat
+   * list.
+   */
+  virtual bool flatInput(size_t input, FlatTree& dst) const { return false; }
+
+  /**
+   * @brief Size in bytes of the values of the given output of an elementwise function.
+   */
+  virtual size_t outputValueSize(size_t output) const { return 0; }
+
+  /**
+   * @brief Calls an elementwise function n times, without touching its own inputs and
+   * outputs. The i-th call reads the i-th values of the input arrays, or their only value
+   * if they are constant, and writes the i-th values of the output arrays.
+   */
+  virtual void runElements(std::span<const ElementArray> inputs,
+                           std::span<const ElementArray> outputs,
+                           size_t                        n) const
+  {}
+
+  /**
+   * @brief Brings the last function of a fused chain up to date, by running the whole
+   * chain. The other functions of the chain are not run, and stay expired.
+   */
+  virtual void updateFused(const FusedChain& chain) const { updateLocal(); }
+
   int  index() const;
   int& index();
 
+  /**
+   * @brief The session that owns this function, i.e. the session that was current when
+   * the function was created.
+   */
+  Session& session() const;
+
 protected:
   Function();
 
 private:
-  fs::path mContextPath;
+  uint32_t mContext;
   FuncInfo mInfo;
-  int      mIndex = -1;
+  int      mIndex   = -1;
+  Session* mSession = nullptr;
 };
 
-namespace store {
+/**
+ * @brief Elementwise functions that are evaluated together, one block of values at a
+ * time, instead of one after another. The functions are sorted topologically, and only
+ * the last one is read by functions outside the chain. The outputs of the other
+ * functions only live in small buffers while a block is evaluated, so the chain doesn't
+ * allocate or traverse the intermediate trees. The other functions stay expired, and are
+ * run on their own if their outputs are read later.
+ */
+struct FusedChain
+{
+  static constexpr size_t BlockSize = 1024;
+
+  explicit FusedChain(std::vector<const Function*> functions);
+
+  const Function& last() const;
+
+  /**
+   * @brief Number of values written to the outputs of the last function.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Depth of the first value of the outputs of the last function.
+   */
+  data::DepthT depth() const;
+
+  /**
+   * @brief Identifies the inputs of the chain, and their versions. The last function
+   * only runs the chain again if this changes.
+   */
+  const std::vector<uint64_t>& signature() const;
+
+  /**
+   * @brief Brings the chain up to date. The chain is fused only if all of its inputs are
+   * single values or flat lists. Otherwise the functions are brought up to date one after
+   * another.
+   */
+  void update();
+
+  /**
+   * @brief Runs the chain, and writes the values of the last function into the given
+   * outputs, which must have room for all the values.
+   */
+  void run(std::span<void* const> outputs) const;
+
+private:
+  // An input of a function of the chain, read either from the outside, or from an
+  // earlier function of the chain.
+  struct Source
+  {
+    const Function* mFunc;
+    size_t          mOutputIdx;
+    // Position of the function in the chain, if it is part of the chain.
+    size_t   mNode;
+    FlatTree mTree;
+  };
+
+  std::vector<const Function*>     mFunctions;
+  std::vector<std::vector<Source>> mSources;
+  std::vector<uint64_t>            mSignature;
+  size_t                           mSize  = 0;
+  data::DepthT                     mDepth = 0;
+
+  bool prepare();
+
+  void runBlock(size_t                                begin,
+                size_t                                end,
+                std::vector<std::vector<std::byte*>>& buffers,
+                std::span<void* const>                outputs) const;
+};
 
 /**
- * @brief Adds the function instance to the list of managed functions. This is necessary
- * because all function instances must be tracked and managed.
+ * @brief Brings the target functions up to date. The expired functions upstream of the
+ * targets are sorted topologically. In parallel mode, every function is brought up to
+ * date as soon as all of its inputs are up to date, so independent branches of the graph
+ * run concurrently on a TBB task arena. In serial mode, the functions are brought up to
+ * date one after another on the calling thread. Every function only writes its own
+ * outputs, so the results are the same in both modes. A function whose input versions
+ * did not change is not run again. Chains of elementwise functions, whose intermediate
+ * outputs are not read by any other function, are fused and run together.
  *
- * @param fn
+ * @param targets The functions to be updated. They must belong to the same session.
+ * @param cancel If given, the evaluation stops scheduling functions once this flag is
+ * set, and the functions that were not run stay expired. Functions that are already
+ * running are not interrupted.
+ */
+void evaluate(std::span<const Function* const> targets,
+              const std::atomic<bool>*         cancel = nullptr);
+
+/**
+ * @brief Reserves n new leaf versions, that were never used before, and returns the
+ * first one. The reserved versions are consecutive. The versions are unique across all
+ * sessions.
+ */
+uint64_t newLeafVersions(size_t n);
+
+/**
+ * @brief A function graph, i.e. the functions, their properties, and the state of their
+ * evaluation. Sessions are independent of each other, so different sessions can be
+ * built and evaluated concurrently on different threads, but each session must only be
+ * used by one thread at a time. Functions are created in the current session of the
+ * calling thread, which is the default session unless another session is made current.
+ * The functions of a session must not be used after the session is destroyed.
+ */
+struct Session
+{
+  Session();
+  ~Session();
+
+  Session(Session const&)            = delete;
+  Session(Session&&)                 = delete;
+  Session& operator=(Session const&) = delete;
+  Session& operator=(Session&&)      = delete;
+
+  /**
+   * @brief Takes ownership of the function instance. This is necessary because all
+   * function instances must be tracked and managed.
+   */
+  Function* addFunction(const FuncInfo& fnInfo, std::unique_ptr<Function> fn);
+
+  size_t numFunctions() const;
+
+  /**
+   * @brief Get the function with the given index.
+   *
+   * @param i Index.
+   */
+  const Function& function(size_t i) const;
+
+  /**
+   * @brief Properties container for the functions in this session.
+   */
+  Properties& properties();
+
+  /**
+   * @brief Profile statistics of the functions in this session.
+   */
+  Property<profile::Stats>& profileStats();
+
+  /**
+   * @brief The current revision of the function graph. The revision is incremented every
+   * time a variable changes. A function is up to date if it was brought up to date at
+   * the current revision.
+   */
+  uint64_t revision() const;
+
+  /**
+   * @brief Increments the revision of the function graph and returns the new revision.
+   */
+  uint64_t newRevision();
+
+  /**
+   * @brief Sets whether the function graph is evaluated in parallel. The default is
+   * true.
+   */
+  void setParallelEvaluation(bool flag);
+
+  bool parallelEvaluation() const;
+
+  /**
+   * @brief Sets whether the runs of the functions in this session are recorded in the
+   * profile statistics. The default is false.
+   */
+  void setProfiling(bool flag);
+
+  bool profiling() const;
+
+  /**
+   * @brief Unloads all the functions of this session.
+   */
+  void clear();
+
+  static Session& defaultSession();
+
+  /**
+   * @brief The session of the calling thread.
+   */
+  static Session& current();
+
+  /**
+   * @brief Makes the given session current on the calling thread.
+   *
+   * @param session The session, or nullptr for the default session.
+   * @return Session* The session that was current before, or nullptr if it was the
+   * default session.
+   */
+  static Session* makeCurrent(Session* session);
+
+private:
+  std::vector<std::unique_ptr<Function>> mFunctions;
+  Properties                             mProperties;
+  Property<profile::Stats>               mProfileStats;
+  std::atomic<bool>                      mProfiling          = false;
+  std::atomic<uint64_t>                  mRevision           = 1;
+  std::atomic<bool>                      mParallelEvaluation = true;
+};
+
+/**
+ * @brief Sets whether the current session is evaluated in parallel.
+ */
+void setParallelEvaluation(bool flag);
+
+bool parallelEvaluation();
+
+namespace store {
+
+/**
+ * @brief Adds the function instance to the current session.
  */
 Function* addFunction(const FuncInfo& fnInfo, std::unique_ptr<Function> fn);
 
@@ -145,12 +500,58 @@ Property<T> addProperty()
 }
 
 /**
- * @brief Unloads all loaded function instances.
+ * @brief Unloads all the functions of the current session.
  */
 void unloadAllFunctions();
 
 };  // namespace store
 
+namespace snapshot {
+
+/**
+ * @brief Creates an instance of a function type, connected to the given outputs of other
+ * functions.
+ */
+using Factory = std::unique_ptr<Function> (*)(std::span<const InputInfo> inputs);
+
+/**
+ * @brief Registers a function type, so its instances can be restored from snapshots.
+ * The types of the functions are registered when they are bound to python.
+ *
+ * @param typeId Id of the type, see Function::typeId.
+ * @param info Info of the instances of the type.
+ * @param type Used to check that saved functions are instances of the registered type.
+ * @param factory Creates the instances.
+ */
+void registerType(uint64_t              typeId,
+                  const FuncInfo&       info,
+                  const std::type_info& type,
+                  Factory               factory);
+
+/**
+ * @brief Writes the function graph of the current session to bytes, so it can be
+ * restored without running the script that created it. The type of each function, the
+ * outputs its inputs are connected to, and the values of the variables are written. All
+ * the functions must be of registered types.
+ *
+ * @param withOutputs Also brings the graph up to date, and writes the outputs of all the
+ * functions that can be serialized, so they don't run again after they are restored.
+ */
+Bytes save(bool withOutputs = false);
+
+void saveToFile(const fs::path& path, bool withOutputs = false);
+
+/**
+ * @brief Restores the functions written by save, and adds them to the current session
+ * after its existing functions. If any of the functions cannot be restored, none of them
+ * are added.
+ */
+void load(Bytes& bytes);
+
+void loadFromFile(const fs::path& path);
+
+}  // namespace snapshot
+
 /**
  * @brief Wrapper that points to readonly data owned by a
  * function. This is an output of that function. These are passed down
@@ -175,6 +576,21 @@ struct Register
       , mIndex(index)
   {}
 
+  /**
+   * @brief Gets the register of the given output of a function. Throws if the output is
+   * not a tree of type T.
+   */
+  static Register fromOutput(const Function* fn, size_t index)
+  {
+    const auto* tree =
+      static_cast<const data::Tree<T>*>(fn->outputTree(index, typeid(data::Tree<T>)));
+    if (!tree) {
+      throw std::invalid_argument("The output of " + std::string(fn->info().mName) +
+                                  " is not of type " + TypeInfo<T>::name());
+    }
+    return Register(fn, tree, index);
+  }
+
   const data::Tree<T>& read() const
   {
     mOwner->update();
@@ -182,6 +598,8 @@ struct Register
   }
 
   const Function* owner() const { return mOwner; }
+
+  uint64_t version() const { return mOwner->version(mIndex); }
 };
 
 /**
@@ -401,121 +819,943 @@ typename TArgList::ArgTreeRefTupleT makeArgTreeRefTuple(
     inputs, outputs, std::make_index_sequence<TArgList::NumTypes> {});
 }
 
-// For internal use only from the other function.
-template<typename OutputTupleT, size_t... Is>
-py::tuple pythonOutputTupleInternal(const Function*     fn,
-                                    const OutputTupleT& src,
-                                    std::index_sequence<Is...>)
-{
-  return py::make_tuple(
-    ArgRegisterT<typename std::tuple_element_t<Is, OutputTupleT>::Type>(
-      fn, &(std::get<Is>(src)), Is)...);
-}
+// For internal use only from the other function.
+template<typename OutputTupleT, size_t... Is>
+py::tuple pythonOutputTupleInternal(const Function*     fn,
+                                    const OutputTupleT& src,
+                                    std::index_sequence<Is...>)
+{
+  return py::make_tuple(
+    ArgRegisterT<typename std::tuple_element_t<Is, OutputTupleT>::Type>(
+      fn, &(std::get<Is>(src)), Is)...);
+}
+
+/**
+ * @brief Wraps the output tuple of the function in registers and returns a python tuple
+ * of registers.
+ *
+ * @tparam OutputTupleT The output tuple type.
+ * @param fn The function that owns the outputs.
+ * @param src The output tuple. It is the source of the wrapped register tuple.
+ * @return py::tuple
+ */
+template<typename OutputTupleT>
+py::tuple pythonOutputTuple(const Function* fn, const OutputTupleT& src)
+{
+  return pythonOutputTupleInternal(
+    fn, src, std::make_index_sequence<std::tuple_size_v<OutputTupleT>> {});
+}
+
+template<typename... Ts>
+struct EmptyCallable
+{
+  void operator()(typename ImplFnArgType<Ts>::Type...) const {};
+};
+
+/**
+ * @brief Outputs of these types are compared with their previous values every time the
+ * function runs, to avoid running the downstream functions when the outputs don't change.
+ */
+template<typename T>
+struct IsCheapToCompare
+{
+  static constexpr bool value =
+    (std::is_trivially_copyable_v<T> || std::is_same_v<T, std::string>) &&
+    IsEqualityComparable<T>::value;
+};
+
+/**
+ * @brief Arguments of these types are passed to the function one value at a time, and
+ * can be read and written in place in the contiguous values of the trees.
+ */
+template<typename T>
+struct IsElementwiseArg
+{
+  using ValueT                = std::remove_const_t<T>;
+  static constexpr bool value = !data::IsReadView<ValueT>::value &&
+                                !data::IsWriteView<ValueT>::value &&
+                                !IsInstance<data::Tree, ValueT>::value &&
+                                std::is_trivially_copyable_v<ValueT>;
+};
+
+/**
+ * @brief Private storage for one output of a function, for a single combination of
+ * inputs. This is used when a pure function runs its combinations. Every combination
+ * writes into its own private outputs, which are spliced into the output trees
+ * afterwards, in the order of serial execution. The private outputs are kept after they
+ * are spliced, so they can be reused if the inputs of the combination don't change.
+ *
+ * @tparam T The type of the output argument.
+ */
+template<typename T>
+struct PrivateOutput
+{
+  static constexpr bool IsSupported   = true;
+  static constexpr bool IsPolymorphic = data::Tree<T>::IsPolymorphic;
+
+  typename data::Tree<T>::ValueType mValue;
+
+  T& arg()
+  {
+    if constexpr (IsPolymorphic) {
+      if (!mValue) {
+        mValue = std::make_shared<T>();
+      }
+      return *mValue;
+    }
+    else {
+      return mValue;
+    }
+  }
+
+  void splice(T& dst, data::Tree<T>& tree) const
+  {
+    if constexpr (IsPolymorphic) {
+      // Share the value instead of copying it, if possible.
+      auto& last = tree.values().back();
+      if (last.get() == &dst) {
+        last = mValue;
+      }
+      else {
+        dst = *mValue;
+      }
+    }
+    else {
+      dst = mValue;
+    }
+  }
+
+  /**
+   * @brief Resets the output, so it can be written by another combination.
+   */
+  void recycle()
+  {
+    if constexpr (IsPolymorphic) {
+      data::recycleValue(mValue);
+    }
+    else {
+      data::resetValue(mValue);
+    }
+  }
+};
+
+template<typename T>
+struct PrivateOutput<data::WriteView<T, 1>>
+{
+  static constexpr bool IsSupported = true;
+
+  data::Tree<T> mTree;
+
+  data::WriteView<T, 1> arg() { return data::WriteView<T, 1>(mTree); }
+
+  void splice(data::WriteView<T, 1>& dst, data::Tree<T>&) const { dst.append(mTree); }
+
+  void recycle() { mTree.clear(); }
+};
+
+// Higher dimensional views and whole trees can change the depths of the output trees in
+// ways that cannot be replayed, so those functions always run serially.
+template<typename T, data::DepthT Dim>
+struct PrivateOutput<data::WriteView<T, Dim>>
+{
+  static constexpr bool IsSupported = false;
+};
+
+template<typename T>
+struct PrivateOutput<data::Tree<T>>
+{
+  static constexpr bool IsSupported = false;
+};
+
+/**
+ * @brief Helper template to run the combinations of a function in parallel.
+ *
+ * @tparam TArgList The argument type list of the function.
+ */
+template<
+  typename TArgList,
+  typename InputSeq  = std::make_index_sequence<TArgList::NumInputs>,
+  typename OutputSeq = std::make_index_sequence<TArgList::NumTypes - TArgList::NumInputs>>
+struct ParallelCombinations;
+
+template<typename TArgList, size_t... Is, size_t... Os>
+struct ParallelCombinations<TArgList,
+                            std::index_sequence<Is...>,
+                            std::index_sequence<Os...>>
+{
+  static constexpr size_t NInputs = TArgList::NumInputs;
+
+  template<size_t N>
+  using OutputT = typename TArgList::template Type<NInputs + N>;
+
+  using InputArgTupleT =
+    std::tuple<typename ImplFnArgType<typename TArgList::template Type<Is>>::Type...>;
+  using OutputArgTupleT     = std::tuple<typename ImplFnArgType<OutputT<Os>>::Type...>;
+  using PrivateOutputTupleT = std::tuple<PrivateOutput<OutputT<Os>>...>;
+
+  static constexpr bool IsSupported = (PrivateOutput<OutputT<Os>>::IsSupported && ...);
+
+  static OutputArgTupleT outputArgs(PrivateOutputTupleT& outputs)
+  {
+    return OutputArgTupleT(std::get<Os>(outputs).arg()...);
+  }
+
+  /**
+   * @brief Copies the private outputs of a combination into the output arguments of the
+   * same combination, obtained from a serial traversal of the combinations.
+   */
+  template<typename ArgTupleT, typename OutputTupleT>
+  static void splice(const PrivateOutputTupleT& src,
+                     ArgTupleT&                 args,
+                     OutputTupleT&              outputs)
+  {
+    (std::get<Os>(src).splice(std::get<NInputs + Os>(args), std::get<Os>(outputs)), ...);
+  }
+
+  static void recycle(PrivateOutputTupleT& outputs)
+  {
+    (std::get<Os>(outputs).recycle(), ...);
+  }
+};
+
+/**
+ * @brief Template for all non-variable functions.
+ * @tparam NInputs Number of inputs.
+ * @tparam TArgs All arguments. Inputs followed by outputs.
+ */
+template<typename TCallable, typename... TArgs>
+struct TFunction : public Function
+{
+  using TArgList                  = TypeList<TArgs...>;
+  static constexpr size_t NInputs = TArgList::NumInputs;
+  using ArgTupleT                 = typename TArgList::ArgTupleType;
+  using ArgTreeRefTupleT          = typename TArgList::ArgTreeRefTupleT;
+  using InputRegTupleT            = typename TArgList::InputRegTupleType;
+  using OutputTupleT              = typename TArgList::OutputTupleType;
+  static constexpr size_t NArgs   = TArgList::NumTypes;
+  static_assert(NInputs <= NArgs,
+                "Number of inputs is larger than the number of arguments!");
+  static constexpr bool   HasInputs   = NInputs > 0;
+  static constexpr size_t NOutputs    = NArgs - NInputs;
+  static constexpr bool   NOutputsGT1 = NOutputs > 1;
+  static constexpr bool   NOutputsGT0 = NOutputs > 0;
+  static constexpr bool   NOutputsEQ0 = NOutputs == 0;
+
+  using PyOutputType = std::conditional_t<
+    NOutputsEQ0,
+    void,
+    std::conditional_t<
+      NOutputsGT1,
+      py::tuple,
+      /* The ternary expression is just in case NOutputs is zero, to make
+         sure the code will still compile. It should never lead to a wrong type index
+         being used because NOutputs == 0 case is already handled above. */
+      ArgRegisterT<typename TArgList::template Type<(NOutputsGT0 ? NInputs : 0)>>>>;
+
+  using ParallelT = ParallelCombinations<TArgList>;
+  // The outputs can only be cached, or saved in snapshots, if all the inputs and outputs
+  // can be serialized.
+  static constexpr bool IsCacheable =
+    (IsSerializable<ArgTreeT<std::remove_const_t<TArgs>>>::value && ...);
+  // Functions of single values, such as the math functions, run over flat lists in a
+  // single loop over the values.
+  static constexpr bool IsElementwise =
+    HasInputs && NOutputsGT0 && (IsElementwiseArg<TArgs>::value && ...);
+
+  template<size_t N>
+  using ArgValueT = std::remove_const_t<typename TArgList::template Type<N>>;
+
+private:
+  /* Some fields are marked mutable because the function is considered changed only if the
+   * inputs are changed. Running the function, which changes the output, or the status of
+   * the dirty-flag, is not considered changing.
+   */
+  TCallable                                                               mFunc;
+  mutable OutputTupleT                                                    mOutputs;
+  InputRegTupleT                                                          mInputs;
+  mutable data::repeat::Combinations<NInputs, ArgTreeRefTupleT, TArgs...> mCombinations;
+  // Versions of the inputs when the function last ran.
+  mutable std::array<uint64_t, NInputs>  mInputVersions = {};
+  mutable std::array<uint64_t, NOutputs> mVersions      = {};
+  // Revision at which the function was last brought up to date. Zero if the function
+  // never ran, or if the last run failed.
+  mutable uint64_t mVerifiedAt = 0;
+  // Signature of the inputs of the fused chain, if the function last ran as the end of
+  // a fused chain. Empty otherwise.
+  mutable std::vector<uint64_t> mFusedSignature;
+
+  /**
+   * @brief Outputs of one combination of inputs, kept after the function runs so they can
+   * be reused in the next run if the leaves read by the combination don't change.
+   */
+  struct CombinationResult
+  {
+    // Versions and structure of the leaves read by the combination.
+    std::vector<uint64_t>                   mSignature;
+    uint64_t                                mHash  = 0;
+    bool                                    mValid = false;
+    typename ParallelT::PrivateOutputTupleT mOutputs;
+    // Version of the first leaf written to each output. The versions are consecutive.
+    std::array<uint64_t, NOutputs> mLeafVersions = {};
+  };
+  mutable std::vector<CombinationResult> mResults;
+
+  /**
+   * @brief Containers used while running the combinations, and the previous outputs used
+   * while updating the versions. These are only needed during a run, but are kept
+   * between runs, so a function that runs often reuses their memory instead of
+   * allocating it again every time.
+   */
+  struct Scratch
+  {
+    std::vector<typename ParallelT::InputArgTupleT> mInputs;
+    std::vector<CombinationResult>                  mResults;
+    // Hashes of the valid results of the previous run, and their indices, sorted.
+    std::vector<std::pair<uint64_t, size_t>> mPrevious;
+    std::vector<size_t>                      mPending;
+    // Indices of the results of the previous run that are not reused in this run.
+    std::vector<size_t> mUnused;
+    std::vector<bool>   mIsUsed;
+    OutputTupleT        mStash;
+  };
+  mutable Scratch mScratch;
+
+  template<size_t N = 0>
+  inline void clearOutputs() const
+  {
+    if constexpr (NInputs + N < NArgs) {
+      std::get<N>(mOutputs).clear();
+    }
+    if constexpr (NInputs + N + 1 < NArgs) {
+      clearOutputs<N + 1>();
+    }
+  }
+
+  inline size_t runSerial() const
+  {
+    size_t n = 0;
+    clearOutputs();
+    mCombinations.init();
+    if (!mCombinations.empty()) {
+      do {
+        std::apply(mFunc, mCombinations.template current<ArgTupleT>());
+        n++;
+      } while (mCombinations.next());
+    }
+    return n;
+  }
+
+  /**
+   * @brief Checks if the tree is a single value, or a flat list of values. The
+   * combinations of such trees are the values at the same positions, and shorter trees
+   * repeat their last value.
+   */
+  template<typename T>
+  static bool isFlat(const data::Tree<T>& tree)
+  {
+    return !tree.empty() && tree.maxDepth() < 2 && tree.stride(0, 1) == tree.size();
+  }
+
+  /**
+   * @brief Calls the function for the values in the range. The inputs flagged as
+   * constant point to their last value, and the others point to their first value. The
+   * flags are turned into template parameters one at a time, so each loop reads every
+   * input either contiguously or as a constant, and can be vectorized.
+   */
+  template<typename InputPtrTupleT, typename OutputPtrTupleT, typename... IsConstantT>
+  void runValues(const InputPtrTupleT&             inputs,
+                 const OutputPtrTupleT&            outputs,
+                 const std::array<bool, NInputs>& isConstant,
+                 size_t                            begin,
+                 size_t                            end,
+                 IsConstantT... flags) const
+  {
+    static constexpr size_t N = sizeof...(IsConstantT);
+    if constexpr (N < NInputs) {
+      if (isConstant[N]) {
+        runValues(inputs, outputs, isConstant, begin, end, flags..., std::true_type {});
+      }
+      else {
+        runValues(
+          inputs, outputs, isConstant, begin, end, flags..., std::false_type {});
+      }
+    }
+    else {
+      runValuesInternal<std::tuple<IsConstantT...>>(
+        inputs,
+        outputs,
+        begin,
+        end,
+        std::make_index_sequence<NInputs> {},
+        std::make_index_sequence<NOutputs> {});
+    }
+  }
+
+  template<typename FlagTupleT,
+           typename InputPtrTupleT,
+           typename OutputPtrTupleT,
+           size_t... Is,
+           size_t... Os>
+  void runValuesInternal(const InputPtrTupleT&  inputs,
+                         const OutputPtrTupleT& outputs,
+                         size_t                 begin,
+                         size_t                 end,
+                         std::index_sequence<Is...>,
+                         std::index_sequence<Os...>) const
+  {
+    for (size_t i = begin; i < end; i++) {
+      mFunc(std::get<Is>(inputs)[std::tuple_element_t<Is, FlagTupleT>::value ? 0 : i]...,
+            std::get<Os>(outputs)[i]...);
+    }
+  }
+
+  /**
+   * @brief Runs the function once per value, without traversing the combinations, if all
+   * the inputs are single values or flat lists. This is only possible when all the
+   * arguments are single values.
+   *
+   * @return size_t The number of times the function was called. Zero if the inputs are
+   * not flat, in which case the outputs are not touched.
+   */
+  template<size_t... Is, size_t... Os>
+  inline size_t runElementwise(std::index_sequence<Is...>,
+                               std::index_sequence<Os...>) const
+  {
+    if (!(isFlat(*(std::get<Is>(mInputs).mData)) && ...)) {
+      return 0;
+    }
+    const std::array<size_t, NInputs> sizes = {std::get<Is>(mInputs).mData->size()...};
+    size_t       n     = *std::max_element(sizes.begin(), sizes.end());
+    data::DepthT depth = std::max({std::get<Is>(mInputs).mData->maxDepth()...});
+    clearOutputs();
+    // Same structure as the outputs written by the combinations.
+    ((std::get<Os>(mOutputs).emplace_back(depth), std::get<Os>(mOutputs).resize(n)), ...);
+    auto outputs = std::make_tuple(std::get<Os>(mOutputs).values().data()...);
+    // The range of values is split where the shorter inputs run out of values, and start
+    // repeating their last value.
+    std::array<size_t, NInputs> ends = sizes;
+    std::sort(ends.begin(), ends.end());
+    size_t begin = 0;
+    for (size_t end : ends) {
+      if (end == begin) {
+        continue;
+      }
+      std::array<bool, NInputs> isConstant = {(sizes[Is] <= begin)...};
+      auto                      inputs     = std::make_tuple(
+        (std::get<Is>(mInputs).mData->values().data() +
+         (isConstant[Is] ? sizes[Is] - 1 : 0))...);
+      runValues(inputs, outputs, isConstant, begin, end);
+      begin = end;
+    }
+    return n;
+  }
+
+  template<size_t... Is, size_t... Os>
+  void runErasedValues(std::span<const ElementArray> inputs,
+                       std::span<const ElementArray> outputs,
+                       size_t                        n,
+                       std::index_sequence<Is...>,
+                       std::index_sequence<Os...>) const
+  {
+    const std::array<bool, NInputs> isConstant = {inputs[Is].mIsConstant...};
+    auto src = std::make_tuple(static_cast<const ArgValueT<Is>*>(inputs[Is].mData)...);
+    auto dst =
+      std::make_tuple(static_cast<ArgValueT<NInputs + Os>*>(outputs[Os].mData)...);
+    runValues(src, dst, isConstant, 0, n);
+  }
+
+  template<size_t N = 0>
+  bool flatInputInternal(size_t input, FlatTree& dst) const
+  {
+    if constexpr (N < NInputs) {
+      if (input != N) {
+        return flatInputInternal<N + 1>(input, dst);
+      }
+      const auto& tree = *(std::get<N>(mInputs).mData);
+      if (!isFlat(tree)) {
+        return false;
+      }
+      dst = {tree.values().data(),
+             tree.size(),
+             sizeof(typename std::remove_cvref_t<decltype(tree)>::ValueType),
+             tree.maxDepth()};
+      return true;
+    }
+    else {
+      return false;
+    }
+  }
+
+  /**
+   * @brief Writes the outputs of a fused chain that ends with this function.
+   *
+   * @return size_t The number of values written.
+   */
+  template<size_t... Os>
+  inline size_t runFused(const FusedChain& chain, std::index_sequence<Os...>) const
+  {
+    size_t       n     = chain.size();
+    data::DepthT depth = chain.depth();
+    clearOutputs();
+    ((std::get<Os>(mOutputs).emplace_back(depth), std::get<Os>(mOutputs).resize(n)), ...);
+    const std::array<void*, NOutputs> outputs = {
+      static_cast<void*>(std::get<Os>(mOutputs).values().data())...};
+    chain.run(outputs);
+    return n;
+  }
+
+  /**
+   * @brief Appends the signature of the part of the N-th input tree that is read by the
+   * current combination: the number of leaves, their versions, and the depths that
+   * describe their structure. Returns false if the tree doesn't have leaf versions.
+   */
+  template<size_t N>
+  inline bool appendSignature(std::vector<uint64_t>& dst) const
+  {
+    using ArgT           = std::remove_const_t<typename TArgList::template Type<N>>;
+    const auto& tree     = *(std::get<N>(mInputs).mData);
+    const auto& versions = tree.leafVersions();
+    if (versions.size() != tree.size()) {
+      return false;
+    }
+    size_t begin = 0;
+    size_t first = 0;
+    size_t end   = tree.size();
+    if constexpr (!IsInstance<data::Tree, ArgT>::value) {
+      begin = std::min(mCombinations.template currentIndex<N>(), end);
+      if (begin < end) {
+        end = std::min(end, begin + tree.stride(begin, mCombinations.viewDepth(N)));
+      }
+      // The depth of the first leaf is the position of the node in the tree, which is not
+      // visible to the function.
+      first = std::min(begin + 1, end);
+    }
+    dst.push_back(end - begin);
+    dst.insert(dst.end(), versions.begin() + begin, versions.begin() + end);
+    dst.insert(dst.end(), tree.depths().begin() + first, tree.depths().begin() + end);
+    return true;
+  }
+
+  template<size_t... Is>
+  inline bool inputSignature(std::vector<uint64_t>& dst, std::index_sequence<Is...>) const
+  {
+    return (appendSignature<Is>(dst) && ...);
+  }
+
+  /**
+   * @brief Assigns versions to the leaves appended to the output trees by the current
+   * combination. The leaves of a combination that was reused from the previous run get
+   * the same versions as before.
+   */
+  template<size_t N = 0>
+  inline void appendLeafVersions(CombinationResult& result) const
+  {
+    if constexpr (N < NOutputs) {
+      auto&  tree     = std::get<N>(mOutputs);
+      auto&  versions = tree.leafVersions();
+      size_t begin    = versions.size();
+      if (tree.size() > begin) {
+        if (result.mLeafVersions[N] == 0) {
+          result.mLeafVersions[N] = newLeafVersions(tree.size() - begin);
+        }
+        versions.resize(tree.size());
+        std::iota(versions.begin() + begin, versions.end(), result.mLeafVersions[N]);
+      }
+      appendLeafVersions<N + 1>(result);
+    }
+  }
+
+  /**
+   * @brief Runs all combinations of inputs, reusing the outputs from the previous run for
+   * the combinations whose inputs didn't change. The inputs of all combinations are
+   * gathered first, along with the versions of the leaves they read. The function is run
+   * only for the combinations that didn't appear in the previous run, in parallel if
+   * enabled, writing into private outputs. Then the combinations are traversed again
+   * serially, and the private outputs are copied into the output trees, so the output
+   * trees are exactly the same as after running serially. With fewer than two
+   * combinations, there is nothing to reuse, because the function only runs when its
+   * inputs changed, so it runs serially instead of copying private outputs.
+   *
+   * @return size_t The number of combinations the function was called for.
+   */
+  inline size_t runIncremental() const
+  {
+    auto& inputs   = mScratch.mInputs;
+    auto& results  = mScratch.mResults;
+    auto& previous = mScratch.mPrevious;
+    auto& pending  = mScratch.mPending;
+    auto& unused   = mScratch.mUnused;
+    auto& isUsed   = mScratch.mIsUsed;
+    // The inputs hold read-views into the input trees, which must be released even if the
+    // function throws.
+    struct InputsGuard
+    {
+      decltype(inputs)& mInputs;
+      ~InputsGuard() { mInputs.clear(); }
+    } guard {inputs};
+    clearOutputs();
+    mCombinations.init();
+    if (!mCombinations.empty()) {
+      size_t i = 0;
+      do {
+        inputs.push_back(
+          mCombinations.template currentInputs<typename ParallelT::InputArgTupleT>());
+        // Reuse the results left over from the previous run, if any.
+        if (i == results.size()) {
+          results.emplace_back();
+        }
+        CombinationResult& result = results[i++];
+        result.mSignature.clear();
+        result.mLeafVersions = {};
+        result.mValid =
+          inputSignature(result.mSignature, std::make_index_sequence<NInputs> {});
+        if (result.mValid) {
+          result.mHash = cache::Hasher()
+                           .add((const char*)(result.mSignature.data()),
+                                result.mSignature.size() * sizeof(uint64_t))
+                           .key()
+                           .mHash[0];
+        }
+      } while (mCombinations.next());
+      results.resize(i);
+    }
+    else {
+      results.clear();
+    }
+    if (results.size() < 2) {
+      // The results of the previous run would only hold on to a copy of the outputs.
+      inputs.clear();
+      results.clear();
+      mResults.clear();
+      return runSerial();
+    }
+    previous.clear();
+    for (size_t i = 0; i < mResults.size(); i++) {
+      if (mResults[i].mValid) {
+        previous.emplace_back(mResults[i].mHash, i);
+      }
+    }
+    std::sort(previous.begin(), previous.end());
+    pending.clear();
+    isUsed.assign(mResults.size(), false);
+    for (size_t i = 0; i < results.size(); i++) {
+      CombinationResult& result = results[i];
+      bool               reused = false;
+      if (result.mValid) {
+        auto match = std::lower_bound(
+          previous.begin(), previous.end(), std::make_pair(result.mHash, size_t(0)));
+        if (match != previous.end() && match->first == result.mHash &&
+            mResults[match->second].mSignature == result.mSignature) {
+          const CombinationResult& prev = mResults[match->second];
+          result.mOutputs               = prev.mOutputs;
+          result.mLeafVersions          = prev.mLeafVersions;
+          isUsed[match->second]         = true;
+          reused                        = true;
+        }
+      }
+      if (!reused) {
+        pending.push_back(i);
+      }
+    }
+    // The pending combinations write into the outputs of the previous results that are
+    // not reused, instead of allocating new ones. The output trees were cleared above, so
+    // these outputs are usually not shared anymore.
+    unused.clear();
+    for (size_t i = 0; i < mResults.size(); i++) {
+      if (!isUsed[i]) {
+        unused.push_back(i);
+      }
+    }
+    for (size_t i = 0; i < pending.size(); i++) {
+      auto& outputs = results[pending[i]].mOutputs;
+      if (i < unused.size()) {
+        CombinationResult& prev = mResults[unused[i]];
+        outputs                 = std::move(prev.mOutputs);
+        // The outputs are gone, so this result must not be matched if this run fails.
+        prev.mValid = false;
+      }
+      ParallelT::recycle(outputs);
+    }
+    auto runPending = [&](size_t i) {
+      size_t ci = pending[i];
+      std::apply(mFunc,
+                 std::tuple_cat(inputs[ci], ParallelT::outputArgs(results[ci].mOutputs)));
+    };
+    if (pending.size() > 1 && session().parallelEvaluation()) {
+      tbb::parallel_for(size_t(0), pending.size(), runPending);
+    }
+    else {
+      for (size_t i = 0; i < pending.size(); i++) {
+        runPending(i);
+      }
+    }
+    inputs.clear();
+    clearOutputs();
+    mCombinations.init();
+    if (!mCombinations.empty()) {
+      size_t i = 0;
+      do {
+        ArgTupleT args = mCombinations.template current<ArgTupleT>();
+        ParallelT::splice(results[i].mOutputs, args, mOutputs);
+        appendLeafVersions(results[i++]);
+      } while (mCombinations.next());
+    }
+    // The results of the previous run are kept in the scratch space, to be overwritten in
+    // the next run. Their outputs are reset, so they don't hold on to the old values.
+    std::swap(mResults, results);
+    for (auto& result : results) {
+      ParallelT::recycle(result.mOutputs);
+    }
+    return pending.size();
+  }
+
+  template<size_t... Is>
+  inline bool inputsChanged(std::index_sequence<Is...>) const
+  {
+    return ((std::get<Is>(mInputs).version() != mInputVersions[Is]) || ...);
+  }
+
+  template<size_t... Is>
+  inline void recordInputVersions(std::index_sequence<Is...>) const
+  {
+    ((mInputVersions[Is] = std::get<Is>(mInputs).version()), ...);
+  }
 
-/**
- * @brief Wraps the output tuple of the function in registers and returns a python tuple
- * of registers.
- *
- * @tparam OutputTupleT The output tuple type.
- * @param fn The function that owns the outputs.
- * @param src The output tuple. It is the source of the wrapped register tuple.
- * @return py::tuple
- */
-template<typename OutputTupleT>
-py::tuple pythonOutputTuple(const Function* fn, const OutputTupleT& src)
-{
-  return pythonOutputTupleInternal(
-    fn, src, std::make_index_sequence<std::tuple_size_v<OutputTupleT>> {});
-}
+  template<size_t N = 0>
+  inline void stashOutputs(OutputTupleT& dst) const
+  {
+    if constexpr (N < NOutputs) {
+      using T = typename std::tuple_element_t<N, OutputTupleT>::Type;
+      auto& tree = std::get<N>(mOutputs);
+      if constexpr (IsCheapToCompare<T>::value) {
+        // Swapping with the stash, instead of moving into it, lets the new outputs reuse
+        // the memory of the stash.
+        std::swap(std::get<N>(dst), tree);
+        tree.clear();
+      }
+      else {
+        // Only the structure and the leaf versions are compared.
+        std::get<N>(dst).depths() = std::as_const(tree).depths();
+        std::swap(std::get<N>(dst).leafVersions(), tree.leafVersions());
+        tree.leafVersions().clear();
+      }
+      stashOutputs<N + 1>(dst);
+    }
+  }
 
-template<typename... Ts>
-struct EmptyCallable
-{
-  void operator()(typename ImplFnArgType<Ts>::Type...) const {};
-};
+  template<size_t N = 0>
+  inline void updateVersions(const OutputTupleT& prev,
+                             bool                force,
+                             uint64_t&           version) const
+  {
+    if constexpr (N < NOutputs) {
+      using T              = typename std::tuple_element_t<N, OutputTupleT>::Type;
+      auto&       tree     = std::get<N>(mOutputs);
+      const auto& old      = std::get<N>(prev);
+      auto&       versions = tree.leafVersions();
+      if (versions.size() != tree.size()) {
+        versions.resize(tree.size());
+        std::iota(versions.begin(), versions.end(), newLeafVersions(tree.size()));
+      }
+      // Read through a const reference, so the values are not copied if they are shared,
+      // and the index of the depths is not expired.
+      const auto& cur     = std::as_const(tree);
+      bool        changed = force || mVersions[N] == 0 || cur.depths() != old.depths();
+      if constexpr (IsCheapToCompare<T>::value) {
+        // Leaves that didn't change keep their versions.
+        const auto& values      = cur.values();
+        const auto& oldVersions = old.leafVersions();
+        if (oldVersions.size() == old.size()) {
+          for (size_t i = 0; i < std::min(values.size(), old.size()); i++) {
+            if (values[i] == old.values()[i]) {
+              versions[i] = oldVersions[i];
+            }
+          }
+        }
+        changed = changed || values != old.values();
+      }
+      else {
+        changed = changed || versions != old.leafVersions();
+      }
+      if (changed) {
+        if (version == 0) {
+          Session& owner = session();
+          version        = HasInputs ? owner.revision() : owner.newRevision();
+        }
+        mVersions[N] = version;
+      }
+      updateVersions<N + 1>(prev, force, version);
+    }
+  }
 
-/**
- * @brief Template for all non-variable functions.
- * @tparam NInputs Number of inputs.
- * @tparam TArgs All arguments. Inputs followed by outputs.
- */
-template<typename TCallable, typename... TArgs>
-struct TFunction : public Function
-{
-  using TArgList                  = TypeList<TArgs...>;
-  static constexpr size_t NInputs = TArgList::NumInputs;
-  using ArgTupleT                 = typename TArgList::ArgTupleType;
-  using ArgTreeRefTupleT          = typename TArgList::ArgTreeRefTupleT;
-  using InputRegTupleT            = typename TArgList::InputRegTupleType;
-  using OutputTupleT              = typename TArgList::OutputTupleType;
-  static constexpr size_t NArgs   = TArgList::NumTypes;
-  static_assert(NInputs <= NArgs,
-                "Number of inputs is larger than the number of arguments!");
-  static constexpr bool   HasInputs   = NInputs > 0;
-  static constexpr size_t NOutputs    = NArgs - NInputs;
-  static constexpr bool   NOutputsGT1 = NOutputs > 1;
-  static constexpr bool   NOutputsGT0 = NOutputs > 0;
-  static constexpr bool   NOutputsEQ0 = NOutputs == 0;
+  // Runs the function for all combinations of inputs, and returns the number of
+  // combinations the function was called for.
+  inline size_t compute() const
+  {
+    if constexpr (IsElementwise) {
+      size_t n = runElementwise(std::make_index_sequence<NInputs> {},
+                                std::make_index_sequence<NOutputs> {});
+      if (n > 0) {
+        return n;
+      }
+    }
+    if constexpr (ParallelT::IsSupported) {
+      if (info().mIsPure) {
+        return runIncremental();
+      }
+    }
+    return runSerial();
+  }
 
-  using PyOutputType = std::conditional_t<
-    NOutputsEQ0,
-    void,
-    std::conditional_t<
-      NOutputsGT1,
-      py::tuple,
-      /* The ternary expression is just in case NOutputs is zero, to make
-         sure the code will still compile. It should never lead to a wrong type index
-         being used because NOutputs == 0 case is already handled above. */
-      ArgRegisterT<typename TArgList::template Type<(NOutputsGT0 ? NInputs : 0)>>>>;
+  template<size_t... Is>
+  cache::Key cacheKey(std::index_sequence<Is...>) const
+  {
+    cache::Hasher hasher;
+    hasher.add(typeId()).add(info().mCacheVersion);
+    auto addTree = [&](const auto& tree) {
+      hasher.add(Serial<std::remove_cvref_t<decltype(tree)>>::serialize(tree));
+    };
+    (addTree(*(std::get<Is>(mInputs).mData)), ...);
+    return hasher.key();
+  }
 
-  using ExpirationT =
-    std::conditional_t<HasInputs, bool, std::vector<std::reference_wrapper<bool>>>;
+  template<size_t... Is>
+  Bytes serializeOutputs(std::index_sequence<Is...>) const
+  {
+    Bytes bytes;
+    (bytes << ... << std::get<Is>(mOutputs));
+    return bytes;
+  }
 
-private:
-  /* Some fields are marked mutable because the function is considered changed only if the
-   * inputs are changed. Running the function, which changes the output, or the status of
-   * the dirty-flag, is not considered changing.
-   */
-  TCallable                                                               mFunc;
-  mutable OutputTupleT                                                    mOutputs;
-  InputRegTupleT                                                          mInputs;
-  mutable data::repeat::Combinations<NInputs, ArgTreeRefTupleT, TArgs...> mCombinations;
-  mutable ExpirationT                                                     mExpiration;
+  template<size_t... Is>
+  void deserializeOutputs(Bytes& bytes, std::index_sequence<Is...>) const
+  {
+    (bytes >> ... >> std::get<Is>(mOutputs));
+  }
 
-  template<size_t N = 0>
-  inline void clearOutputs() const
+  /**
+   * @brief Loads the outputs from the cache if the function ran with the same inputs
+   * before, possibly in an earlier session. Otherwise runs the function and adds the
+   * outputs to the cache.
+   */
+  inline size_t runCached() const
   {
-    if constexpr (NInputs + N < NArgs) {
-      std::get<N>(mOutputs).clear();
-    }
-    if constexpr (NInputs + N + 1 < NArgs) {
-      clearOutputs<N + 1>();
+    cache::Key key = cacheKey(std::make_index_sequence<NInputs> {});
+    Bytes      bytes;
+    if (cache::load(key, bytes)) {
+      try {
+        deserializeOutputs(bytes, std::make_index_sequence<NOutputs> {});
+        return 0;
+      }
+      catch (const std::exception& e) {
+        logger().warn(
+          "Unable to read the cached outputs of {}: {}", info().mName, e.what());
+      }
     }
+    size_t n = compute();
+    cache::store(key, serializeOutputs(std::make_index_sequence<NOutputs> {}));
+    return n;
   }
 
-  // Runs the function.
-  inline void run() const
+  template<size_t... Os>
+  const void* outputTreeInternal(size_t                output,
+                                 const std::type_info& type,
+                                 std::index_sequence<Os...>) const
   {
-    if constexpr (!IsInstance<EmptyCallable, TCallable>::value) {
-      clearOutputs();
-      mCombinations.init();
-      if (!mCombinations.empty()) {
-        do {
-          std::apply(mFunc, mCombinations.template current<ArgTupleT>());
-        } while (mCombinations.next());
+    const void* tree = nullptr;
+    ((Os == output && typeid(std::get<Os>(mOutputs)) == type &&
+      (tree = &std::get<Os>(mOutputs))),
+     ...);
+    return tree;
+  }
+
+  template<size_t... Is>
+  static InputRegTupleT restoreInputs(std::span<const InputInfo> inputs,
+                                      std::index_sequence<Is...>)
+  {
+    return InputRegTupleT(std::tuple_element_t<Is, InputRegTupleT>::fromOutput(
+      inputs[Is].mFunc, inputs[Is].mOutputIdx)...);
+  }
+
+  // Runs the function, using the cache if enabled, and returns the number of
+  // combinations the function was called for.
+  inline size_t execute() const
+  {
+    if constexpr (IsCacheable) {
+      if (info().mIsCached && cache::enabled()) {
+        return runCached();
       }
     }
+    return compute();
+  }
+
+  /**
+   * @brief Number of values in the outputs, and their approximate size in bytes.
+   */
+  template<size_t... Is>
+  std::pair<uint64_t, uint64_t> outputSize(std::index_sequence<Is...>) const
+  {
+    uint64_t nElements = 0;
+    uint64_t nBytes    = 0;
+    auto     addTree   = [&](const auto& tree) {
+      using TreeT = std::remove_cvref_t<decltype(tree)>;
+      static constexpr size_t ValueSize =
+        sizeof(typename TreeT::ValueType) +
+        (TreeT::IsPolymorphic ? sizeof(typename TreeT::Type) : 0);
+      nElements += tree.size();
+      nBytes += tree.size() * ValueSize + tree.depths().size() * sizeof(data::DepthT);
+    };
+    (addTree(std::get<Is>(mOutputs)), ...);
+    return {nElements, nBytes};
   }
 
-  // Calls update on all the upstream functions.
-  inline void updateUpstream() const
+  // Runs the function with the given executor, which returns the number of combinations
+  // the function was called for, and records the run in the profile if profiling is
+  // enabled.
+  template<typename TExecutor>
+  inline void run(const TExecutor& executor) const
   {
-    std::apply([](const auto&... inputs) { (inputs.mOwner->update(), ...); }, mInputs);
+    if constexpr (!IsInstance<EmptyCallable, TCallable>::value) {
+      if (!session().profiling()) {
+        executor();
+        return;
+      }
+      profile::Duration duration;
+      size_t            nCombinations = 0;
+      {
+        Timer timer(std::string(info().mName), &duration);
+        nCombinations = executor();
+      }
+      auto [nElements, nBytes] = outputSize(std::make_index_sequence<NOutputs> {});
+      profile::record(*this, duration, nCombinations, nElements, nBytes);
+    }
   }
 
 protected:
   OutputTupleT& outputs() { return mOutputs; }
 
+  /**
+   * @brief Calls the writer, which overwrites the outputs, and updates the versions of
+   * the outputs that changed. Outputs of types that are cheap to compare are compared
+   * with their previous values, so an output that did not change keeps its version, and
+   * the functions downstream of it do not run again. Leaves of the outputs that were not
+   * given versions by the writer get new versions.
+   *
+   * @param writer Callable that writes the outputs.
+   * @param force Treat all outputs as changed.
+   */
+  template<typename TWriter>
+  void writeOutputs(const TWriter& writer, bool force = false) const
+  {
+    OutputTupleT& prev = mScratch.mStash;
+    stashOutputs(prev);
+    writer();
+    uint64_t version = 0;
+    updateVersions(prev, force, version);
+    // Clearing keeps the memory for the next time.
+    std::apply([](auto&... trees) { (trees.clear(), ...); }, prev);
+  }
+
 public:
   /**
    * @brief Creates a new instance of the function.
@@ -530,12 +1770,7 @@ public:
       , mOutputs()
       , mInputs(inputs)
       , mCombinations(makeArgTreeRefTuple<TArgList>(mInputs, mOutputs))
-  {
-    if constexpr (HasInputs) {
-      mExpiration = true;
-      this->addSubscriber(mExpiration);
-    }
-  };
+  {}
 
   virtual ~TFunction() = default;
 
@@ -544,56 +1779,123 @@ public:
   TFunction& operator=(TFunction const&) = delete;
   TFunction& operator=(TFunction&&)      = delete;
 
-  void expire() const
+  bool isExpired() const override
   {
-    if constexpr (!HasInputs) {
-      // Expire all downstream functions.
-      for (bool& flag : mExpiration) {
-        // cppcheck-suppress useStlAlgorithm
-        flag = true;
-      }
+    if constexpr (HasInputs) {
+      return mVerifiedAt != session().revision();
+    }
+    else {
+      return false;
+    }
+  }
+
+  void update() const override
+  {
+    if (isExpired()) {
+      const Function* self = this;
+      evaluate({&self, 1});
     }
   }
 
-  void unexpire() const
+  void updateLocal() const override
   {
     if constexpr (HasInputs) {
-      mExpiration = false;
+      uint64_t rev = session().revision();
+      if (mVerifiedAt == rev) {
+        return;
+      }
+      // The inputs were not read if the function last ran as part of a fused chain.
+      if (mVerifiedAt == 0 || !mFusedSignature.empty() ||
+          inputsChanged(std::make_index_sequence<NInputs> {})) {
+        try {
+          // If the previous run failed, the outputs must be treated as changed.
+          writeOutputs([this]() { run([this]() { return execute(); }); },
+                       mVerifiedAt == 0);
+        }
+        catch (...) {
+          mVerifiedAt = 0;
+          throw;
+        }
+        recordInputVersions(std::make_index_sequence<NInputs> {});
+        mFusedSignature.clear();
+      }
+      mVerifiedAt = rev;
     }
   }
 
-  bool isExpired() const
+  bool isElementwise() const override { return IsElementwise && info().mIsPure; }
+
+  bool flatInput(size_t input, FlatTree& dst) const override
   {
-    if constexpr (HasInputs) {
-      return mExpiration;
+    if constexpr (IsElementwise) {
+      return flatInputInternal(input, dst);
     }
     else {
       return false;
     }
   }
 
-  void update() const override
+  size_t outputValueSize(size_t output) const override
   {
-    if (isExpired()) {
-      updateUpstream();
-      run();
-      unexpire();
+    if constexpr (IsElementwise) {
+      return std::apply(
+        [output](const auto&... trees) {
+          const std::array<size_t, NOutputs> sizes = {
+            sizeof(typename std::remove_cvref_t<decltype(trees)>::ValueType)...};
+          return sizes[output];
+        },
+        mOutputs);
+    }
+    else {
+      return 0;
     }
   }
 
-  void addSubscriber(bool& flag) const override
+  void runElements(std::span<const ElementArray> inputs,
+                   std::span<const ElementArray> outputs,
+                   size_t                        n) const override
   {
-    if constexpr (HasInputs) {
-      // Propagate the flag upstream.
-      std::apply(
-        [&flag](const auto&... inputs) { (inputs.mOwner->addSubscriber(flag), ...); },
-        mInputs);
+    if constexpr (IsElementwise) {
+      runErasedValues(inputs,
+                      outputs,
+                      n,
+                      std::make_index_sequence<NInputs> {},
+                      std::make_index_sequence<NOutputs> {});
+    }
+  }
+
+  void updateFused(const FusedChain& chain) const override
+  {
+    if constexpr (IsElementwise) {
+      uint64_t rev = session().revision();
+      if (mVerifiedAt == rev) {
+        return;
+      }
+      if (mVerifiedAt == 0 || chain.signature() != mFusedSignature) {
+        try {
+          writeOutputs(
+            [&]() {
+              run([&]() {
+                return runFused(chain, std::make_index_sequence<NOutputs> {});
+              });
+            },
+            mVerifiedAt == 0);
+        }
+        catch (...) {
+          mVerifiedAt = 0;
+          throw;
+        }
+        mFusedSignature = chain.signature();
+      }
+      mVerifiedAt = rev;
     }
     else {
-      mExpiration.push_back(flag);
+      updateLocal();
     }
   }
 
+  uint64_t version(size_t output) const override { return mVersions[output]; }
+
   void getInputs(std::vector<InputInfo>& dst) const override
   {
     dst.clear();
@@ -606,6 +1908,67 @@ public:
     }
   }
 
+  uint64_t typeId() const override { return makeTypeId(info().mName); }
+
+  const void* outputTree(size_t output, const std::type_info& type) const override
+  {
+    return outputTreeInternal(output, type, std::make_index_sequence<NOutputs> {});
+  }
+
+  bool saveOutputs(Bytes& dst) const override
+  {
+    if constexpr (IsCacheable) {
+      dst = serializeOutputs(std::make_index_sequence<NOutputs> {});
+      return true;
+    }
+    else {
+      return false;
+    }
+  }
+
+  void loadOutputs(Bytes& src) const override
+  {
+    if constexpr (IsCacheable) {
+      writeOutputs(
+        [&]() { deserializeOutputs(src, std::make_index_sequence<NOutputs> {}); },
+        true);
+      if constexpr (HasInputs) {
+        recordInputVersions(std::make_index_sequence<NInputs> {});
+        mVerifiedAt = session().revision();
+      }
+    }
+    else {
+      throw std::logic_error("The outputs of " + std::string(info().mName) +
+                             " cannot be deserialized");
+    }
+  }
+
+  /**
+   * @brief Type id of the instances of this function type with the given name.
+   */
+  static uint64_t makeTypeId(std::string_view name)
+  {
+    cache::Hasher hasher;
+    hasher.add(name);
+    // Instances of a function template have the same name, but different types.
+    (hasher.add(TypeInfo<typename ArgTreeT<std::remove_const_t<TArgs>>::Type>::id), ...);
+    return hasher.key().mHash[0];
+  }
+
+  /**
+   * @brief Creates an instance connected to the given outputs of other functions. This
+   * is used to restore functions from snapshots.
+   */
+  static std::unique_ptr<Function> restore(std::span<const InputInfo> inputs)
+  {
+    if (inputs.size() != NInputs) {
+      throw std::length_error("Expected " + std::to_string(NInputs) + " inputs, found " +
+                              std::to_string(inputs.size()));
+    }
+    return std::make_unique<TFunction>(
+      TCallable {}, restoreInputs(inputs, std::make_index_sequence<NInputs> {}));
+  }
+
   PyOutputType pythonOutputRegs() const
   {
     if constexpr (NOutputs == 1) {
@@ -631,6 +1994,21 @@ public:
 template<typename... TArgs>
 using TFunctionWithFnPtr = TFunction<typename TypeList<TArgs...>::FnPtrType, TArgs...>;
 
+/**
+ * @brief Calls a function known at compile time. Unlike a function pointer stored in the
+ * function object, the calls can be inlined, for example into the loops that run the
+ * function over many values.
+ */
+template<auto FnPtr>
+struct StaticCallable
+{
+  template<typename... Ts>
+  void operator()(Ts&&... args) const
+  {
+    FnPtr(std::forward<Ts>(args)...);
+  }
+};
+
 /**
  * @brief Template for a variable functions.
  * @tparam TVal The type of the value stored in the variable.
@@ -662,19 +2040,30 @@ public:
   explicit TVariable(const py::object& obj)
       : BaseT({}, {})
   {
-    setInternal(obj);
+    this->writeOutputs([&]() { setInternal(obj); });
   }
 
   explicit TVariable(const TVal& val)
       : BaseT({}, {})
   {
-    setInternal(val);
+    this->writeOutputs([&]() { setInternal(val); });
   }
 
   TVariable()
       : BaseT({}, {})
   {}
 
+  /**
+   * @brief Creates an empty variable, whose value is restored from a snapshot.
+   */
+  static std::unique_ptr<Function> restore(std::span<const InputInfo> inputs)
+  {
+    if (!inputs.empty()) {
+      throw std::length_error("Variables don't have inputs");
+    }
+    return std::make_unique<TVariable>();
+  }
+
   virtual ~TVariable() = default;
 
   TVariable(TVariable const&)            = delete;
@@ -684,16 +2073,12 @@ public:
 
   void set(const py::object& obj)
   {
-    this->expire();
-    setInternal(obj);
-    this->unexpire();
+    this->writeOutputs([&]() { setInternal(obj); });
   }
 
   void set(const TVal& val)
   {
-    this->expire();
-    setInternal(val);
-    this->unexpire();
+    this->writeOutputs([&]() { setInternal(val); });
   }
 };
 
@@ -716,6 +2101,17 @@ TFunc* makeFunction(const FuncInfo& fnInfo, const TArgs&... args)
 
 }  // namespace store
 
+namespace snapshot {
+
+template<typename TFunc>
+void registerType(const FuncInfo& info)
+{
+  static_assert(std::is_base_of_v<Function, TFunc>, "Not a valid function type");
+  registerType(TFunc::makeTypeId(info.mName), info, typeid(TFunc), &TFunc::restore);
+}
+
+}  // namespace snapshot
+
 template<typename T>
 FuncInfo varfnInfo()
 {
@@ -793,6 +2189,32 @@ void bindOverloads(py::module&                             m,
   }
 }
 
+/**
+ * @brief Binds a function to python, and registers its type for snapshots.
+ */
+template<typename TFunc, typename TFnPtr>
+void bindFunction(py::module&          m,
+                  const FuncInfo&      fnInfo,
+                  TFnPtr               fn,
+                  const FuncDocString& doc)
+{
+  snapshot::registerType<TFunc>(fnInfo);
+  m.def(fnInfo.mName.data(), fn, doc.c_str());
+}
+
+/**
+ * @brief Registers the type of an overload for snapshots, and returns what is needed to
+ * bind it with bindOverloads.
+ */
+template<typename TFunc, typename TFnPtr>
+std::pair<TFnPtr, const FuncDocString*> overload(const FuncInfo&      fnInfo,
+                                                 TFnPtr               fn,
+                                                 const FuncDocString* doc)
+{
+  snapshot::registerType<TFunc>(fnInfo);
+  return std::make_pair(fn, doc);
+}
+
 }  // namespace python
 
 }  // namespace func
@@ -888,7 +2310,8 @@ void bindOverloads(py::module&                             m,
     gal::func::python::FuncDocString(sFnInfo_##fnName);
 
 // NOLINTNEXTLINE
-#define GAL_FN_INFO_DECL(fnName, fnDesc, inputArgs, outputArgs)                \
+#define GAL_FN_INFO_DECL(                                                      \
+  isPure, isCached, cacheVersion, fnName, fnDesc, inputArgs, outputArgs)       \
   static auto sInputNames_##fnName =                                           \
     gal::utils::makeArray<std::string_view>(GAL_EXPAND_ARG_NAMES(inputArgs));  \
   static auto sInputDescriptions_##fnName =                                    \
@@ -905,25 +2328,32 @@ void bindOverloads(py::module&                             m,
     sInputDescriptions_##fnName.data(),                                        \
     sOutputNames_##fnName.size(),                                              \
     sOutputNames_##fnName.data(),                                              \
-    sOutputDescriptions_##fnName.data()};
+    sOutputDescriptions_##fnName.data(),                                       \
+    isPure,                                                                    \
+    isCached,                                                                  \
+    cacheVersion};
 
 // Declartion of a gal function.
 // NOLINTNEXTLINE
-#define GAL_FUNC(fnName, fnDesc, inputArgs, outputArgs)                                  \
-  GAL_FN_INFO_DECL(fnName, fnDesc, inputArgs, outputArgs);                               \
+#define GAL_FUNC_IMPL_DECL(                                                              \
+  isPure, isCached, cacheVersion, fnName, fnDesc, inputArgs, outputArgs)                 \
+  GAL_FN_INFO_DECL(                                                                      \
+    isPure, isCached, cacheVersion, fnName, fnDesc, inputArgs, outputArgs);              \
   GAL_PY_FN_DOC_STR(fnName)                                                              \
   GAL_FN_IMPL(fnName, inputArgs, outputArgs);                                            \
+  using fnType_##fnName =                                                                \
+    gal::func::TFunction<gal::func::StaticCallable<&GAL_FN_IMPL_NAME(fnName)>,           \
+                         GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),                         \
+                         GAL_EXPAND_TYPE_TUPLE(outputArgs)>;                             \
   static gal::func::TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),           \
                                        GAL_EXPAND_TYPE_TUPLE(outputArgs)>::PyOutputType  \
     py_##fnName(GAL_EXPAND_PY_REGISTER_ARGS inputArgs)                                   \
   {                                                                                      \
     using namespace gal::func;                                                           \
-    using FType = TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),             \
-                                     GAL_EXPAND_TYPE_TUPLE(outputArgs)>;                 \
-    auto fn =                                                                            \
-      store::makeFunction<FType>(sFnInfo_##fnName,                                       \
-                                 GAL_FN_IMPL_NAME(fnName),                               \
-                                 std::make_tuple(GAL_EXPAND_REG_NAMES inputArgs));       \
+    using CallableT = StaticCallable<&GAL_FN_IMPL_NAME(fnName)>;                         \
+    using FType     = fnType_##fnName;                                                   \
+    auto fn         = store::makeFunction<FType>(                                        \
+      sFnInfo_##fnName, CallableT {}, std::make_tuple(GAL_EXPAND_REG_NAMES inputArgs));  \
     return fn->pythonOutputRegs();                                                       \
   };                                                                                     \
   static constexpr gal::func::TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs), \
@@ -947,48 +2377,85 @@ void bindOverloads(py::module&                             m,
 #define GAL_EXPAND_TEMPL_ARGS(...) MAP_LIST(GAL_TEMPL_ARG, __VA_ARGS__)     // NOLINT
 
 // NOLINTNEXTLINE
-#define GAL_FUNC_TEMPLATE(tparams, fnName, fnDesc, inputArgs, outputArgs)               \
-  GAL_FN_INFO_DECL(fnName, fnDesc, inputArgs, outputArgs);                              \
-  GAL_PY_FN_DOC_STR(fnName)                                                             \
-  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                             \
-  GAL_FN_IMPL(fnName, inputArgs, outputArgs);                                           \
-  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                             \
-  static typename gal::func::TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs), \
-                                                GAL_EXPAND_TYPE_TUPLE(outputArgs)>::    \
-    PyOutputType py_##fnName(GAL_EXPAND_PY_REGISTER_ARGS inputArgs)                     \
-  {                                                                                     \
-    using namespace gal::func;                                                          \
-    using FType = TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),            \
-                                     GAL_EXPAND_TYPE_TUPLE(outputArgs)>;                \
-    auto fn     = store::makeFunction<FType>(                                           \
-      sFnInfo_##fnName,                                                             \
-      GAL_FN_IMPL_NAME(fnName) < GAL_EXPAND_TEMPL_ARGS tparams >,                   \
-      std::make_tuple(GAL_EXPAND_REG_NAMES inputArgs));                             \
-    return fn->pythonOutputRegs();                                                      \
-  };                                                                                    \
-  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                             \
-  static constexpr                                                                      \
-    typename gal::func::TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),      \
-                                           GAL_EXPAND_TYPE_TUPLE(outputArgs)>::         \
-      PyOutputType (*pyfnptr_##fnName)(GAL_EXPAND_PY_REGISTER_TYPES inputArgs) =        \
-        &py_##fnName<GAL_EXPAND_TEMPL_ARGS tparams>;                                    \
-  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                             \
+#define GAL_FUNC_TEMPL_IMPL_DECL(isPure, tparams, fnName, fnDesc, inputArgs, outputArgs) \
+  GAL_FN_INFO_DECL(isPure, false, 0, fnName, fnDesc, inputArgs, outputArgs);             \
+  GAL_PY_FN_DOC_STR(fnName)                                                              \
+  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                              \
+  GAL_FN_IMPL(fnName, inputArgs, outputArgs);                                            \
+  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                              \
+  using fnType_##fnName = gal::func::TFunction<                                          \
+    gal::func::StaticCallable<&GAL_FN_IMPL_NAME(fnName)<GAL_EXPAND_TEMPL_ARGS tparams>>, \
+    GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),                                              \
+    GAL_EXPAND_TYPE_TUPLE(outputArgs)>;                                                  \
+  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                              \
+  static typename gal::func::TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),  \
+                                                GAL_EXPAND_TYPE_TUPLE(outputArgs)>::     \
+    PyOutputType py_##fnName(GAL_EXPAND_PY_REGISTER_ARGS inputArgs)                      \
+  {                                                                                      \
+    using namespace gal::func;                                                           \
+    using CallableT =                                                                    \
+      StaticCallable<&GAL_FN_IMPL_NAME(fnName)<GAL_EXPAND_TEMPL_ARGS tparams>>;          \
+    using FType = fnType_##fnName<GAL_EXPAND_TEMPL_ARGS tparams>;                        \
+    auto fn     = store::makeFunction<FType>(                                            \
+      sFnInfo_##fnName, CallableT {}, std::make_tuple(GAL_EXPAND_REG_NAMES inputArgs));  \
+    return fn->pythonOutputRegs();                                                       \
+  };                                                                                     \
+  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                              \
+  static constexpr                                                                       \
+    typename gal::func::TFunctionWithFnPtr<GAL_EXPAND_CONST_TYPE_TUPLE(inputArgs),       \
+                                           GAL_EXPAND_TYPE_TUPLE(outputArgs)>::          \
+      PyOutputType (*pyfnptr_##fnName)(GAL_EXPAND_PY_REGISTER_TYPES inputArgs) =         \
+        &py_##fnName<GAL_EXPAND_TEMPL_ARGS tparams>;                                     \
+  template<GAL_EXPAND_TEMPL_PARAMS tparams>                                              \
   GAL_FN_IMPL(fnName, inputArgs, outputArgs)
 
-// Creates a python binding for the function.
+// Declaration of a gal function.
+// NOLINTNEXTLINE
+#define GAL_FUNC(fnName, fnDesc, inputArgs, outputArgs) \
+  GAL_FUNC_IMPL_DECL(false, false, 0, fnName, fnDesc, inputArgs, outputArgs)
+
+// Declaration of a pure gal function, i.e. one that only reads its inputs and writes its
+// outputs. The combinations of inputs of a pure function are run in parallel.
+// NOLINTNEXTLINE
+#define GAL_PURE_FUNC(fnName, fnDesc, inputArgs, outputArgs) \
+  GAL_FUNC_IMPL_DECL(true, false, 0, fnName, fnDesc, inputArgs, outputArgs)
+
+// Declaration of a cached gal function. Cached functions are pure, and their outputs are
+// stored in the result cache, if the cache is enabled. They should be used for expensive
+// functions whose inputs and outputs are cheap to serialize in comparison. The version is
+// part of the cache key, and must be incremented whenever a change to the implementation
+// changes the outputs, so that the outputs cached by the older implementation are not
+// reused.
+// NOLINTNEXTLINE
+#define GAL_CACHED_FUNC(fnName, version, fnDesc, inputArgs, outputArgs) \
+  GAL_FUNC_IMPL_DECL(true, true, version, fnName, fnDesc, inputArgs, outputArgs)
+
+// NOLINTNEXTLINE
+#define GAL_FUNC_TEMPLATE(tparams, fnName, fnDesc, inputArgs, outputArgs) \
+  GAL_FUNC_TEMPL_IMPL_DECL(false, tparams, fnName, fnDesc, inputArgs, outputArgs)
+
 // NOLINTNEXTLINE
-#define GAL_FN_BIND(fnName, module) \
-  module.def(#fnName, pyfnptr_##fnName, pyfnInfo_##fnName.c_str())
+#define GAL_PURE_FUNC_TEMPLATE(tparams, fnName, fnDesc, inputArgs, outputArgs) \
+  GAL_FUNC_TEMPL_IMPL_DECL(true, tparams, fnName, fnDesc, inputArgs, outputArgs)
 
+// Creates a python binding for the function, and registers its type for snapshots.
 // NOLINTNEXTLINE
-#define _GAL_FN_OVERLOAD_DATA(fnName) std::make_pair(pyfnptr_##fnName, &pyfnInfo_##fnName)
+#define GAL_FN_BIND(fnName, module)                 \
+  gal::func::python::bindFunction<fnType_##fnName>( \
+    module, sFnInfo_##fnName, pyfnptr_##fnName, pyfnInfo_##fnName)
+
+// NOLINTNEXTLINE
+#define _GAL_FN_OVERLOAD_DATA(fnName)           \
+  gal::func::python::overload<fnType_##fnName>( \
+    sFnInfo_##fnName, pyfnptr_##fnName, &pyfnInfo_##fnName)
 // NOLINTNEXTLINE
 #define GAL_FN_BIND_OVERLOADS(module, fnName, ...) \
   gal::func::python::bindOverloads(                \
     module, #fnName, MAP_LIST(_GAL_FN_OVERLOAD_DATA, __VA_ARGS__))
 // NOLINTNEXTLINE
-#define GAL_FN_BIND_TEMPLATE(fnName, module, ...) \
-  module.def(#fnName, pyfnptr_##fnName<__VA_ARGS__>, pyfnInfo_##fnName.c_str())
+#define GAL_FN_BIND_TEMPLATE(fnName, module, ...)                \
+  gal::func::python::bindFunction<fnType_##fnName<__VA_ARGS__>>( \
+    module, sFnInfo_##fnName, pyfnptr_##fnName<__VA_ARGS__>, pyfnInfo_##fnName)
 
 // Forward declaration of the module initializer, which will be defined by boost later.
 // This should be called before running scripts from within C++.
@@ -1012,11 +2479,35 @@ namespace python {
 template<typename T>
 py::object read(const Register<T>& reg)
 {
+  {
+    // Other python threads, for example evaluating other sessions, can run meanwhile.
+    py::gil_scoped_release release;
+    reg.owner()->update();
+  }
   py::object dst;
   Converter<data::Tree<T>, py::object>::assign(reg.read(), dst);
   return dst;
 }
 
+/**
+ * @brief Can be used from python to read the value inside a register as NumPy arrays of
+ * values and depths, without copying the values. Only works for types that can be shared
+ * with NumPy.
+ *
+ * @tparam T The source datatype (register).
+ * @param reg The register.
+ * @return py::tuple The values array, and the depths array.
+ */
+template<typename T>
+py::tuple readArray(const Register<T>& reg)
+{
+  {
+    py::gil_scoped_release release;
+    reg.owner()->update();
+  }
+  return treeToArrays(reg.read());
+}
+
 template<typename T>
 void assign(const Register<T>& reg, const py::object& src)
 {
@@ -1062,6 +2553,7 @@ struct defClass
     static const std::string sVarEmptyDesc =
       "Create an empty variable of the type " + TypeInfo<T>::name() + ".";
 
+    snapshot::registerType<TVariable<T>>(varInfo);
     mod.def(varInfo.mName.data(), py_varWithValue<T>, sVarDesc.c_str());
     mod.def(varInfo.mName.data(), py_varEmpty<T>, sVarEmptyDesc.c_str());
     // Read value into python if conversion is available.
@@ -1070,7 +2562,14 @@ struct defClass
       read<T>,
       "Read the data from the variable. This might cause all or some of the upstream "
       "functions to be evaluated.");
-    // Assign values to registers.
+    if constexpr (ArrayTraits<T>::IsSupported) {
+      mod.def("readArray",
+              readArray<T>,
+              "Read the data from the variable as a tuple of NumPy arrays, the values "
+              "and the depths. The values are not copied, and the array is read-only.");
+    }
+    // Assign values to registers. NumPy arrays are accepted for the types that can be
+    // shared with NumPy.
     mod.def("assign", assign<T>, "Assign the given value to the variable");
   }
 };
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+namespace gal {
+namespace func {
+
+struct Function;
+
+namespace profile {
+
+using Duration = std::chrono::nanoseconds;
+
+/**
+ * @brief Statistics of a function, accumulated over all the runs since profiling was
+ * enabled or reset.
+ */
+struct Stats
+{
+  uint64_t mNumRuns = 0;
+  // Combinations of inputs the function was called for. Combinations whose outputs were
+  // reused from the previous run, or loaded from the cache, are not counted.
+  uint64_t mNumCombinations = 0;
+  Duration mTotalTime       = Duration::zero();
+  Duration mLastTime        = Duration::zero();
+  // Number of values in all the outputs after the last run.
+  uint64_t mNumElements = 0;
+  // Approximate size of the outputs after the last run. This only counts the values
+  // themselves, and not the memory owned by them, such as the buffers of a mesh.
+  uint64_t mNumBytes = 0;
+};
+
+struct Record
+{
+  const Function* mFunc;
+  Stats           mStats;
+};
+
+/**
+ * @brief Enables or disables profiling of the current session. Profiling is disabled by
+ * default. When it is disabled, the only overhead is checking the flag of the session
+ * every time a function runs.
+ */
+void setEnabled(bool flag);
+
+bool enabled();
+
+/**
+ * @brief Clears the statistics of all functions in the current session.
+ */
+void reset();
+
+/**
+ * @brief Adds a run of the function to its statistics. This is called by the function
+ * after it runs, if profiling is enabled.
+ *
+ * @param fn The function.
+ * @param time Time taken by the run.
+ * @param nCombinations Number of combinations of inputs the function was called for.
+ * @param nElements Number of values in all the outputs.
+ * @param nBytes Approximate size of the outputs.
+ */
+void record(const Function& fn,
+            Duration        time,
+            uint64_t        nCombinations,
+            uint64_t        nElements,
+            uint64_t        nBytes);
+
+/**
+ * @brief Statistics of all the functions in the current session that ran at least once,
+ * sorted by the total time in descending order.
+ */
+std::vector<Record> records();
+
+}  // namespace profile
+}  // namespace func
+}  // namespace gal
@@ -22,6 +22,7 @@ struct IProperty
   virtual void   swap(size_t i, size_t j) = 0;
   virtual size_t size() const             = 0;
 
+  IProperty()          = default;
   virtual ~IProperty() = default;
 
   IProperty(IProperty const&)            = delete;
@@ -38,6 +39,7 @@ struct Properties
 {
   int    add(IProperty* ptr);
   void   remove(int idx);
+  void   replace(int idx, IProperty* ptr);
   void   clear();
   void   reserve(size_t n);
   void   resize(size_t n);
@@ -104,6 +106,9 @@ public:
     mData      = std::move(other.mData);
     mContainer = std::exchange(other.mContainer, nullptr);
     mIndex     = std::exchange(other.index(), -1);
+    if (mContainer) {
+      mContainer->replace(mIndex, this);
+    }
     return *this;
   }
   Property(Property&& other) { *this = std::move(other); }
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <Serialization.h>
+
+namespace gal {
+namespace func {
+namespace cache {
+
+namespace fs = std::filesystem;
+
+static constexpr uint64_t DefaultMaxBytes = uint64_t(1) << 30;
+
+/**
+ * @brief 128 bit hash that identifies a cached result.
+ */
+struct Key
+{
+  std::array<uint64_t, 2> mHash = {};
+
+  /**
+   * @brief Hexadecimal representation of the key, used as the name of the cache entry.
+   */
+  std::string str() const;
+
+  bool operator==(const Key& other) const = default;
+};
+
+/**
+ * @brief Incrementally hashes bytes into a cache key. The bytes are consumed in 64 bit
+ * words by two independent lanes, so hashing large inputs is cheap compared to the
+ * functions whose results are cached.
+ */
+class Hasher
+{
+public:
+  Hasher() = default;
+
+  Hasher& add(const char* data, size_t nBytes);
+
+  Hasher& add(const Bytes& bytes);
+
+  Hasher& add(std::string_view str);
+
+  template<typename T>
+  Hasher& add(const T& value)
+  {
+    static_assert(IsValueType<T>::value, "Must be a fundamental type");
+    return add((const char*)(&value), sizeof(T));
+  }
+
+  Key key() const;
+
+private:
+  std::array<uint64_t, 2> mLanes  = {0x9e3779b97f4a7c15, 0xc2b2ae3d27d4eb4f};
+  uint64_t                mWord   = 0;
+  uint64_t                mLength = 0;
+
+  void mix(uint64_t word);
+};
+
+/**
+ * @brief Enables the cache and stores the entries in the given directory. Entries that
+ * already exist in the directory, for example from a previous session, are reused. When
+ * the total size of the entries exceeds the limit, the least recently used entries are
+ * deleted.
+ *
+ * @param dir The cache directory. It is created if it doesn't exist.
+ * @param maxBytes Limit on the total size of the entries.
+ */
+void setDirectory(const fs::path& dir, uint64_t maxBytes = DefaultMaxBytes);
+
+/**
+ * @brief Disables the cache. The entries on disk are kept.
+ */
+void disable();
+
+bool enabled();
+
+/**
+ * @brief Deletes all the entries in the cache directory.
+ */
+void clear();
+
+/**
+ * @brief Loads the cached bytes with the given key.
+ *
+ * @param key The key.
+ * @param dst The cached bytes are written here.
+ * @return true If the entry was found.
+ * @return false If the cache is disabled, or the entry doesn't exist or is unreadable.
+ */
+bool load(const Key& key, Bytes& dst);
+
+/**
+ * @brief Stores the bytes in the cache. Failing to write the entry is not an error, it
+ * is logged and ignored.
+ */
+void store(const Key& key, const Bytes& src);
+
+/**
+ * @brief Key of data read from a file. The key depends on the path, the size and the
+ * last write time of the file, so a file that changed gets a new key.
+ *
+ * @param name Name of the reader, to distinguish different data read from the same file.
+ * @param version Version of the reader, incremented when a change to the reader changes
+ * the data it returns.
+ * @param path Path to the file.
+ */
+Key fileKey(std::string_view name, uint32_t version, const fs::path& path);
+
+/**
+ * @brief Reads data from a file, using the cached result if the file didn't change
+ * since it was last read.
+ *
+ * @param name Name of the reader.
+ * @param version Version of the reader.
+ * @param path Path to the file.
+ * @param reader Callable that reads the file and returns the data.
+ */
+template<typename T, typename TReader>
+T readFile(std::string_view name,
+           uint32_t         version,
+           const fs::path&  path,
+           const TReader&   reader)
+{
+  static_assert(Serial<T>::value, "The data must be serializable");
+  if (!enabled() || !fs::is_regular_file(path)) {
+    return reader();
+  }
+  Key   key = fileKey(name, version, path);
+  Bytes bytes;
+  if (load(key, bytes)) {
+    try {
+      return Serial<T>::deserialize(bytes);
+    }
+    catch (const std::exception&) {
+      // The entry is overwritten below.
+    }
+  }
+  T data = reader();
+  store(key, Serial<T>::serialize(data));
+  return data;
+}
+
+}  // namespace cache
+}  // namespace func
+}  // namespace gal
@@ -24,7 +24,7 @@
   uint8_t, int32_t, uint64_t, float, gal::Bool, std::string, glm::vec3, glm::vec2,    \
     gal::Sphere, gal::Plane, gal::Box3, gal::Box2, gal::PointCloud<3>, gal::Circle2d, \
     gal::Line2d, gal::Line3d, gal::TriMesh, gal::PolyMesh, gal::TextAnnotations,      \
-    gal::Glyph, gal::GlyphAnnotations
+    gal::Glyph, gal::GlyphAnnotations, gal::VoxelGrid
 
 namespace gal {
 namespace func {
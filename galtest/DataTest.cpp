@@ -33,6 +33,109 @@ TEST_CASE("Data - CreateTree", "[tree][create]")  // NOLINT
   }
 }
 
+TEST_CASE("Data - CopyOnWrite", "[tree][copy]")  // NOLINT
+{
+  const auto tree = testTree();
+  auto       copy = tree;
+  REQUIRE(copy.sharesValuesWith(tree));
+  // Changing the depths doesn't copy the values.
+  copy.graft();
+  REQUIRE(copy.sharesValuesWith(tree));
+  REQUIRE(copy.maxDepth() == tree.maxDepth() + 1);
+  copy.flatten();
+  REQUIRE(copy.sharesValuesWith(tree));
+  REQUIRE(std::as_const(copy).values() == tree.values());
+  // Changing the values of the copy doesn't change the original.
+  copy.value(3) = -1;
+  REQUIRE_FALSE(copy.sharesValuesWith(tree));
+  REQUIRE(copy.value(3) == -1);
+  REQUIRE(tree.value(3) == 3);
+  // Clearing the original doesn't clear the copy.
+  auto copy2 = tree;
+  auto tree2 = tree;
+  tree2.clear();
+  REQUIRE(tree2.empty());
+  REQUIRE(copy2.size() == tree.size());
+  tree2.push_back(0, 42);
+  REQUIRE(copy2.value(0) == 0);
+}
+
+struct PolymorphicValue
+{
+  std::vector<int> mItems;
+
+  virtual ~PolymorphicValue() = default;
+
+  void clear() { mItems.clear(); }
+};
+
+TEST_CASE("Data - RecycleValues", "[tree][recycle]")  // NOLINT
+{
+  Tree<PolymorphicValue> tree;
+  tree.emplace_back(0);
+  tree.value(0)->mItems = {1, 2, 3};
+  const auto* ptr       = tree.value(0).get();
+  // The value is cleared in place and reused after clearing, so it keeps its memory.
+  tree.clear();
+  tree.emplace_back(0);
+  REQUIRE(tree.value(0).get() == ptr);
+  REQUIRE(tree.value(0)->mItems.empty());
+  REQUIRE(tree.value(0)->mItems.capacity() >= 3);
+  // Values shared with another tree are not reused.
+  auto copy = tree;
+  tree.clear();
+  tree.emplace_back(0);
+  REQUIRE(tree.value(0).get() != ptr);
+  REQUIRE(copy.value(0).get() == ptr);
+}
+
+static size_t bruteForceStride(const Tree<int>& tree, size_t pos, DepthT depth)
+{
+  if (depth > tree.depth(pos)) {
+    return tree.size() - pos;
+  }
+  else if (depth == 0) {
+    return 1;
+  }
+  for (size_t i = pos + 1; i < tree.size(); i++) {
+    if (tree.depth(i) >= depth) {
+      return i - pos;
+    }
+  }
+  return tree.size() - pos;
+}
+
+TEST_CASE("Data - Strides", "[tree][stride]")  // NOLINT
+{
+  const auto tree   = testTree();
+  auto       verify = [](const Tree<int>& t) {
+    for (size_t i = 0; i < t.size(); i++) {
+      for (DepthT d = 0; d <= t.maxDepth() + 1; d++) {
+        REQUIRE(t.stride(i, d) == bruteForceStride(t, i, d));
+      }
+    }
+  };
+  SECTION("Appending")
+  {
+    // Query the strides while the tree is being written.
+    Tree<int> dst;
+    for (size_t i = 0; i < tree.size(); i++) {
+      dst.push_back(tree.depth(i), tree.value(i));
+      verify(dst);
+    }
+  }
+  SECTION("Modified depths")
+  {
+    auto copy = tree;
+    copy.graft();
+    verify(copy);
+    copy.depth(5) = 3;
+    verify(copy);
+    copy.flatten();
+    verify(copy);
+  }
+}
+
 TEST_CASE("Data - ViewIterators", "[tree][iterators]")  // NOLINT
 {
   auto tree = testTree();
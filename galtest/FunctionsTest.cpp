@@ -0,0 +1,483 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Functions.h>
+#include <ResultCache.h>
+
+using namespace gal;
+using namespace gal::func;
+
+/**
+ * @brief Session that is current while it is alive, so the functions created by a test
+ * case belong to the test case, and don't outlive it.
+ */
+struct TestSession : public Session
+{
+  TestSession() { Session::makeCurrent(this); }
+  ~TestSession() { Session::makeCurrent(nullptr); }
+};
+
+static FuncInfo testInfo(std::string_view name, bool isPure)
+{
+  FuncInfo info {};
+  info.mName       = name;
+  info.mNumOutputs = 1;
+  info.mIsPure     = isPure;
+  return info;
+}
+
+template<typename T>
+static TVariable<T>* makeVariable(const T& value)
+{
+  return store::makeFunction<TVariable<T>>(varfnInfo<T>(), value);
+}
+
+template<typename TFunc, auto FnPtr, typename... TInputs>
+static TFunc* makeFunc(std::string_view name,
+                       bool             isPure,
+                       const Register<TInputs>&... inputs)
+{
+  return store::makeFunction<TFunc>(
+    testInfo(name, isPure), StaticCallable<FnPtr> {}, std::make_tuple(inputs...));
+}
+
+static std::atomic<int> sNumSums    = 0;  // NOLINT
+static std::atomic<int> sNumSigns   = 0;  // NOLINT
+static std::atomic<int> sNumDoubles = 0;  // NOLINT
+
+/**
+ * @brief Writes n lists, where the l-th list has l + 2 values. The first value of the
+ * second list is the marker, so changing the marker only changes one list.
+ */
+static void makeLists(const int32_t&            n,
+                      const float&              marker,
+                      data::WriteView<float, 2> lists)
+{
+  for (int32_t l = 0; l < n; l++) {
+    auto list = lists.child();
+    list.resize(size_t(l + 2));
+    for (int32_t i = 0; i < l + 2; i++) {
+      list[i] = (l == 1 && i == 0) ? marker : float(10 * l + i);
+    }
+  }
+}
+
+static void makeRange(const int32_t&            n,
+                      const float&              start,
+                      data::WriteView<float, 1> range)
+{
+  range.resize(size_t(n));
+  for (int32_t i = 0; i < n; i++) {
+    range[i] = start + float(i);
+  }
+}
+
+static void sumList(data::ReadView<float, 1> list, float& total)
+{
+  sNumSums++;
+  total = 0.f;
+  for (float v : list) {
+    total += v;
+  }
+}
+
+static void square(const float& x, float& y)
+{
+  y = x * x;
+}
+
+static void addOne(const float& x, float& y)
+{
+  y = x + 1.f;
+}
+
+static void negate(const float& x, float& y)
+{
+  y = -x;
+}
+
+static void add(const float& a, const float& b, float& c)
+{
+  c = a + b;
+}
+
+/**
+ * @brief Same as add, but also writes a label. The label is not a single value, so this
+ * function runs over the combinations of its inputs instead of looping over the values.
+ */
+static void addWithLabel(const float& a, const float& b, float& c, std::string& label)
+{
+  c     = a + b;
+  label = "sum";
+}
+
+static void countedSign(const float& x, float& y)
+{
+  sNumSigns++;
+  y = x < 0.f ? -1.f : 1.f;
+}
+
+static void countedDouble(const float& x, float& y)
+{
+  sNumDoubles++;
+  y = 2.f * x;
+}
+
+using ListsFn = TFunction<StaticCallable<&makeLists>,
+                          const int32_t,
+                          const float,
+                          data::WriteView<float, 2>>;
+using RangeFn = TFunction<StaticCallable<&makeRange>,
+                          const int32_t,
+                          const float,
+                          data::WriteView<float, 1>>;
+using SumFn =
+  TFunction<StaticCallable<&sumList>, const data::ReadView<float, 1>, float>;
+using SquareFn = TFunction<StaticCallable<&square>, const float, float>;
+using AddOneFn = TFunction<StaticCallable<&addOne>, const float, float>;
+using NegateFn = TFunction<StaticCallable<&negate>, const float, float>;
+using AddFn    = TFunction<StaticCallable<&add>, const float, const float, float>;
+using AddWithLabelFn =
+  TFunction<StaticCallable<&addWithLabel>, const float, const float, float, std::string>;
+using SignFn   = TFunction<StaticCallable<&countedSign>, const float, float>;
+using DoubleFn = TFunction<StaticCallable<&countedDouble>, const float, float>;
+
+static_assert(AddFn::IsElementwise && !AddWithLabelFn::IsElementwise);
+
+TEST_CASE("Functions - ParallelEvaluation", "[functions][parallel]")  // NOLINT
+{
+  // The same graph, with many independent branches, is evaluated serially and in
+  // parallel.
+  auto evalBranches = [](bool parallel) {
+    TestSession session;
+    session.setParallelEvaluation(parallel);
+    auto* count  = makeVariable<int32_t>(32);
+    auto* marker = makeVariable(0.5f);
+    auto* lists  = makeFunc<ListsFn, &makeLists>(
+      "lists", true, count->outputRegister<0>(), marker->outputRegister<0>());
+    std::vector<AddFn*>          targets;
+    std::vector<const Function*> fns;
+    for (int b = 0; b < 16; b++) {
+      auto* sums = makeFunc<SumFn, &sumList>("sum", true, lists->outputRegister<0>());
+      auto* squares =
+        makeFunc<SquareFn, &square>("square", true, sums->outputRegister<0>());
+      auto* offset = makeVariable(float(b));
+      targets.push_back(makeFunc<AddFn, &add>(
+        "add", false, squares->outputRegister<0>(), offset->outputRegister<0>()));
+      fns.push_back(targets.back());
+    }
+    evaluate(fns);
+    std::vector<data::Tree<float>> results;
+    for (AddFn* fn : targets) {
+      REQUIRE_FALSE(fn->isExpired());
+      results.push_back(fn->outputRegister<0>().read());
+    }
+    return results;
+  };
+  auto serial   = evalBranches(false);
+  auto parallel = evalBranches(true);
+  REQUIRE(serial.size() == parallel.size());
+  for (size_t i = 0; i < serial.size(); i++) {
+    REQUIRE(serial[i].depths() == parallel[i].depths());
+    REQUIRE(serial[i].values() == parallel[i].values());
+  }
+  // The first list is {0, 1}.
+  REQUIRE(serial[3].value(0) == 1.f + 3.f);
+}
+
+TEST_CASE("Functions - ParallelCombinations", "[functions][parallel]")  // NOLINT
+{
+  // The combinations of a pure function are written in the order of serial execution,
+  // even if they are run in parallel.
+  auto evalCombinations = [](bool parallel) {
+    TestSession session;
+    session.setParallelEvaluation(parallel);
+    auto* count  = makeVariable<int32_t>(64);
+    auto* marker = makeVariable(0.5f);
+    auto* lists  = makeFunc<ListsFn, &makeLists>(
+      "lists", true, count->outputRegister<0>(), marker->outputRegister<0>());
+    auto* squares =
+      makeFunc<SquareFn, &square>("square", true, lists->outputRegister<0>());
+    auto* sums = makeFunc<SumFn, &sumList>("sum", true, squares->outputRegister<0>());
+    return std::make_pair(squares->outputRegister<0>().read(),
+                          sums->outputRegister<0>().read());
+  };
+  auto [serialSquares, serialSums]     = evalCombinations(false);
+  auto [parallelSquares, parallelSums] = evalCombinations(true);
+  REQUIRE(serialSquares.maxDepth() == 2);
+  REQUIRE(serialSquares.depths() == parallelSquares.depths());
+  REQUIRE(serialSquares.values() == parallelSquares.values());
+  REQUIRE(parallelSums.size() == 64);
+  REQUIRE(serialSums.values() == parallelSums.values());
+  for (size_t l = 2; l < parallelSums.size(); l++) {
+    float expected = 0.f;
+    for (size_t i = 0; i < l + 2; i++) {
+      expected += float((10 * l + i) * (10 * l + i));
+    }
+    REQUIRE(parallelSums.value(l) == expected);
+  }
+}
+
+TEST_CASE("Functions - EarlyCutoff", "[functions][versions]")  // NOLINT
+{
+  TestSession session;
+  sNumSigns   = 0;
+  sNumDoubles = 0;
+  auto* x     = makeVariable(2.f);
+  auto* sign  = makeFunc<SignFn, &countedSign>("sign", false, x->outputRegister<0>());
+  auto* doubled =
+    makeFunc<DoubleFn, &countedDouble>("double", false, sign->outputRegister<0>());
+  auto result = doubled->outputRegister<0>();
+  REQUIRE(result.read().value(0) == 2.f);
+  REQUIRE(sNumSigns == 1);
+  REQUIRE(sNumDoubles == 1);
+  // Setting the same value doesn't change the version of the variable, so nothing runs.
+  uint64_t version = x->version(0);
+  x->set(2.f);
+  REQUIRE(x->version(0) == version);
+  REQUIRE_FALSE(doubled->isExpired());
+  REQUIRE(result.read().value(0) == 2.f);
+  REQUIRE(sNumSigns == 1);
+  REQUIRE(sNumDoubles == 1);
+  // The sign runs again, but its output doesn't change, so the propagation stops there.
+  x->set(3.f);
+  REQUIRE(doubled->isExpired());
+  REQUIRE(result.read().value(0) == 2.f);
+  REQUIRE(sNumSigns == 2);
+  REQUIRE(sNumDoubles == 1);
+  // Changing the sign runs the function downstream of it.
+  x->set(-3.f);
+  REQUIRE(result.read().value(0) == -2.f);
+  REQUIRE(sNumSigns == 3);
+  REQUIRE(sNumDoubles == 2);
+}
+
+TEST_CASE("Functions - ResultCache", "[functions][cache]")  // NOLINT
+{
+  fs::path dir = fs::temp_directory_path() / "galtest_cache";
+  fs::remove_all(dir);
+  cache::setDirectory(dir);
+  cache::Key key = cache::Hasher().add(std::string_view("galtest")).key();
+  fs::path   path = dir / (key.str() + ".galcache");
+  Bytes      src;
+  src << int32_t(42) << 3.5f << uint64_t(1) << 64;
+  auto loadsSource = [&]() {
+    Bytes dst;
+    return cache::load(key, dst) && dst.size() == src.size() &&
+           std::equal(src.data(), src.data() + src.size(), dst.data());
+  };
+  cache::store(key, src);
+  REQUIRE(loadsSource());
+  // The entries are found again when the directory is opened again, like in a new
+  // session.
+  cache::setDirectory(dir);
+  REQUIRE(loadsSource());
+  // A truncated entry is discarded.
+  fs::resize_file(path, fs::file_size(path) - 4);
+  REQUIRE_FALSE(loadsSource());
+  REQUIRE_FALSE(fs::exists(path));
+  // An entry with a corrupt header is discarded.
+  cache::store(key, src);
+  REQUIRE(loadsSource());
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.put(0);
+  }
+  REQUIRE_FALSE(loadsSource());
+  REQUIRE_FALSE(fs::exists(path));
+  cache::disable();
+  fs::remove_all(dir);
+}
+
+TEST_CASE("Functions - CacheVersion", "[functions][cache]")  // NOLINT
+{
+  fs::path dir = fs::temp_directory_path() / "galtest_cache_version";
+  fs::remove_all(dir);
+  cache::setDirectory(dir);
+  sNumDoubles = 0;
+  // Each run creates a new session, so the outputs can only come from the cache.
+  auto runDouble = [](uint32_t version) {
+    TestSession session;
+    FuncInfo    info = testInfo("cachedDouble", true);
+    info.mIsCached     = true;
+    info.mCacheVersion = version;
+    auto* x            = makeVariable(3.f);
+    auto* doubled      = store::makeFunction<DoubleFn>(
+      info, StaticCallable<&countedDouble> {}, std::make_tuple(x->outputRegister<0>()));
+    return doubled->outputRegister<0>().read().value(0);
+  };
+  REQUIRE(runDouble(1) == 6.f);
+  REQUIRE(sNumDoubles == 1);
+  REQUIRE(runDouble(1) == 6.f);
+  REQUIRE(sNumDoubles == 1);
+  // A new version of the implementation doesn't reuse the outputs of the old one.
+  REQUIRE(runDouble(2) == 6.f);
+  REQUIRE(sNumDoubles == 2);
+  REQUIRE(runDouble(2) == 6.f);
+  REQUIRE(sNumDoubles == 2);
+  cache::disable();
+  fs::remove_all(dir);
+}
+
+TEST_CASE("Functions - Profiling", "[functions][profile]")  // NOLINT
+{
+  // Profiling is a setting of the session, so only the runs in the profiled session are
+  // recorded.
+  auto runSquare = [](bool profiling) {
+    TestSession session;
+    session.setProfiling(profiling);
+    auto* x = makeVariable(3.f);
+    auto* y = makeFunc<SquareFn, &square>("square", true, x->outputRegister<0>());
+    REQUIRE(y->outputRegister<0>().read().value(0) == 9.f);
+    REQUIRE(profile::enabled() == profiling);
+    return profile::records();
+  };
+  auto records = runSquare(true);
+  REQUIRE(records.size() == 1);
+  REQUIRE(records.front().mStats.mNumRuns == 1);
+  REQUIRE(records.front().mStats.mNumCombinations == 1);
+  REQUIRE(runSquare(false).empty());
+  REQUIRE_FALSE(profile::enabled());
+}
+
+TEST_CASE("Functions - IncrementalCombinations", "[functions][incremental]")  // NOLINT
+{
+  TestSession session;
+  sNumSums     = 0;
+  auto* count  = makeVariable<int32_t>(4);
+  auto* marker = makeVariable(0.5f);
+  auto* lists  = makeFunc<ListsFn, &makeLists>(
+    "lists", true, count->outputRegister<0>(), marker->outputRegister<0>());
+  auto* sums = makeFunc<SumFn, &sumList>("sum", true, lists->outputRegister<0>());
+  auto  result = sums->outputRegister<0>();
+  REQUIRE(result.read().size() == 4);
+  REQUIRE(sNumSums == 4);
+  std::vector<float> before(result.read().values().begin(), result.read().values().end());
+  // Only the list that contains the marker is summed again.
+  marker->set(7.5f);
+  REQUIRE(result.read().value(1) == before[1] + 7.f);
+  REQUIRE(sNumSums == 5);
+  for (size_t i : {0, 2, 3}) {
+    REQUIRE(result.read().value(i) == before[i]);
+  }
+  // Only the new list is summed.
+  count->set(5);
+  REQUIRE(result.read().size() == 5);
+  REQUIRE(result.read().value(4) == 40.f + 41.f + 42.f + 43.f + 44.f + 45.f);
+  REQUIRE(sNumSums == 6);
+}
+
+TEST_CASE("Functions - ElementwiseLists", "[functions][elementwise]")  // NOLINT
+{
+  // Lists of different lengths are combined in a single loop over their values. The
+  // results must be the same as when running over the combinations, where the shorter
+  // lists repeat their last value.
+  TestSession session;
+  auto range = [](int32_t n, float start) {
+    auto* count = makeVariable(n);
+    auto* first = makeVariable(start);
+    return makeFunc<RangeFn, &makeRange>(
+             "range", true, count->outputRegister<0>(), first->outputRegister<0>())
+      ->outputRegister<0>();
+  };
+  auto five  = range(5, 0.f);
+  auto three = range(3, 10.f);
+  auto one   = makeVariable(100.f)->outputRegister<0>();
+  std::vector<std::pair<Register<float>, Register<float>>> pairs = {
+    {five, three}, {three, five}, {five, one}, {one, five}, {one, one}};
+  for (const auto& [a, b] : pairs) {
+    auto flat     = makeFunc<AddFn, &add>("add", true, a, b)->outputRegister<0>();
+    auto combined = makeFunc<AddWithLabelFn, &addWithLabel>("add", true, a, b);
+    const auto& expected = combined->outputRegister<0>().read();
+    REQUIRE(flat.read().depths() == expected.depths());
+    REQUIRE(flat.read().values() == expected.values());
+  }
+}
+
+TEST_CASE("Functions - Fusion", "[functions][fusion]")  // NOLINT
+{
+  // The same chain of functions, fused and not fused. Impure functions are never fused.
+  TestSession session;
+  auto* count = makeVariable<int32_t>(5000);
+  auto* start = makeVariable(-2500.f);
+  auto* range = makeFunc<RangeFn, &makeRange>(
+    "range", true, count->outputRegister<0>(), start->outputRegister<0>());
+  std::vector<const Function*> targets;
+  std::vector<AddOneFn*>       middles;
+  std::vector<NegateFn*>       lasts;
+  for (bool isPure : {true, false}) {
+    auto* squares =
+      makeFunc<SquareFn, &square>("square", isPure, range->outputRegister<0>());
+    auto* middle =
+      makeFunc<AddOneFn, &addOne>("add_one", isPure, squares->outputRegister<0>());
+    auto* last =
+      makeFunc<NegateFn, &negate>("negate", isPure, middle->outputRegister<0>());
+    middles.push_back(middle);
+    lasts.push_back(last);
+    targets.push_back(last);
+  }
+  evaluate(targets);
+  const auto& fused   = lasts[0]->outputRegister<0>().read();
+  const auto& unfused = lasts[1]->outputRegister<0>().read();
+  REQUIRE(fused.size() == 5000);
+  REQUIRE(fused.depths() == unfused.depths());
+  REQUIRE(fused.values() == unfused.values());
+  REQUIRE(fused.value(0) == -(2500.f * 2500.f + 1.f));
+  // The intermediate functions of the fused chain are not run, and are brought up to date
+  // when they are read.
+  REQUIRE(middles[0]->isExpired());
+  REQUIRE_FALSE(middles[1]->isExpired());
+  const auto& middle = middles[0]->outputRegister<0>().read();
+  REQUIRE_FALSE(middles[0]->isExpired());
+  REQUIRE(middle.depths() == middles[1]->outputRegister<0>().read().depths());
+  REQUIRE(middle.values() == middles[1]->outputRegister<0>().read().values());
+}
+
+TEST_CASE("Functions - Snapshot", "[functions][snapshot]")  // NOLINT
+{
+  snapshot::registerType<TVariable<int32_t>>(varfnInfo<int32_t>());
+  snapshot::registerType<TVariable<float>>(varfnInfo<float>());
+  snapshot::registerType<ListsFn>(testInfo("lists", true));
+  snapshot::registerType<SumFn>(testInfo("sum", true));
+  TestSession original;
+  auto* count  = makeVariable<int32_t>(6);
+  auto* marker = makeVariable(0.f);
+  auto* lists  = makeFunc<ListsFn, &makeLists>(
+    "lists", true, count->outputRegister<0>(), marker->outputRegister<0>());
+  auto* sums = makeFunc<SumFn, &sumList>("sum", true, lists->outputRegister<0>());
+  // Changed after the variable was created, to check that the value is saved.
+  marker->set(7.5f);
+  const data::Tree<float> expected = sums->outputRegister<0>().read();
+  Bytes                   bytes    = snapshot::save();
+  TestSession             restored;
+  snapshot::load(bytes);
+  REQUIRE(restored.numFunctions() == original.numFunctions());
+  // The inputs are connected to the restored functions.
+  std::vector<InputInfo> inputs;
+  std::vector<InputInfo> originalInputs;
+  for (size_t i = 0; i < restored.numFunctions(); i++) {
+    restored.function(i).getInputs(inputs);
+    original.function(i).getInputs(originalInputs);
+    REQUIRE(inputs.size() == originalInputs.size());
+    for (size_t j = 0; j < inputs.size(); j++) {
+      size_t k = size_t(originalInputs[j].mFunc->index());
+      REQUIRE(inputs[j].mFunc == &restored.function(k));
+      REQUIRE(inputs[j].mOutputIdx == originalInputs[j].mOutputIdx);
+    }
+  }
+  REQUIRE(Register<float>::fromOutput(&restored.function(1), 0).read().value(0) == 7.5f);
+  const auto& result = Register<float>::fromOutput(&restored.function(3), 0).read();
+  REQUIRE(result.depths() == expected.depths());
+  REQUIRE(result.values() == expected.values());
+  // The restored graph is independent of the original.
+  const_cast<TVariable<float>*>(
+    dynamic_cast<const TVariable<float>*>(&restored.function(1)))
+    ->set(0.5f);
+  REQUIRE(Register<float>::fromOutput(&restored.function(3), 0).read().value(1) == 23.5f);
+  REQUIRE(sums->outputRegister<0>().read().value(1) == 30.5f);
+}
@@ -59,3 +59,76 @@ TEST_CASE("Sphere - MinBoundingSphere", "[geom][sphere]")  // NOLINT
     REQUIRE(sp.contains(pt, TOLERANCE));
   }
 }
+
+TEST_CASE("Geom - BatchKernels", "[geom][batch]")  // NOLINT
+{
+  // Large enough to be processed in parallel.
+  static constexpr size_t nPts = 100000;
+  gal::Box3               bounds(glm::vec3(-2.f, -2.f, -2.f), glm::vec3(2.f, 2.f, 2.f));
+  std::vector<glm::vec3>  pts(nPts);
+  bounds.randomPoints(nPts, pts.begin());
+
+  std::vector<uint8_t>   inside(nPts);
+  std::vector<float>     dists(nPts);
+  std::vector<glm::vec3> closest(nPts);
+
+  SECTION("Box")
+  {
+    gal::Box3 box(glm::vec3(-1.f, -.5f, -1.f), glm::vec3(1.f, .5f, 1.5f));
+    box.contains(pts.data(), nPts, inside.data());
+    box.signedDistance(pts.data(), nPts, dists.data());
+    box.closestPoints(pts.data(), nPts, closest.data());
+    for (size_t i = 0; i < nPts; i++) {
+      REQUIRE(bool(inside[i]) == box.contains(pts[i]));
+      REQUIRE((dists[i] <= 0.f) == bool(inside[i]));
+      REQUIRE(box.contains(closest[i]));
+      if (!inside[i]) {
+        REQUIRE(std::abs(glm::distance(pts[i], closest[i]) - dists[i]) < TOLERANCE);
+      }
+    }
+  }
+
+  SECTION("Sphere")
+  {
+    gal::Sphere sphere(glm::vec3(.2f, .1f, -.3f), 1.2f);
+    sphere.contains(pts.data(), nPts, inside.data());
+    sphere.signedDistance(pts.data(), nPts, dists.data());
+    sphere.closestPoints(pts.data(), nPts, closest.data());
+    for (size_t i = 0; i < nPts; i++) {
+      REQUIRE(bool(inside[i]) == sphere.contains(pts[i]));
+      REQUIRE(std::abs(dists[i] - sphere.signedDistance(pts[i])) < TOLERANCE);
+      REQUIRE(std::abs(glm::distance(sphere.center, closest[i]) - sphere.radius) <
+              TOLERANCE);
+    }
+  }
+
+  SECTION("Plane")
+  {
+    gal::Plane plane(glm::vec3(.1f, .2f, .3f), glm::vec3(1.f, 1.f, 1.f));
+    plane.signedDistance(pts.data(), nPts, dists.data());
+    plane.project(pts.data(), nPts, closest.data());
+    for (size_t i = 0; i < nPts; i++) {
+      REQUIRE(std::abs(plane.signedDistance(closest[i])) < TOLERANCE);
+      REQUIRE(glm::distance(closest[i] + plane.normal() * dists[i], pts[i]) < TOLERANCE);
+    }
+  }
+
+  SECTION("Circle2d")
+  {
+    gal::Circle2d          circ(glm::vec2(.3f, -.2f), 1.1f);
+    std::vector<glm::vec2> pts2(nPts);
+    std::transform(pts.begin(), pts.end(), pts2.begin(), [](const glm::vec3& p) {
+      return glm::vec2(p);
+    });
+    std::vector<glm::vec2> closest2(nPts);
+    circ.contains(pts2.data(), nPts, inside.data());
+    circ.signedDistance(pts2.data(), nPts, dists.data());
+    circ.closestPoints(pts2.data(), nPts, closest2.data());
+    for (size_t i = 0; i < nPts; i++) {
+      REQUIRE(bool(inside[i]) == circ.contains(pts2[i]));
+      REQUIRE(std::abs(dists[i] - circ.signedDistance(pts2[i])) < TOLERANCE);
+      REQUIRE(std::abs(glm::distance(circ.center(), closest2[i]) - circ.radius()) <
+              TOLERANCE);
+    }
+  }
+}
@@ -1,7 +1,9 @@
 #include <catch2/catch_all.hpp>
 
 #include <Mesh.h>
+#include <MeshSampling.h>
 #include <TestUtils.h>
+#include <VoxelGrid.h>
 #include <OpenMesh/Core/IO/MeshIO.hh>
 #include <OpenMesh/Tools/Subdivider/Uniform/CatmullClarkT.hh>
 #include <chrono>
@@ -122,3 +124,90 @@ TEST_CASE("Mesh - SphereQuery", "[mesh][query]")  // NOLINT
   auto smesh = mesh.subMesh(indices);
   REQUIRE(Catch::Approx(smesh.area()) == 0.44368880987167358);
 }
+
+TEST_CASE("Mesh - DistanceGrid", "[mesh][voxel]")  // NOLINT
+{
+  auto                   mesh   = unitbox();
+  std::vector<glm::vec3> points = {{.5f, .5f, .5f},
+                                   {.1f, .5f, .5f},
+                                   {.5f, .5f, 1.1f},
+                                   {.5f, -.15f, .5f},
+                                   {1.1f, 1.1f, .5f}};
+  std::vector<float>     expected = {-.5f, -.1f, .1f, .15f, std::sqrt(.02f)};
+  SECTION("Dense")
+  {
+    auto grid = gal::VoxelGrid::fromMesh(mesh, 0.05f, 0.2f, false);
+    REQUIRE(grid.isDense());
+    std::vector<float> distances(points.size());
+    grid.sample(points.data(), points.size(), distances.data());
+    for (size_t i = 0; i < points.size(); i++) {
+      REQUIRE(Catch::Approx(distances[i]).margin(0.03f) == expected[i]);
+      REQUIRE(grid.contains(points[i]) == (expected[i] < 0.f));
+    }
+    gal::Bytes bytes = gal::Serial<gal::VoxelGrid>::serialize(grid);
+    auto       copy  = gal::Serial<gal::VoxelGrid>::deserialize(bytes);
+    REQUIRE(copy.dims() == grid.dims());
+    for (const auto& pt : points) {
+      REQUIRE(copy.sample(pt) == grid.sample(pt));
+    }
+  }
+  SECTION("Sparse")
+  {
+    auto grid = gal::VoxelGrid::fromMesh(mesh, 0.02f, 0.1f, true);
+    REQUIRE(grid.numAllocatedBlocks() < grid.numBlocks());
+    for (size_t i = 0; i < points.size(); i++) {
+      float d = grid.sample(points[i]);
+      REQUIRE(
+        Catch::Approx(d).margin(0.03f) ==
+        std::clamp(expected[i], -grid.bandWidth(), grid.bandWidth()));
+      REQUIRE(grid.contains(points[i]) == (expected[i] < 0.f));
+    }
+  }
+}
+
+TEST_CASE("Mesh - SurfaceSampling", "[mesh][sampling]")  // NOLINT
+{
+  auto mesh = unitbox();
+  auto tris = gal::faceTriangles(mesh);
+  SECTION("Uniform")
+  {
+    static constexpr size_t N       = 120000;
+    auto                    samples = gal::sampleSurface(mesh, N, 42);
+    REQUIRE(samples.size() == N);
+    std::vector<size_t> counts(tris.size(), 0);
+    for (size_t i = 0; i < N; i++) {
+      const auto& t = tris[samples.faces[i]];
+      const auto& b = samples.barycentrics[i];
+      REQUIRE(glm::distance(samples.points[i], t[0] * b[0] + t[1] * b[1] + t[2] * b[2]) <
+              1e-6f);
+      counts[samples.faces[i]]++;
+    }
+    // All the faces have the same area.
+    for (size_t count : counts) {
+      REQUIRE(Catch::Approx(double(count)).epsilon(0.05) == double(N / tris.size()));
+    }
+    // Chunks of samples match the corresponding range of a single call.
+    auto chunk = gal::sampleSurface(mesh, 1000, 42, 5000);
+    for (size_t i = 0; i < chunk.size(); i++) {
+      REQUIRE(chunk.points[i] == samples.points[5000 + i]);
+    }
+  }
+  SECTION("PoissonDisk")
+  {
+    static constexpr float radius  = 0.05f;
+    auto                   samples = gal::samplePoissonDisk(mesh, radius, 7);
+    auto                   repeat  = gal::samplePoissonDisk(mesh, radius, 7);
+    REQUIRE(samples.size() == repeat.size());
+    // The sampling should be close to maximal.
+    REQUIRE(float(samples.size()) * radius * radius > 0.5f * mesh.area());
+    REQUIRE(std::equal(
+      samples.points.begin(), samples.points.end(), repeat.points.begin()));
+    float mind = FLT_MAX;
+    for (size_t i = 0; i < samples.size(); i++) {
+      for (size_t j = i + 1; j < samples.size(); j++) {
+        mind = std::min(mind, glm::distance(samples.points[i], samples.points[j]));
+      }
+    }
+    REQUIRE(mind >= radius);
+  }
+}
@@ -1,5 +1,8 @@
 #include <catch2/catch_all.hpp>
 
+#include <Reduce.h>
+#include <Scan.h>
+#include <Sort.h>
 #include <Util.h>
 #include <array>
 #include <iostream>
@@ -49,6 +52,45 @@ TEST_CASE("Util - Combinations", "[util][combinations]")  // NOLINT
   REQUIRE(count == numCombinations(n, k));
 }
 
+TEST_CASE("Util - CombinationUnranking", "[util][combinations]")  // NOLINT
+{
+  static constexpr size_t n = 20;
+  static constexpr size_t k = 5;
+  const size_t            total = numCombinations(n, k);
+
+  std::array<size_t, n> nums {};
+  std::iota(nums.begin(), nums.end(), size_t(0));
+  std::vector<std::array<size_t, k>> expected;
+  expected.reserve(total);
+  std::array<size_t, k> comb {};
+  combinations(k, nums.begin(), nums.end(), comb.begin(), [&]() {
+    expected.push_back(comb);
+  });
+  REQUIRE(expected.size() == total);
+
+  // Unranking.
+  for (size_t r = 0; r < total; r++) {
+    combinationAt(r, n, k, comb.data());
+    REQUIRE(comb == expected[r]);
+  }
+  REQUIRE_THROWS(combinationAt(total, n, k));
+
+  // Successor.
+  combinationAt(0, n, k, comb.data());
+  for (size_t r = 1; r < total; r++) {
+    REQUIRE(nextCombination(n, k, comb.data()));
+    REQUIRE(comb == expected[r]);
+  }
+  REQUIRE_FALSE(nextCombination(n, k, comb.data()));
+
+  // Parallel enumeration into preallocated slots.
+  std::vector<std::array<size_t, k>> combs(total);
+  parallelCombinations(n, k, [&combs](size_t rank, const size_t* c) {
+    std::copy(c, c + k, combs[rank].begin());
+  });
+  REQUIRE(combs == expected);
+}
+
 TEST_CASE("Util - Bitscan", "[util][bitscan]")  // NOLINT
 {
   // 32 bit integers.
@@ -58,3 +100,140 @@ TEST_CASE("Util - Bitscan", "[util][bitscan]")  // NOLINT
   REQUIRE(21 == bitscanForward(uint64_t(1 << 21)));
   REQUIRE(-1 == bitscanForward(uint64_t(0)));
 }
+
+TEST_CASE("Util - Random", "[util][random]")  // NOLINT
+{
+  static constexpr size_t   nPoints = 200000;
+  static constexpr uint64_t seed    = 42;
+  const glm::vec3           min     = {-1.f, -2.f, -3.f};
+  const glm::vec3           max     = {1.f, 2.f, 3.f};
+
+  // Contiguous destination, generated in parallel.
+  std::vector<glm::vec3> points1(nPoints);
+  random(min, max, nPoints, points1.begin(), seed);
+  // Same seed, must produce identical points.
+  std::vector<glm::vec3> points2(nPoints);
+  random(min, max, nPoints, points2.begin(), seed);
+  REQUIRE(points1 == points2);
+  // Non-contiguous destination, generated serially one sample at a time.
+  std::vector<glm::vec3> points3;
+  points3.reserve(nPoints);
+  random(min, max, nPoints, std::back_inserter(points3), seed);
+  REQUIRE(points1.size() == points3.size());
+  for (size_t i = 0; i < nPoints; i++) {
+    REQUIRE(glm::distance(points1[i], points3[i]) < 1e-6f);
+  }
+  // Generating in chunks must produce the same samples.
+  std::vector<glm::vec3> points4(nPoints);
+  static constexpr size_t nChunk = 777;
+  for (size_t i = 0; i < nPoints; i += nChunk) {
+    random(min, max, std::min(nChunk, nPoints - i), points4.begin() + i, seed, i);
+  }
+  REQUIRE(points1 == points4);
+  // All points must be in range.
+  for (const auto& p : points1) {
+    for (int i = 0; i < 3; i++) {
+      REQUIRE(p[i] >= min[i]);
+      REQUIRE(p[i] <= max[i]);
+    }
+  }
+  // Different seeds must produce different points.
+  std::vector<glm::vec3> points5(nPoints);
+  random(min, max, nPoints, points5.begin(), seed + 1);
+  REQUIRE(points1 != points5);
+  // Integers.
+  std::vector<int32_t> ints(1000);
+  random(int32_t(-5), int32_t(5), ints.size(), ints.begin(), seed);
+  REQUIRE(std::all_of(
+    ints.begin(), ints.end(), [](int32_t i) { return i >= -5 && i < 5; }));
+}
+
+TEST_CASE("Util - Sort", "[util][sort]")  // NOLINT
+{
+  static constexpr size_t nKeys = 200000;
+  std::vector<float>      floats(nKeys);
+  random(-100.f, 100.f, nKeys, floats.begin());
+  // Few distinct keys, to check the order of equal keys.
+  std::vector<int32_t> ints(nKeys);
+  random(int32_t(-5), int32_t(5), nKeys, ints.begin());
+  auto verify = [](const auto& keys, auto less) {
+    using T = typename std::decay_t<decltype(keys)>::value_type;
+    std::vector<size_t> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), size_t(0));
+    std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+      return less(keys[a], keys[b]);
+    });
+    std::vector<size_t> indices(keys.size());
+    argsort(std::span<const T>(keys), std::span<size_t>(indices), less);
+    REQUIRE(indices == expected);
+    std::vector<size_t> top(100);
+    partialArgsort(std::span<const T>(keys), std::span<size_t>(top), less);
+    REQUIRE(std::equal(top.begin(), top.end(), expected.begin()));
+    std::vector<T> sorted(keys.size());
+    gather(keys, std::span<const size_t>(indices), sorted);
+    REQUIRE(std::is_sorted(sorted.begin(), sorted.end(), less));
+  };
+  // Radix sorts.
+  verify(floats, std::less<float>());
+  verify(ints, std::less<int32_t>());
+  // Sample sorts.
+  verify(floats, std::greater<float>());
+  verify(ints, std::greater<int32_t>());
+}
+
+TEST_CASE("Util - Reduce", "[util][reduce]")  // NOLINT
+{
+  // A running sum of these values drifts far from the exact sum.
+  std::vector<float> values(10000000, 0.1f);
+  REQUIRE(std::abs(sum(std::span<const float>(values)) - 1e6f) < 1.f);
+  REQUIRE(std::abs(mean(std::span<const float>(values)) - 0.1f) < 1e-6f);
+  // The variance is small compared to the mean.
+  std::vector<float> offset = {1e4f + 1.f, 1e4f + 2.f, 1e4f + 3.f};
+  REQUIRE(std::abs(variance(std::span<const float>(offset)) - 2.f / 3.f) < 1e-4f);
+  // The first of the equal extreme values is picked.
+  std::vector<int32_t> ints(100000, 5);
+  ints[70000] = 1;
+  ints[500]   = 1;
+  ints[90000] = 9;
+  ints[3]     = 9;
+  REQUIRE(argmin(std::span<const int32_t>(ints)) == 500);
+  REQUIRE(argmax(std::span<const int32_t>(ints)) == 3);
+}
+
+TEST_CASE("Util - Scan", "[util][scan]")  // NOLINT
+{
+  static constexpr size_t nValues = 100000;
+  std::vector<int32_t>    values(nValues);
+  random(int32_t(0), int32_t(3), nValues, values.begin());
+  std::vector<int32_t> expected(nValues);
+  std::inclusive_scan(values.begin(), values.end(), expected.begin());
+  std::vector<int32_t> sums(nValues);
+  inclusiveScan(std::span<const int32_t>(values), std::span<int32_t>(sums));
+  REQUIRE(sums == expected);
+  std::exclusive_scan(values.begin(), values.end(), expected.begin(), 0);
+  // In place.
+  sums = values;
+  exclusiveScan(std::span<const int32_t>(sums), std::span<int32_t>(sums));
+  REQUIRE(sums == expected);
+  // The selected indices are in order, and the rejected indices follow them.
+  auto                isEven = [&](size_t i) { return values[i] % 2 == 0; };
+  std::vector<size_t> indices;
+  size_t              nEven = partitionIndices<true>(nValues, isEven, indices);
+  REQUIRE(indices.size() == nValues);
+  REQUIRE(std::is_sorted(indices.begin(), indices.begin() + nEven));
+  REQUIRE(std::is_sorted(indices.begin() + nEven, indices.end()));
+  REQUIRE(std::all_of(indices.begin(), indices.begin() + nEven, isEven));
+  REQUIRE(std::none_of(indices.begin() + nEven, indices.end(), isEven));
+  // The last of the repeated indices wins.
+  std::vector<size_t> targets(nValues);
+  for (size_t i = 0; i < nValues; i++) {
+    targets[i] = i % 1000;
+  }
+  std::vector<int32_t> dst(1000, -1);
+  std::vector<int32_t> positions(nValues);
+  std::iota(positions.begin(), positions.end(), 0);
+  scatter(positions, std::span<const size_t>(targets), dst, dst.size());
+  for (size_t i = 0; i < dst.size(); i++) {
+    REQUIRE(dst[i] == int32_t(nValues - 1000 + i));
+  }
+}
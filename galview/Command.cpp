@@ -194,6 +194,8 @@ void reload(int argc, char** argv)
     return;
   }
 
+  // The functions cannot be unloaded while they are being evaluated.
+  gal::viewfunc::stopEvaluation();
   gal::viewfunc::unloadAllOutputs();
   gal::func::store::unloadAllFunctions();
   gal::view::Views::clear();
@@ -202,6 +204,7 @@ void reload(int argc, char** argv)
     logger().error("Unable to run the demo file. Aborting...\n");
     std::exit(err);
   }
+  gal::viewfunc::startEvaluation();
 }
 
 void twoDMode(int argc, char** argv)
@@ -1,10 +1,14 @@
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
 
 #include <Annotations.h>
 #include <AnnotationsView.h>
@@ -23,10 +27,70 @@
 namespace gal {
 namespace viewfunc {
 
+/**
+ * @brief Value written by the evaluation thread and read by the render thread. The
+ * evaluation thread writes to the back buffer, and the render thread swaps it with the
+ * front buffer when there is a new value, so neither thread waits for the other to finish
+ * using its buffer.
+ */
+template<typename T>
+class DoubleBuffer
+{
+public:
+  void write(T value)
+  {
+    std::lock_guard lock(mMutex);
+    std::swap(mBack, value);
+    mHasNewValue = true;
+  }
+
+  /**
+   * @brief Swaps the buffers if there is a new value.
+   *
+   * @return const T* The new value, or nullptr if there is none since the last swap.
+   */
+  const T* swap()
+  {
+    std::lock_guard lock(mMutex);
+    if (!mHasNewValue) {
+      return nullptr;
+    }
+    std::swap(mFront, mBack);
+    mHasNewValue = false;
+    return &mFront;
+  }
+
+private:
+  std::mutex mMutex;
+  T          mFront;
+  T          mBack;
+  bool       mHasNewValue = false;
+};
+
+/**
+ * @brief Function whose results are shown in the viewer. The results are computed on the
+ * evaluation thread, and published to the viewer from the render thread.
+ */
+struct Publisher
+{
+  virtual ~Publisher()   = default;
+  virtual void publish() = 0;
+};
+
+// Only modified while the evaluation thread is stopped.
 static std::vector<const func::Function*> sOutputFuncs;  // NOLINT
+static std::vector<Publisher*>            sPublishers;   // NOLINT
 static std::unordered_map<std::string, std::unique_ptr<view::CheckBox>>
   sShowCheckboxes;  // NOLINT
 
+static std::thread                        sEvalThread;          // NOLINT
+static std::mutex                         sEvalMutex;           // NOLINT
+static std::condition_variable            sEvalCondition;       // NOLINT
+static std::vector<std::function<void()>> sInputChanges;        // NOLINT
+static bool                               sNeedsEval  = false;  // NOLINT
+static bool                               sStopEval   = false;  // NOLINT
+static std::atomic<bool>                  sCancelEval = false;  // NOLINT
+
 view::Panel& outputsPanel()
 {
   return view::panelByName("outputs");
@@ -53,10 +117,75 @@ static const view::CheckBox& getCheckBox(const std::string name)
   return *(pair.first->second);
 }
 
-void evalOutputs()
+static void evalLoop()
+{
+  std::vector<std::function<void()>> changes;
+  while (true) {
+    {
+      std::unique_lock lock(sEvalMutex);
+      sEvalCondition.wait(lock, []() { return sNeedsEval || sStopEval; });
+      if (sStopEval) {
+        return;
+      }
+      sNeedsEval  = false;
+      sCancelEval = false;
+      std::swap(changes, sInputChanges);
+    }
+    for (const auto& change : changes) {
+      change();
+    }
+    changes.clear();
+    try {
+      // Evaluate all outputs together, so that independent branches run concurrently.
+      func::evaluate(sOutputFuncs, &sCancelEval);
+    }
+    catch (const std::exception& e) {
+      // The failed functions stay expired, and are run again when the inputs change.
+      gal::view::logger().error("Unable to evaluate the outputs: {}", e.what());
+    }
+  }
+}
+
+void startEvaluation()
 {
-  for (const func::Function* fnptr : sOutputFuncs) {
-    fnptr->update();
+  stopEvaluation();
+  {
+    std::lock_guard lock(sEvalMutex);
+    sStopEval  = false;
+    sNeedsEval = true;
+  }
+  sEvalThread = std::thread(evalLoop);
+}
+
+void stopEvaluation()
+{
+  {
+    std::lock_guard lock(sEvalMutex);
+    sStopEval   = true;
+    sCancelEval = true;
+    sInputChanges.clear();
+  }
+  sEvalCondition.notify_one();
+  if (sEvalThread.joinable()) {
+    sEvalThread.join();
+  }
+}
+
+void queueInputChange(std::function<void()> change)
+{
+  {
+    std::lock_guard lock(sEvalMutex);
+    sInputChanges.push_back(std::move(change));
+    sNeedsEval  = true;
+    sCancelEval = true;
+  }
+  sEvalCondition.notify_one();
+}
+
+void publishOutputs()
+{
+  for (Publisher* publisher : sPublishers) {
+    publisher->publish();
   }
 }
 
@@ -64,6 +193,7 @@ void unloadAllOutputs()
 {
   gal::view::logger().debug("Unloading all output data...");
   sOutputFuncs.clear();
+  sPublishers.clear();
   sShowCheckboxes.clear();
   inputsPanel().clear();
   outputsPanel().clear();
@@ -136,7 +266,7 @@ protected:
   void handleChanges() override
   {
     if (isEdited())
-      this->set(this->value());
+      queueInputChange([this, text = this->value()]() { this->set(text); });
 
     clearEdited();
   }
@@ -181,15 +311,14 @@ struct ShowCallable
 {
   static_assert(view::Views::IsDrawableType<T>, "Must be a drawable type");
 
-  size_t mDrawableIndex;
-
-  ShowCallable(const bool* visibilityFlag)
-      : mDrawableIndex(view::Views::create<T>(visibilityFlag))
-  {}
+  // Shared with the function, which updates the drawable from the render thread.
+  std::shared_ptr<DoubleBuffer<func::data::Tree<T>>> mBuffer =
+    std::make_shared<DoubleBuffer<func::data::Tree<T>>>();
 
   void operator()(const func::data::Tree<T>& objs) const
   {
-    view::Views::update<T>(mDrawableIndex, objs.values());
+    // The copy shares the values with the source tree.
+    mBuffer->write(objs);
   }
 };
 
@@ -200,7 +329,8 @@ struct ShowCallable
  * @tparam T The object to be drawn.
  */
 template<typename T>
-struct ShowFunc : public func::TFunction<ShowCallable<T>, const func::data::Tree<T>>
+struct ShowFunc : public func::TFunction<ShowCallable<T>, const func::data::Tree<T>>,
+                  public Publisher
 {
   static_assert(TypeInfo<T>::value, "Unknown type");
   using BaseT        = func::TFunction<ShowCallable<T>, const func::data::Tree<T>>;
@@ -211,7 +341,7 @@ struct ShowFunc : public func::TFunction<ShowCallable<T>, const func::data::Tree
   ShowFunc(const std::string&       label,
            const bool*              visibilityFlag,
            const func::Register<T>& reg)
-      : BaseT(ShowCallable<T>(visibilityFlag), std::make_tuple(reg))
+      : ShowFunc(ShowCallable<T>(), visibilityFlag, reg)
   {}
 
   virtual ~ShowFunc() = default;
@@ -220,6 +350,25 @@ struct ShowFunc : public func::TFunction<ShowCallable<T>, const func::data::Tree
   ShowFunc(ShowFunc&&)                 = delete;
   ShowFunc& operator=(ShowFunc const&) = delete;
   ShowFunc& operator=(ShowFunc&&)      = delete;
+
+  void publish() override
+  {
+    if (const func::data::Tree<T>* objs = mBuffer->swap()) {
+      view::Views::update<T>(mDrawableIndex, objs->values());
+    }
+  }
+
+private:
+  ShowFunc(const ShowCallable<T>&   callable,
+           const bool*              visibilityFlag,
+           const func::Register<T>& reg)
+      : BaseT(callable, std::make_tuple(reg))
+      , mDrawableIndex(view::Views::create<T>(visibilityFlag))
+      , mBuffer(callable.mBuffer)
+  {}
+
+  size_t                                             mDrawableIndex;
+  std::shared_ptr<DoubleBuffer<func::data::Tree<T>>> mBuffer;
 };
 
 /**
@@ -254,6 +403,7 @@ typename ShowFunc<T>::PyOutputType py_show(const std::string&       label,
   auto fn = gal::func::store::makeFunction<ShowFunc<T>>(
     sInfo, label, getCheckBox(label).checkedPtr(), reg);
   sOutputFuncs.push_back(fn);
+  sPublishers.push_back(fn);
   return dynamic_cast<ShowFunc<T>*>(fn)->pythonOutputRegs();
 }
 
@@ -261,21 +411,19 @@ template<typename T>
 struct PrintCallable
 {
   std::string mLabel;
-  // mutable std::stringstream mStream;
-  gal::view::Text* mTextPtr = nullptr;
+  // Shared with the function, which updates the text from the render thread.
+  std::shared_ptr<DoubleBuffer<std::string>> mBuffer =
+    std::make_shared<DoubleBuffer<std::string>>();
 
-  PrintCallable(const std::string& label, gal::view::Text* textLabelPtr)
+  PrintCallable(const std::string& label)
       : mLabel(label)
-      , mTextPtr(textLabelPtr)
   {}
 
   void operator()(const func::data::Tree<T>& obj) const
   {
     std::stringstream stream;
-    stream.clear();
-    stream.str("");
     stream << mLabel << ": \n" << obj;
-    mTextPtr->value() = stream.str();
+    mBuffer->write(stream.str());
   }
 };
 
@@ -286,20 +434,35 @@ struct PrintCallable
  */
 template<typename T>
 struct PrintFunc : public func::TFunction<PrintCallable<T>, const func::data::Tree<T>>,
-                   public view::Text
+                   public view::Text,
+                   public Publisher
 {
   using BaseT        = func::TFunction<PrintCallable<T>, const func::data::Tree<T>>;
   using PyOutputType = typename BaseT::PyOutputType;
 
   PrintFunc(const std::string& label, const func::Register<T>& reg)
-      : view::Text("")
-      , BaseT(PrintCallable<T>(label, this), std::make_tuple(reg)) {};
+      : PrintFunc(PrintCallable<T>(label), reg) {};
 
   virtual ~PrintFunc()                   = default;
   PrintFunc(PrintFunc const&)            = delete;
   PrintFunc(PrintFunc&&)                 = delete;
   PrintFunc& operator=(PrintFunc const&) = delete;
   PrintFunc& operator=(PrintFunc&&)      = delete;
+
+  void publish() override
+  {
+    if (const std::string* text = mBuffer->swap()) {
+      view::Text::value() = *text;
+    }
+  }
+
+private:
+  PrintFunc(const PrintCallable<T>& callable, const func::Register<T>& reg)
+      : view::Text("")
+      , BaseT(callable, std::make_tuple(reg))
+      , mBuffer(callable.mBuffer) {};
+
+  std::shared_ptr<DoubleBuffer<std::string>> mBuffer;
 };
 
 /**
@@ -332,6 +495,7 @@ typename PrintFunc<T>::PyOutputType py_print(const std::string&       label,
 
   auto fn = gal::func::store::makeFunction<PrintFunc<T>>(sInfo, label, reg);
   sOutputFuncs.push_back(fn);
+  sPublishers.push_back(fn);
   outputsPanel().addWidget(dynamic_cast<view::Widget*>(fn));
   return dynamic_cast<PrintFunc<T>*>(fn)->pythonOutputRegs();
 }
@@ -5,6 +5,7 @@
 #include <Functions.h>
 #include <GLUtil.h>
 #include <GuiFunctions.h>
+#include <Profiler.h>
 #include <Property.h>
 #include <Views.h>
 #include <imgui.h>
@@ -228,6 +229,7 @@ static void initPanels()
   sPanels.emplace_back("outputs");
   sPanels.emplace_back("history", false);
   sPanels.emplace_back("diagnostics", false);
+  sPanels.emplace_back("profile", false);
 }
 
 static auto panelIterByName(const std::string& name)
@@ -283,6 +285,115 @@ int runPythonDemoFile(const fs::path& demoPath)
   }
 }
 
+enum class ProfileColumn : int
+{
+  NAME = 0,
+  CONTEXT,
+  RUNS,
+  COMBINATIONS,
+  TOTAL_TIME,
+  LAST_TIME,
+  ELEMENTS,
+  BYTES,
+  COUNT,
+};
+
+static int compareProfileRecords(const func::profile::Record& a,
+                                 const func::profile::Record& b,
+                                 ProfileColumn                column)
+{
+  auto cmp = [](const auto& x, const auto& y) { return x < y ? -1 : (y < x ? 1 : 0); };
+  switch (column) {
+  case ProfileColumn::NAME:
+    return cmp(a.mFunc->info().mName, b.mFunc->info().mName);
+  case ProfileColumn::CONTEXT:
+    return cmp(a.mFunc->contextpath(), b.mFunc->contextpath());
+  case ProfileColumn::RUNS:
+    return cmp(a.mStats.mNumRuns, b.mStats.mNumRuns);
+  case ProfileColumn::COMBINATIONS:
+    return cmp(a.mStats.mNumCombinations, b.mStats.mNumCombinations);
+  case ProfileColumn::TOTAL_TIME:
+    return cmp(a.mStats.mTotalTime, b.mStats.mTotalTime);
+  case ProfileColumn::LAST_TIME:
+    return cmp(a.mStats.mLastTime, b.mStats.mLastTime);
+  case ProfileColumn::ELEMENTS:
+    return cmp(a.mStats.mNumElements, b.mStats.mNumElements);
+  case ProfileColumn::BYTES:
+    return cmp(a.mStats.mNumBytes, b.mStats.mNumBytes);
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Draws the profile of the functions as a table, that can be sorted by any column.
+ */
+static void drawProfile()
+{
+  bool enabled = func::profile::enabled();
+  if (ImGui::Checkbox("Enabled", &enabled)) {
+    func::profile::setEnabled(enabled);
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Reset")) {
+    func::profile::reset();
+  }
+  static constexpr ImGuiTableFlags sFlags =
+    ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+    ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_ScrollY;
+  if (!ImGui::BeginTable("##profile", int(ProfileColumn::COUNT), sFlags)) {
+    return;
+  }
+  static constexpr ImGuiTableColumnFlags sNumeric =
+    ImGuiTableColumnFlags_PreferSortDescending;
+  ImGui::TableSetupScrollFreeze(0, 1);
+  ImGui::TableSetupColumn("function");
+  ImGui::TableSetupColumn("context");
+  ImGui::TableSetupColumn("runs", sNumeric);
+  ImGui::TableSetupColumn("combinations", sNumeric);
+  ImGui::TableSetupColumn("total (ms)", sNumeric | ImGuiTableColumnFlags_DefaultSort);
+  ImGui::TableSetupColumn("last (ms)", sNumeric);
+  ImGui::TableSetupColumn("elements", sNumeric);
+  ImGui::TableSetupColumn("bytes", sNumeric);
+  ImGui::TableHeadersRow();
+  std::vector<func::profile::Record> records = func::profile::records();
+  const ImGuiTableSortSpecs*         specs   = ImGui::TableGetSortSpecs();
+  if (specs && specs->SpecsCount > 0) {
+    const ImGuiTableColumnSortSpecs& spec = specs->Specs[0];
+    ProfileColumn                    col  = ProfileColumn(spec.ColumnIndex);
+    bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [col, ascending](const auto& a, const auto& b) {
+                       int c = compareProfileRecords(a, b, col);
+                       return ascending ? c < 0 : c > 0;
+                     });
+  }
+  auto toMs = [](func::profile::Duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+  for (const auto& [fn, stats] : records) {
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::Text("%.*s", int(fn->info().mName.size()), fn->info().mName.data());
+    ImGui::TableNextColumn();
+    ImGui::Text("%s", fn->contextpath().string().c_str());
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu", (unsigned long long)(stats.mNumRuns));
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu", (unsigned long long)(stats.mNumCombinations));
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", toMs(stats.mTotalTime));
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", toMs(stats.mLastTime));
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu", (unsigned long long)(stats.mNumElements));
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu", (unsigned long long)(stats.mNumBytes));
+  }
+  ImGui::EndTable();
+}
+
 static std::string  sCmdline        = "";       // NOLINT
 static std::string  sResponse       = "";       // NOLINT
 static std::string* sHistoryPtr     = nullptr;  // NOLINT
@@ -305,6 +416,7 @@ void init(GLFWwindow* window, const char* glslVersion)
     panel.addWidget(text.get());
     sDiagnosticsPtr = &(text->value());
   }
+  panelByName("profile").addCallback(drawProfile);
   initCommands();
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include <glm/detail/qualifier.hpp>
 #include <glm/glm.hpp>
 
@@ -12,7 +14,32 @@ namespace viewfunc {
 
 view::Panel& inputsPanel();
 
-void evalOutputs();
+/**
+ * @brief Starts evaluating the outputs on a background thread, so that slow functions
+ * don't block the render loop. The outputs are evaluated once when the thread starts, and
+ * again every time the inputs are changed.
+ */
+void startEvaluation();
+
+/**
+ * @brief Stops the background evaluation after the function that is running, if any,
+ * finishes. The input changes that were not applied yet are discarded. This must be
+ * called before the functions are unloaded or created.
+ */
+void stopEvaluation();
+
+/**
+ * @brief Queues a change to the inputs, to be applied on the evaluation thread before the
+ * next evaluation. The evaluation in progress is cancelled, so that the latest inputs are
+ * evaluated as soon as possible.
+ */
+void queueInputChange(std::function<void()> change);
+
+/**
+ * @brief Shows the latest evaluated outputs in the viewer. This must be called from the
+ * render thread, once every frame.
+ */
+void publishOutputs();
 
 /**
  * @brief Clears all output registers.
@@ -45,8 +72,9 @@ public:
 protected:
   void handleChanges() override
   {
+    // The variable is only set on the evaluation thread.
     if (this->isEdited())
-      this->set(this->value());
+      queueInputChange([this, value = this->value()]() { this->set(value); });
 
     this->clearEdited();
   };
@@ -74,7 +102,7 @@ protected:
   void handleChanges() override
   {
     if (this->isEdited()) {
-      this->set(this->value());
+      queueInputChange([this, value = this->value()]() { this->set(value); });
     }
     this->clearEdited();
   };
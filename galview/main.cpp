@@ -7,6 +7,7 @@
 #include <Interaction.h>
 #include <Plane.h>
 #include <PointCloud.h>
+#include <ResultCache.h>
 #include <Util.h>
 #include <Views.h>
 #include <pybind11/embed.h>
@@ -97,6 +98,8 @@ int loadDemo(const fs::path& demoPath)
       glutil::logger().error("Unable to run the demo file. Error code {}.", err);
       return err;
     }
+    // The outputs are evaluated in the background, so slow functions don't block the UI.
+    viewfunc::startEvaluation();
     // Render loop.
     glutil::logger().info("Starting the render loop...");
     while (!glfwWindowShouldClose(window)) {
@@ -107,7 +110,7 @@ int loadDemo(const fs::path& demoPath)
       {
         view::draw(window);
         ImGui::Render();
-        viewfunc::evalOutputs();
+        viewfunc::publishOutputs();
         view::Views::render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
       }
@@ -115,8 +118,10 @@ int loadDemo(const fs::path& demoPath)
       gal::view::runQueuedCommands();
       view::reportFrameFinish();
     }
+    viewfunc::stopEvaluation();
   }
   catch (const std::exception& e) {
+    viewfunc::stopEvaluation();
     glutil::logger().critical("Fatal error: {}", e.what());
     err = -1;
   }
@@ -128,12 +133,15 @@ int main(int argc, char** argv)
 {
   cxxopts::Options opts("galview", "Visualize the gal demos written in python");
   fs::path         path;
+  fs::path         cacheDir;
   // clang-format off
   opts
     .allow_unrecognised_options()
     .add_options()
     ("help", "Print help")
-    ("filepath", "Path to the demo file", cxxopts::value<fs::path>(path), "<filepath>");
+    ("filepath", "Path to the demo file", cxxopts::value<fs::path>(path), "<filepath>")
+    ("cache", "Directory to cache the outputs of expensive functions in",
+     cxxopts::value<fs::path>(cacheDir), "<directory>");
   // clang-format on
   opts.positional_help("<path/to/demo/file>");
   opts.parse_positional({"filepath"});
@@ -150,5 +158,14 @@ int main(int argc, char** argv)
     std::cerr << "The given path does not point to a an existing file.\n";
     return 1;
   }
+  if (parsed.count("cache")) {
+    try {
+      func::cache::setDirectory(cacheDir);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "Unable to use the cache directory: " << e.what() << std::endl;
+      return 1;
+    }
+  }
   return loadDemo(path);
 }
@@ -214,5 +214,81 @@ def test_sort():
     assert tu.equal(expected, pgf.read(rsorted))
 
 
+def test_argsort():
+    random.seed(42)
+    rkeys = pgf.var_float()
+    rindices = pgf.argsort(rkeys)
+    for _ in range(10):
+        # Few distinct keys, so that many keys are equal.
+        keys = [float(random.randint(-5, 5)) for _ in range(random.randint(75, 155))]
+        expected = sorted(range(len(keys)), key=lambda i: keys[i])
+
+        pgf.assign(rkeys, keys)
+        assert tu.equal(expected, pgf.read(rindices))
+
+
+def test_partialSort():
+    random.seed(42)
+    rvals = pgf.var_int()
+    rkeys = pgf.var_int()
+    rcount = pgf.var_int()
+    rsorted = pgf.partialSort(rvals, rkeys, rcount)
+    for _ in range(10):
+        nItems = random.randint(75, 155)
+        vals = list(range(nItems))
+        keys = [random.randint(0, 20) for _ in range(nItems)]
+        count = random.randint(0, nItems + 10)
+        expected = [
+            x for x, _ in sorted(zip(vals, keys), key=lambda pair: pair[1])
+        ][:count]
+
+        pgf.assign(rvals, vals)
+        pgf.assign(rkeys, keys)
+        pgf.assign(rcount, count)
+        assert tu.equal(expected, pgf.read(rsorted))
+
+
+def test_gatherScatter():
+    random.seed(42)
+    rvals = pgf.var_int()
+    rindices = pgf.var_int()
+    rnew = pgf.var_int()
+    rgathered = pgf.gather(rvals, rindices)
+    rscattered = pgf.scatter(rvals, rnew, rindices)
+    for _ in range(10):
+        vals = [random.randint(23, 345) for _ in range(random.randint(25, 50))]
+        indices = [random.randint(0, len(vals) - 1) for _ in range(20)]
+        new = [random.randint(-50, -1) for _ in indices]
+        expected = list(vals)
+        for i, v in zip(indices, new):
+            expected[i] = v
+
+        pgf.assign(rvals, vals)
+        pgf.assign(rindices, indices)
+        pgf.assign(rnew, new)
+        assert tu.equal([vals[i] for i in indices], pgf.read(rgathered))
+        assert tu.equal(expected, pgf.read(rscattered))
+
+
+def test_scanAndRuns():
+    random.seed(42)
+    rvals = pgf.var_int()
+    rinclusive = pgf.inclusiveScan(rvals)
+    rexclusive = pgf.exclusiveScan(rvals)
+    runique = pgf.unique(rvals)
+    ritems, rcounts = pgf.runLengthEncode(rvals)
+    for _ in range(10):
+        vals = [random.randint(0, 3) for _ in range(random.randint(25, 50))]
+        runs = [(v, len(list(g))) for v, g in itertools.groupby(vals)]
+
+        pgf.assign(rvals, vals)
+        assert tu.equal(list(itertools.accumulate(vals)), pgf.read(rinclusive))
+        assert tu.equal([0] + list(itertools.accumulate(vals))[:-1],
+                        pgf.read(rexclusive))
+        assert tu.equal([v for v, _ in runs], pgf.read(runique))
+        assert tu.equal([v for v, _ in runs], pgf.read(ritems))
+        assert tu.equal([c for _, c in runs], pgf.read(rcounts))
+
+
 if __name__ == "__main__":
     test_sort()
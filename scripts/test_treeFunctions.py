@@ -1,5 +1,6 @@
 import pygalfunc as pgf
 import testUtil as tu
+import pytest
 import random
 
 
@@ -66,5 +67,53 @@ def test_graftedMeshVertexColors():
         assert c == cval
 
 
+def test_branchSum():
+    random.seed(42)
+    intree = pgf.var_int()
+    depth = pgf.var_int()
+    sums = pgf.branchSum(intree, depth)
+    vals = [[[random.randint(23, 234) for __ in range(random.randint(1, 5))]
+             for ___ in range(3)] for _____ in range(4)]
+    pgf.assign(intree, vals)
+    pgf.assign(depth, 1)
+    assert tu.equal([[sum(l1) for l1 in l0] for l0 in vals], pgf.read(sums))
+    pgf.assign(depth, 2)
+    assert tu.equal([sum(sum(l1) for l1 in l0) for l0 in vals], pgf.read(sums))
+    pgf.assign(depth, 0)
+    assert tu.equal(sum(sum(sum(l1) for l1 in l0) for l0 in vals), pgf.read(sums))
+
+
+def test_numpyArrays():
+    np = pytest.importorskip("numpy")
+    values = np.arange(6, dtype=np.float32) * 0.5
+    x = pgf.var_float()
+    one = pgf.var_float(1.)
+    y = pgf.add(x, one)
+    # A flat array is assigned as a list.
+    pgf.assign(x, values)
+    assert tu.equalf(values.tolist(), pgf.read(x))
+    xvals, xdepths = pgf.readArray(x)
+    assert np.array_equal(values, xvals)
+    assert np.array_equal([1, 0, 0, 0, 0, 0], xdepths)
+    # The values and the depths describe a tree with two lists.
+    depths = np.array([2, 0, 0, 1, 0, 0], dtype=np.uint8)
+    pgf.assign(x, (values, depths))
+    assert tu.equalf([[0., .5, 1.], [1.5, 2., 2.5]], pgf.read(x))
+    yvals, ydepths = pgf.readArray(y)
+    assert np.array_equal(values + 1., yvals)
+    assert np.array_equal(depths, ydepths)
+    assert not yvals.flags.writeable
+    # The arrays read from a register can be assigned back to a variable. The arrays
+    # read before don't change.
+    pgf.assign(x, pgf.readArray(y))
+    yvals2, ydepths2 = pgf.readArray(y)
+    assert np.array_equal(values + 2., yvals2)
+    assert np.array_equal(depths, ydepths2)
+    assert np.array_equal(values + 1., yvals)
+    # Several values can't start at depth zero.
+    with pytest.raises(ValueError):
+        pgf.assign(x, (values, np.zeros(6, dtype=np.uint8)))
+
+
 if __name__ == "__main__":
     test_flatten()
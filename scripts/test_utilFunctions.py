@@ -2,6 +2,7 @@ import pygalfunc as pgf
 import testUtil as tu
 import math
 import random
+import threading
 
 
 def unaryFloatOpTest(expFn, pgfn, minval=0., maxval=9.):
@@ -123,3 +124,49 @@ def test_mul():
 def test_div():
     binaryIntOpTest(lambda a, b: a // b, pgf.div)
     binaryFloatOpTest(lambda a, b: a / b, pgf.div)
+
+
+def test_sessions():
+    results = [None] * 4
+
+    def evaluate(i):
+        with pgf.Session():
+            x = pgf.var_float(float(i))
+            y = pgf.var_float(1.)
+            s = pgf.add(x, y)
+            vals = []
+            for j in range(20):
+                pgf.assign(y, float(j))
+                vals.append(pgf.read(s))
+            results[i] = vals
+
+    threads = [threading.Thread(target=evaluate, args=(i, )) for i in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for i in range(4):
+        for j in range(20):
+            tu.assertEqualf(float(i + j), results[i][j], 1e-6)
+
+
+def test_profile():
+    with pgf.Session():
+        x = pgf.var_float()
+        y = pgf.var_float(1.)
+        s = pgf.add(x, y)
+        pgf.resetProfile()
+        pgf.setProfiling(True)
+        for i in range(5):
+            pgf.assign(x, [float(j) for j in range(i + 1)])
+            tu.assertEqualf([float(j + 1) for j in range(i + 1)], pgf.read(s))
+        # Nothing changed, so reading again doesn't run the function.
+        pgf.read(s)
+        stats = [rec for rec in pgf.profile() if rec["name"] == "add"]
+    # Profiling is a setting of the session, so the default session is not profiled.
+    assert not pgf.profiling()
+    assert len(stats) == 1
+    assert stats[0]["runs"] == 5
+    assert stats[0]["combinations"] == 1 + 2 + 3 + 4 + 5
+    assert stats[0]["elements"] == 5
+    assert stats[0]["totalTime"] >= stats[0]["lastTime"]